@@ -0,0 +1,612 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.cpp
+//
+// Identification: src/buffer/buffer_pool_manager_instance.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_instance.h"
+
+#include <algorithm>
+#include <future>  // NOLINT
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/two_queue_replacer.h"
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+using unique_lock = std::unique_lock<std::mutex>;
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, nullptr, replacer_policy) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, LogManager *log_manager, Page *pages,
+                                                     ReplacerPolicy replacer_policy)
+    : pool_size_(pool_size),
+      pages_(pages),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      next_page_id_(static_cast<page_id_t>(instance_index)),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      frame_states_(pool_size, FrameState::READY),
+      frame_cvs_(pool_size),
+      unpin_times_(pool_size, 0),
+      rec_lsns_(pool_size, INVALID_LSN),
+      pin_lsns_(pool_size, INVALID_LSN) {
+  BUSTUB_ASSERT(num_instances > 0, "A standalone buffer pool is an instance of a pool of size 1.");
+  BUSTUB_ASSERT(instance_index < num_instances, "Instance index must be smaller than the number of instances.");
+  // We allocate a consecutive memory space for the buffer pool, unless the frames are a slice of a larger arena.
+  if (pages_ == nullptr) {
+    arena_ = std::make_unique<FrameArena>(pool_size_);
+    pages_ = arena_->GetPages();
+  }
+  switch (replacer_policy) {
+    case ReplacerPolicy::LRU:
+      replacer_ = new LRUReplacer(pool_size);
+      break;
+    case ReplacerPolicy::CLOCK:
+      replacer_ = new ClockReplacer(pool_size);
+      break;
+    case ReplacerPolicy::LRU_K:
+      replacer_ = new LRUKReplacer(pool_size);
+      break;
+    case ReplacerPolicy::TWO_Q:
+      replacer_ = new TwoQueueReplacer(pool_size);
+      break;
+  }
+
+  // Initially, every page is in the free list.
+  for (size_t i = 0; i < pool_size_; ++i) {
+    free_list_.emplace_back(static_cast<int>(i));
+  }
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopPageCleaner();
+  {
+    // reads started by PrefetchPage complete on their own and must still find their frames
+    auto lock = LockLatch();
+    for (size_t i = 0; i < frame_states_.size(); i++) {
+      frame_cvs_[i].wait(lock, [&] { return frame_states_[i] == FrameState::READY; });
+    }
+  }
+  delete replacer_;
+}
+
+Page *BufferPoolManagerInstance::FetchPageImpl(page_id_t page_id) {
+  return FetchPageInternal(page_id, AccessType::Unknown);
+}
+
+Page *BufferPoolManagerInstance::FetchPageWithHintImpl(page_id_t page_id, AccessType access_type) {
+  return FetchPageInternal(page_id, access_type);
+}
+
+Page *BufferPoolManagerInstance::FetchPageInternal(page_id_t page_id, AccessType access_type) {
+  // 1.     Search the page table for the requested page (P).
+  // 1.1    If P exists, pin it and return it as soon as it is READY.
+  // 1.2    If P is still being written back after an eviction, wait for the write to finish and search again.
+  // 1.3    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+  //        Note that pages are always found from the free list first.
+  // 2.     Delete R from the page table and insert P, pinned and not READY yet.
+  // 3.     Drop the latch, write R back to the disk if it is dirty, read in P and mark it READY.
+  assert(page_id != INVALID_PAGE_ID);
+  auto lock = LockLatch();
+  while (true) {
+    auto iter = page_table_.find(page_id);
+    if (iter != page_table_.end()) {
+      frame_id_t frame_id = iter->second;
+      num_hits_.Add();
+      replacer_->RecordAccess(frame_id, access_type);
+      PinFrame(frame_id);
+      frame_cvs_[frame_id].wait(lock, [&] { return frame_states_[frame_id] == FrameState::READY; });
+      if (pages_[frame_id].page_id_ == page_id) {
+        return &pages_[frame_id];
+      }
+      // the I/O that was bringing P in failed and the frame went back to its victim or to the free list
+      UnpinFrame(frame_id, false);
+      continue;
+    }
+    auto evicting = evicting_.find(page_id);
+    if (evicting == evicting_.end()) {
+      break;
+    }
+    // reading P before its write-back has finished would return stale data
+    frame_id_t frame_id = evicting->second;
+    frame_cvs_[frame_id].wait(lock, [&] { return evicting_.count(page_id) == 0; });
+  }
+  num_misses_.Add();
+  frame_id_t frame_id;
+  page_id_t dirty_page_id;
+  if (!FindFrame(&frame_id, &dirty_page_id)) {
+    num_pin_failures_.Add();
+    return nullptr;
+  }
+  InstallPage(frame_id, page_id, dirty_page_id);
+  replacer_->RecordAccess(frame_id, access_type);
+  lock.unlock();
+  LoadFrame(frame_id, page_id, dirty_page_id, true);
+  return &pages_[frame_id];
+}
+
+bool BufferPoolManagerInstance::PrefetchPageImpl(page_id_t page_id) {
+  // 1.     If P is in the page table or still being written back, there is nothing to read.
+  // 2.     Otherwise install P into a frame like FetchPage does, pinned by the read and not READY yet.
+  // 3.     Drop the latch, write the victim back if it is dirty and issue the read of P without waiting for it.
+  //        The completion of the read marks P READY and drops the pin of the read.
+  assert(page_id != INVALID_PAGE_ID);
+  auto lock = LockLatch();
+  if (page_table_.count(page_id) != 0 || evicting_.count(page_id) != 0) {
+    return true;
+  }
+  frame_id_t frame_id;
+  page_id_t dirty_page_id;
+  if (!FindFrame(&frame_id, &dirty_page_id)) {
+    num_pin_failures_.Add();
+    return false;
+  }
+  InstallPage(frame_id, page_id, dirty_page_id);
+  replacer_->RecordAccess(frame_id, AccessType::Scan);
+  lock.unlock();
+  WriteBackVictim(frame_id, page_id, dirty_page_id);
+  auto &page = pages_[frame_id];
+  page.ResetMemory();
+  disk_manager_->ReadPageAsync(page_id, page.data_, [this, frame_id, page_id](std::exception_ptr error) {
+    auto lock = LockLatch();
+    if (error != nullptr) {
+      AbandonFrame(frame_id, page_id);
+      return;
+    }
+    frame_states_[frame_id] = FrameState::READY;
+    frame_cvs_[frame_id].notify_all();
+    UnpinFrame(frame_id, false);
+  });
+  return true;
+}
+
+bool BufferPoolManagerInstance::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  assert(page_id != INVALID_PAGE_ID);
+  auto lock = LockLatch();
+  auto iter = page_table_.find(page_id);
+  if (iter == page_table_.end()) {
+    return true;
+  }
+  return UnpinFrame(iter->second, is_dirty);
+}
+
+bool BufferPoolManagerInstance::FlushPageImpl(page_id_t page_id) {
+  // Make sure you call DiskManager::WritePage!
+  assert(page_id != INVALID_PAGE_ID);
+  auto lock = LockLatch();
+  auto iter = page_table_.find(page_id);
+  if (iter == page_table_.end()) {
+    return false;
+  }
+  WriteBackFrame(&lock, iter->second);
+  return true;
+}
+
+Page *BufferPoolManagerInstance::NewPageImpl(page_id_t *page_id) {
+  // 0.   Page ids are allocated by AllocatePage, striped across the instances of a parallel pool.
+  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
+  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  // 3.   Update P's metadata and add P to the page table, pinned and not READY yet.
+  // 4.   Drop the latch, write the victim back if it is dirty and zero out memory.
+  // 5.   Set the page ID output parameter. Return a pointer to P.
+  auto lock = LockLatch();
+  frame_id_t frame_id;
+  page_id_t dirty_page_id;
+  if (!FindFrame(&frame_id, &dirty_page_id)) {
+    num_pin_failures_.Add();
+    return nullptr;
+  }
+  *page_id = AllocatePage();
+  InstallPage(frame_id, *page_id, dirty_page_id);
+  replacer_->RecordAccess(frame_id, AccessType::Unknown);
+  lock.unlock();
+  LoadFrame(frame_id, *page_id, dirty_page_id, false);
+  return &pages_[frame_id];
+}
+
+bool BufferPoolManagerInstance::DeletePageImpl(page_id_t page_id) {
+  // 0.   Make sure you call DiskManager::DeallocatePage!
+  // 1.   Search the page table for the requested page (P).
+  // 1.   If P does not exist, return true.
+  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+  //      Frames that are not READY are always pinned by the thread doing their I/O.
+  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  assert(page_id != INVALID_PAGE_ID);
+  auto lock = LockLatch();
+  auto iter = page_table_.find(page_id);
+  if (iter == page_table_.end()) {
+    return true;
+  }
+  frame_id_t frameId = iter->second;
+  Page *page = &pages_[frameId];
+  if (page->pin_count_ != 0) {
+    return false;
+  }
+  replacer_->Remove(frameId);
+  // when pin count==0 no need to lock
+  disk_manager_->DeallocatePage(page->page_id_);
+  page_table_.erase(iter);
+  page->pin_count_ = 0;
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  rec_lsns_[frameId] = INVALID_LSN;
+  page->ResetMemory();
+  free_list_.emplace_back(frameId);
+  return true;
+}
+
+void BufferPoolManagerInstance::FlushAllPagesImpl() {
+  // Frames that are not READY are skipped: their page is either being read in, or being written back already.
+  for (size_t i = 0; i < pool_size_; ++i) {
+    auto lock = LockLatch();
+    if (pages_[i].page_id_ == INVALID_PAGE_ID || frame_states_[i] != FrameState::READY) {
+      continue;
+    }
+    WriteBackFrame(&lock, static_cast<frame_id_t>(i));
+  }
+}
+
+void BufferPoolManagerInstance::WriteBackFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) {
+  // pin the page so that it cannot be evicted while it is written without the latch
+  PinFrame(frame_id);
+  frame_cvs_[frame_id].wait(*lock, [&] { return frame_states_[frame_id] == FrameState::READY; });
+  auto &page = pages_[frame_id];
+  const page_id_t page_id = page.page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    // the read of the page failed, there is nothing to write
+    UnpinFrame(frame_id, false);
+    return;
+  }
+  // whoever dirties the page from now on marks it dirty again when unpinning, its recLSN stays until the write is done
+  page.is_dirty_ = false;
+  lock->unlock();
+  page.WLatch();
+  try {
+    FlushLogFor(&page);
+    disk_manager_->WritePage(page_id, page.data_);
+  } catch (const Exception &e) {
+    // the page did not make it to disk, so it is still dirty
+    page.WUnlatch();
+    *lock = LockLatch();
+    page.is_dirty_ = true;
+    UnpinFrame(frame_id, false);
+    throw;
+  }
+  page.WUnlatch();
+  *lock = LockLatch();
+  if (!page.is_dirty_) {
+    rec_lsns_[frame_id] = INVALID_LSN;
+  }
+  UnpinFrame(frame_id, false);
+}
+
+void BufferPoolManagerInstance::PinFrame(frame_id_t frame_id) {
+  auto &page = pages_[frame_id];
+  if (page.pin_count_ == 0) {
+    replacer_->Pin(frame_id);
+    pin_lsns_[frame_id] = NextLSN();
+  }
+  page.pin_count_ += 1;
+}
+
+bool BufferPoolManagerInstance::UnpinFrame(frame_id_t frame_id, bool is_dirty) {
+  auto &page = pages_[frame_id];
+  if (page.pin_count_ == 0) {
+    return false;
+  }
+  page.is_dirty_ = is_dirty || page.is_dirty_;
+  if (is_dirty && rec_lsns_[frame_id] == INVALID_LSN) {
+    // the changes were made under the current pins
+    rec_lsns_[frame_id] = pin_lsns_[frame_id];
+  }
+  if (page.pin_count_ == 1 && page.page_id_ == INVALID_PAGE_ID) {
+    // the read of the page failed, the frame is empty
+    free_list_.emplace_back(frame_id);
+  } else if (page.pin_count_ == 1) {
+    replacer_->Unpin(frame_id);
+    unpin_times_[frame_id] = ++unpin_clock_;
+  }
+  page.pin_count_ -= 1;
+  return true;
+}
+
+bool BufferPoolManagerInstance::FindFrame(frame_id_t *frame_id, page_id_t *dirty_page_id) {
+  *dirty_page_id = INVALID_PAGE_ID;
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  // LRU, only READY frames with a pin count of 0 are in the replacer
+  if (!replacer_->Victim(frame_id)) {
+    return false;
+  }
+  num_evictions_.Add();
+  auto &page = pages_[*frame_id];
+  page_table_.erase(page.page_id_);
+  if (page.is_dirty_) {
+    num_dirty_write_backs_.Add();
+    *dirty_page_id = page.page_id_;
+    evicting_[page.page_id_] = *frame_id;
+    // the cleaner is falling behind
+    cleaner_cv_.notify_one();
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::InstallPage(frame_id_t frame_id, page_id_t page_id, page_id_t dirty_page_id) {
+  auto &page = pages_[frame_id];
+  page.page_id_ = page_id;
+  page.pin_count_ = 1;
+  page.is_dirty_ = false;
+  pin_lsns_[frame_id] = NextLSN();
+  if (dirty_page_id == INVALID_PAGE_ID) {
+    rec_lsns_[frame_id] = INVALID_LSN;
+  }
+  page_table_[page_id] = frame_id;
+  frame_states_[frame_id] = dirty_page_id == INVALID_PAGE_ID ? FrameState::LOADING : FrameState::EVICTING;
+}
+
+void BufferPoolManagerInstance::WriteBackVictim(frame_id_t frame_id, page_id_t page_id, page_id_t dirty_page_id) {
+  if (dirty_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  auto &page = pages_[frame_id];
+  try {
+    FlushLogFor(&page);
+    disk_manager_->WritePage(dirty_page_id, page.data_);
+  } catch (const Exception &e) {
+    // the victim did not make it to disk, so it takes its frame back, still dirty and with its recLSN
+    auto lock = LockLatch();
+    evicting_.erase(dirty_page_id);
+    page_table_.erase(page_id);
+    page_table_[dirty_page_id] = frame_id;
+    page.page_id_ = dirty_page_id;
+    page.is_dirty_ = true;
+    frame_states_[frame_id] = FrameState::READY;
+    frame_cvs_[frame_id].notify_all();
+    UnpinFrame(frame_id, false);
+    throw;
+  }
+  auto lock = LockLatch();
+  evicting_.erase(dirty_page_id);
+  rec_lsns_[frame_id] = INVALID_LSN;
+  frame_states_[frame_id] = FrameState::LOADING;
+  frame_cvs_[frame_id].notify_all();
+}
+
+void BufferPoolManagerInstance::LoadFrame(frame_id_t frame_id, page_id_t page_id, page_id_t dirty_page_id,
+                                          bool read_page) {
+  // The frame is pinned and not READY, so nobody else touches its data until we are done.
+  auto &page = pages_[frame_id];
+  WriteBackVictim(frame_id, page_id, dirty_page_id);
+  page.ResetMemory();
+  if (read_page) {
+    try {
+      disk_manager_->ReadPage(page_id, page.data_);
+    } catch (const Exception &e) {
+      auto lock = LockLatch();
+      AbandonFrame(frame_id, page_id);
+      throw;
+    }
+  }
+  auto lock = LockLatch();
+  frame_states_[frame_id] = FrameState::READY;
+  frame_cvs_[frame_id].notify_all();
+}
+
+void BufferPoolManagerInstance::AbandonFrame(frame_id_t frame_id, page_id_t page_id) {
+  auto &page = pages_[frame_id];
+  page_table_.erase(page_id);
+  page.page_id_ = INVALID_PAGE_ID;
+  page.is_dirty_ = false;
+  rec_lsns_[frame_id] = INVALID_LSN;
+  page.ResetMemory();
+  frame_states_[frame_id] = FrameState::READY;
+  frame_cvs_[frame_id].notify_all();
+  // the last pin to go hands the frame to the free list
+  UnpinFrame(frame_id, false);
+}
+
+void BufferPoolManagerInstance::FlushLogFor(Page *page) {
+  // recovery logs compensations before logging is enabled
+  if (log_manager_ != nullptr && page->GetLSN() > log_manager_->GetPersistentLSN()) {
+    log_manager_->Flush(page->GetLSN());
+  }
+}
+
+void BufferPoolManagerInstance::StartPageCleaner(double clean_ratio, size_t batch_size,
+                                                 std::chrono::milliseconds interval) {
+  BUSTUB_ASSERT(clean_ratio >= 0 && clean_ratio <= 1, "The clean ratio is a share of the unpinned frames.");
+  BUSTUB_ASSERT(batch_size > 0, "The cleaner needs to write at least one page per batch.");
+  StopPageCleaner();
+  auto lock = LockLatch();
+  clean_ratio_ = clean_ratio;
+  cleaner_batch_size_ = batch_size;
+  cleaner_interval_ = interval;
+  cleaner_running_ = true;
+  cleaner_ = std::thread(&BufferPoolManagerInstance::RunPageCleaner, this);
+}
+
+void BufferPoolManagerInstance::StopPageCleaner() {
+  {
+    auto lock = LockLatch();
+    cleaner_running_ = false;
+  }
+  cleaner_cv_.notify_one();
+  if (cleaner_.joinable()) {
+    cleaner_.join();
+  }
+}
+
+void BufferPoolManagerInstance::RunPageCleaner() {
+  auto lock = LockLatch();
+  bool batch_was_full = false;
+  while (cleaner_running_) {
+    // keep going right away while there is a backlog, otherwise wait for the next check
+    if (!batch_was_full) {
+      cleaner_cv_.wait_for(lock, cleaner_interval_);
+      if (!cleaner_running_) {
+        break;
+      }
+    }
+    std::vector<frame_id_t> frame_ids = PickFramesToClean();
+    batch_was_full = frame_ids.size() == cleaner_batch_size_;
+    if (frame_ids.empty()) {
+      continue;
+    }
+    lock.unlock();
+
+    // Writers hold the page write latch while they modify a page, so the read latch gives us a consistent image.
+    // Issue the whole batch before waiting for any of it, so an asynchronous disk manager can keep it all in flight.
+    std::vector<std::future<void>> writes;
+    writes.reserve(frame_ids.size());
+    for (frame_id_t frame_id : frame_ids) {
+      auto &page = pages_[frame_id];
+      page.RLatch();
+      writes.emplace_back(disk_manager_->WritePageAsync(page.page_id_, page.data_));
+    }
+    std::vector<bool> failed(frame_ids.size(), false);
+    for (size_t i = 0; i < frame_ids.size(); ++i) {
+      try {
+        writes[i].get();
+        num_cleaner_write_backs_.Add();
+      } catch (const Exception &e) {
+        LOG_ERROR("page cleaner could not write back page %d", pages_[frame_ids[i]].page_id_);
+        failed[i] = true;
+      }
+      pages_[frame_ids[i]].RUnlatch();
+    }
+
+    lock = LockLatch();
+    for (size_t i = 0; i < frame_ids.size(); ++i) {
+      // a page that could not be written is still dirty
+      if (!failed[i] && !pages_[frame_ids[i]].is_dirty_) {
+        rec_lsns_[frame_ids[i]] = INVALID_LSN;
+      }
+      UnpinFrame(frame_ids[i], failed[i]);
+    }
+  }
+}
+
+std::vector<frame_id_t> BufferPoolManagerInstance::PickFramesToClean() {
+  // 1.   Count the unpinned frames, free frames included, and collect the dirty ones.
+  // 2.   If more of them are dirty than the clean ratio allows, pick the ones that were unpinned the longest, as
+  //      they are the most likely victims, skipping pages whose log records are not persistent yet (WAL).
+  // 3.   Pin the picked frames and mark them clean, whoever dirties them again marks them dirty when unpinning.
+  size_t num_unpinned = free_list_.size();
+  std::vector<std::pair<uint64_t, frame_id_t>> dirty_frames;
+  const bool check_wal = enable_logging && log_manager_ != nullptr;
+  for (size_t i = 0; i < pool_size_; ++i) {
+    auto &page = pages_[i];
+    if (page.page_id_ == INVALID_PAGE_ID || page.pin_count_ != 0 || frame_states_[i] != FrameState::READY) {
+      continue;
+    }
+    num_unpinned++;
+    if (page.is_dirty_ && (!check_wal || page.GetLSN() <= log_manager_->GetPersistentLSN())) {
+      dirty_frames.emplace_back(unpin_times_[i], static_cast<frame_id_t>(i));
+    }
+  }
+  const auto max_dirty = static_cast<size_t>(static_cast<double>(num_unpinned) * (1 - clean_ratio_));
+  if (dirty_frames.size() <= max_dirty) {
+    return {};
+  }
+  const size_t num_to_clean = std::min(dirty_frames.size() - max_dirty, cleaner_batch_size_);
+  std::partial_sort(dirty_frames.begin(), dirty_frames.begin() + num_to_clean, dirty_frames.end());
+
+  std::vector<frame_id_t> frame_ids;
+  frame_ids.reserve(num_to_clean);
+  for (size_t i = 0; i < num_to_clean; ++i) {
+    frame_id_t frame_id = dirty_frames[i].second;
+    PinFrame(frame_id);
+    pages_[frame_id].is_dirty_ = false;
+    frame_ids.push_back(frame_id);
+  }
+  std::sort(frame_ids.begin(), frame_ids.end(),
+            [this](frame_id_t a, frame_id_t b) { return pages_[a].page_id_ < pages_[b].page_id_; });
+  return frame_ids;
+}
+
+std::vector<std::pair<page_id_t, lsn_t>> BufferPoolManagerInstance::GetDirtyPageTable() {
+  auto lock = LockLatch();
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+  // pages that were evicted dirty and are still being written back
+  for (const auto &[page_id, frame_id] : evicting_) {
+    dirty_pages.emplace_back(page_id, rec_lsns_[frame_id]);
+  }
+  for (size_t i = 0; i < pool_size_; ++i) {
+    const auto &page = pages_[i];
+    if (page.page_id_ == INVALID_PAGE_ID) {
+      continue;
+    }
+    // the recLSN of an EVICTING frame is that of the evicted page, its new page is only pinned
+    lsn_t rec_lsn = frame_states_[i] == FrameState::EVICTING ? INVALID_LSN : rec_lsns_[i];
+    if (page.pin_count_ > 0 && (rec_lsn == INVALID_LSN || pin_lsns_[i] < rec_lsn)) {
+      rec_lsn = pin_lsns_[i];
+    }
+    if (rec_lsn != INVALID_LSN || page.is_dirty_) {
+      dirty_pages.emplace_back(page.page_id_, rec_lsn);
+    }
+  }
+  return dirty_pages;
+}
+
+BufferPoolStats BufferPoolManagerInstance::GetStats() {
+  BufferPoolStats stats;
+  stats.hits_ = num_hits_.Get();
+  stats.misses_ = num_misses_.Get();
+  stats.evictions_ = num_evictions_.Get();
+  stats.dirty_write_backs_ = num_dirty_write_backs_.Get();
+  stats.cleaner_write_backs_ = num_cleaner_write_backs_.Get();
+  stats.pin_failures_ = num_pin_failures_.Get();
+  stats.latch_wait_ = latch_wait_.Snapshot();
+  return stats;
+}
+
+void BufferPoolManagerInstance::ResetStats() {
+  num_hits_.Reset();
+  num_misses_.Reset();
+  num_evictions_.Reset();
+  num_dirty_write_backs_.Reset();
+  num_cleaner_write_backs_.Reset();
+  num_pin_failures_.Reset();
+  latch_wait_.Reset();
+}
+
+std::unique_lock<std::mutex> BufferPoolManagerInstance::LockLatch() {
+  // only a contended acquisition pays for reading the clock
+  unique_lock lock(latch_, std::try_to_lock);
+  if (lock.owns_lock()) {
+    latch_wait_.Record(std::chrono::nanoseconds(0));
+  } else {
+    LatencyTimer timer(&latch_wait_);
+    lock.lock();
+  }
+  return lock;
+}
+
+page_id_t BufferPoolManagerInstance::AllocatePage() {
+  const page_id_t next_page_id = next_page_id_;
+  next_page_id_ += num_instances_;
+  // allocated pages mod back to this instance
+  assert(static_cast<uint32_t>(next_page_id) % num_instances_ == instance_index_);
+  return next_page_id;
+}
+
+}  // namespace bustub
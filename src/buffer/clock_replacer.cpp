@@ -12,18 +12,60 @@
 
 #include "buffer/clock_replacer.h"
 
+#include <cassert>
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_pages_(num_pages), states_(std::make_unique<std::atomic<uint8_t>[]>(num_pages)) {
+  for (size_t i = 0; i < num_pages_; ++i) {
+    states_[i].store(0, std::memory_order_relaxed);
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  assert(frame_id != nullptr);
+  // the first rotation clears the reference bits, so the second one finds every frame that stayed in the replacer
+  for (size_t step = 0; step < 2 * num_pages_; ++step) {
+    const size_t index = hand_.fetch_add(1) % num_pages_;
+    auto &state = states_[index];
+    uint8_t old_state = state.load();
+    // retry on the same frame only as long as it is in the replacer, a failed CAS reloads old_state
+    while ((old_state & IN_REPLACER) != 0) {
+      if ((old_state & REFERENCED) != 0) {
+        // second chance
+        if (state.compare_exchange_weak(old_state, old_state & ~REFERENCED)) {
+          break;
+        }
+      } else if (state.compare_exchange_weak(old_state, 0)) {
+        *frame_id = static_cast<frame_id_t>(index);
+        return true;
+      }
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  assert(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_);
+  states_[frame_id].fetch_and(static_cast<uint8_t>(~(IN_REPLACER | REFERENCED)));
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  assert(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_);
+  states_[frame_id].fetch_or(IN_REPLACER | REFERENCED);
+}
 
-size_t ClockReplacer::Size() { return 0; }
+size_t ClockReplacer::Size() {
+  size_t size = 0;
+  for (size_t i = 0; i < num_pages_; ++i) {
+    if ((states_[i].load(std::memory_order_relaxed) & IN_REPLACER) != 0) {
+      ++size;
+    }
+  }
+  return size;
+}
 
 }  // namespace bustub
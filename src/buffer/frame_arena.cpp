@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+static int64_t MBind(void *addr, size_t length, uint64_t node_mask) {
+  return syscall(__NR_mbind, addr, length, MPOL_BIND, &node_mask, sizeof(node_mask) * 8, 0);
+}
+
+FrameArena::FrameArena(size_t num_frames, size_t num_numa_nodes, bool huge_pages) : num_frames_(num_frames) {
+  BUSTUB_ASSERT(num_numa_nodes > 0, "An arena lives on at least one NUMA node.");
+  // a small arena would mostly be padding if it were rounded up to whole huge pages, and gains little from them
+  const size_t size = num_frames * sizeof(Page);
+  huge_pages_ = huge_pages && size >= HUGE_PAGE_THRESHOLD;
+  alignment_ = huge_pages_ ? HUGE_PAGE_SIZE : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  // round up to whole pages, so that the last frames are not left on regular pages
+  length_ = (size + alignment_ - 1) / alignment_ * alignment_;
+  if (length_ > 0) {
+    void *data = MAP_FAILED;
+    if (huge_pages_) {
+      data = mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+    if (data != MAP_FAILED) {
+      memory_ = static_cast<char *>(data);
+      huge_tlb_ = true;
+    } else if (huge_pages_) {
+      MapAligned();
+    } else {
+      data = mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (data == MAP_FAILED) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map the frame arena");
+      }
+      memory_ = static_cast<char *>(data);
+    }
+    // the policy has to be in place before the first touch
+    if (num_numa_nodes > 1) {
+      BindToNodes(num_numa_nodes);
+    }
+  }
+
+  pages_ = reinterpret_cast<Page *>(memory_);
+  for (size_t i = 0; i < num_frames; ++i) {
+    new (&pages_[i]) Page();
+  }
+}
+
+FrameArena::~FrameArena() {
+  for (size_t i = 0; i < num_frames_; ++i) {
+    pages_[i].~Page();
+  }
+  if (memory_ != nullptr) {
+    munmap(memory_, length_);
+  }
+}
+
+void FrameArena::MapAligned() {
+  // over-allocate and trim, so that the mapping starts at a huge page boundary and THP can back all of it
+  const size_t mapped_length = length_ + HUGE_PAGE_SIZE;
+  void *data = mmap(nullptr, mapped_length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map the frame arena");
+  }
+  auto *start = static_cast<char *>(data);
+  auto *aligned = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(start) + HUGE_PAGE_SIZE - 1) /
+                                           HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+  if (aligned != start) {
+    munmap(start, aligned - start);
+  }
+  if (aligned + length_ != start + mapped_length) {
+    munmap(aligned + length_, start + mapped_length - (aligned + length_));
+  }
+  memory_ = aligned;
+  if (madvise(memory_, length_, MADV_HUGEPAGE) != 0) {
+    LOG_WARN("transparent huge pages are not available (%s), the frame arena uses regular pages", strerror(errno));
+  }
+}
+
+void FrameArena::BindToNodes(size_t num_numa_nodes) {
+  // the parts end on page boundaries, the last one takes what is left
+  const size_t part_length = length_ / num_numa_nodes / alignment_ * alignment_;
+  numa_bound_ = part_length > 0 && num_numa_nodes <= 64;
+  for (size_t node = 0; numa_bound_ && node < num_numa_nodes; ++node) {
+    const size_t offset = node * part_length;
+    const size_t length = node + 1 == num_numa_nodes ? length_ - offset : part_length;
+    if (MBind(memory_ + offset, length, uint64_t{1} << node) != 0) {
+      LOG_WARN("could not bind the frame arena to NUMA node %zu (%s)", node, strerror(errno));
+      numa_bound_ = false;
+    }
+  }
+  if (!numa_bound_) {
+    // undo the parts that were bound already
+    syscall(__NR_mbind, memory_, length_, MPOL_DEFAULT, nullptr, 0, 0);
+  }
+}
+
+size_t FrameArena::GetNumNumaNodes() {
+  // e.g. "0-1" on a two socket machine
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string nodes;
+  if (!(online >> nodes) || nodes.empty()) {
+    return 1;
+  }
+  const size_t last = nodes.find_last_of(",-");
+  return std::stoul(last == std::string::npos ? nodes : nodes.substr(last + 1)) + 1;
+}
+
+}  // namespace bustub
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+#include <cassert>
+
+namespace bustub {
+using unique_lock = std::unique_lock<std::mutex>;
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : k_(k), frames_(num_pages) { assert(k_ > 0); }
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  assert(frame_id != nullptr);
+  unique_lock lock(latch_);
+  auto &victims = cold_.empty() ? hot_ : cold_;
+  if (victims.empty()) {
+    return false;
+  }
+  *frame_id = victims.begin()->second;
+  victims.erase(victims.begin());
+  // the frame is going to hold another page, which starts without history
+  frames_[*frame_id].history_.clear();
+  frames_[*frame_id].evictable_ = false;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  assert(frame_id >= 0);
+  unique_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (!frame.evictable_) {
+    return;
+  }
+  SetOf(frame).erase({frame.history_.front(), frame_id});
+  frame.evictable_ = false;
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  assert(frame_id >= 0);
+  unique_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    return;
+  }
+  if (frame.history_.empty()) {
+    // nobody recorded an access, count the unpin as one
+    Access(&frame, AccessType::Unknown);
+  }
+  SetOf(frame).emplace(frame.history_.front(), frame_id);
+  frame.evictable_ = true;
+}
+
+size_t LRUKReplacer::Size() {
+  unique_lock lock(latch_);
+  return cold_.size() + hot_.size();
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  assert(frame_id >= 0);
+  unique_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    SetOf(frame).erase({frame.history_.front(), frame_id});
+  }
+  Access(&frame, access_type);
+  if (frame.evictable_) {
+    SetOf(frame).emplace(frame.history_.front(), frame_id);
+  }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  assert(frame_id >= 0);
+  unique_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    SetOf(frame).erase({frame.history_.front(), frame_id});
+  }
+  frame.history_.clear();
+  frame.evictable_ = false;
+}
+
+void LRUKReplacer::Access(Frame *frame, AccessType access_type) {
+  current_timestamp_ += 1;
+  if (access_type == AccessType::Scan && !frame->history_.empty()) {
+    return;
+  }
+  frame->history_.push_back(current_timestamp_);
+  if (frame->history_.size() > k_) {
+    frame->history_.pop_front();
+  }
+}
+
+}  // namespace bustub
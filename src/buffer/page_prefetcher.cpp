@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_prefetcher.cpp
+//
+// Identification: src/buffer/page_prefetcher.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_prefetcher.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+PagePrefetcher::PagePrefetcher(BufferPoolManager *bpm, size_t depth, next_page_fn next_page)
+    : bpm_(bpm), depth_(depth), next_page_(std::move(next_page)), worker_(&PagePrefetcher::Run, this) {}
+
+PagePrefetcher::~PagePrefetcher() {
+  {
+    std::scoped_lock lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  worker_.join();
+}
+
+void PagePrefetcher::Advance(page_id_t page_id) {
+  {
+    std::scoped_lock lock(latch_);
+    auto iter = std::find(window_.begin(), window_.end(), page_id);
+    if (iter != window_.end()) {
+      // the consumer caught up with a prefetched page, which frees up room in the window
+      window_.erase(window_.begin(), iter + 1);
+    } else if (page_id == fetching_) {
+      // the consumer caught up with the page that is being read ahead right now
+      window_.clear();
+      fetching_consumed_ = true;
+    } else {
+      // the consumer is somewhere we did not read ahead to, start over from there
+      window_.clear();
+      cursor_ = page_id;
+      generation_++;
+    }
+  }
+  cv_.notify_one();
+}
+
+size_t PagePrefetcher::GetNumPrefetched() {
+  std::scoped_lock lock(latch_);
+  return num_prefetched_;
+}
+
+void PagePrefetcher::Run() {
+  std::unique_lock lock(latch_);
+  while (true) {
+    cv_.wait(lock, [&] { return stop_ || (cursor_ != INVALID_PAGE_ID && window_.size() < depth_); });
+    if (stop_) {
+      return;
+    }
+    const page_id_t cursor = cursor_;
+    const uint64_t generation = generation_;
+    lock.unlock();
+
+    // 1. Read the next-page link of the cursor, which is either the consumer's page or a page we just prefetched, so
+    //    it is in the buffer pool already.
+    // 2. Issue the read of the next page, which is the actual read-ahead. The read completes on its own, and the next
+    //    round waits for it when it fetches the page for its link.
+    page_id_t next_page_id = INVALID_PAGE_ID;
+    bool fetched = false;
+    Page *page = nullptr;
+    try {
+      page = bpm_->FetchPage(cursor, AccessType::Scan);
+      if (page != nullptr) {
+        page->RLatch();
+        next_page_id = next_page_(page);
+        page->RUnlatch();
+        bpm_->UnpinPage(cursor, false);
+      }
+      if (next_page_id != INVALID_PAGE_ID) {
+        lock.lock();
+        fetching_ = next_page_id;
+        fetching_consumed_ = false;
+        lock.unlock();
+        fetched = bpm_->PrefetchPage(next_page_id);
+      }
+    } catch (const Exception &e) {
+      // an I/O error, which the consumer runs into on its own when it gets there
+      page = nullptr;
+    }
+
+    lock.lock();
+    fetching_ = INVALID_PAGE_ID;
+    if (generation != generation_) {
+      continue;
+    }
+    if (fetched) {
+      if (!fetching_consumed_) {
+        window_.push_back(next_page_id);
+      }
+      cursor_ = next_page_id;
+      num_prefetched_++;
+    } else if (next_page_id == INVALID_PAGE_ID && page != nullptr) {
+      // end of the chain, the window drains as the consumer catches up
+      cursor_ = INVALID_PAGE_ID;
+    } else {
+      // every frame is pinned or the I/O failed: stop until the consumer moves on and restarts read-ahead
+      window_.clear();
+      cursor_ = INVALID_PAGE_ID;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     size_t num_numa_nodes) {
+  BUSTUB_ASSERT(num_instances > 0, "A parallel buffer pool needs at least one instance.");
+  // Allocate one consecutive arena and hand out a slice of it to every instance, so that GetPages() and
+  // GetPoolSize() describe every frame of the pool. Split over NUMA nodes, consecutive instances share a node.
+  arena_ = std::make_unique<FrameArena>(num_instances * pool_size, num_numa_nodes);
+  Page *pages = arena_->GetPages();
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(
+        pool_size, num_instances, i, disk_manager, log_manager, pages + i * pool_size, replacer_policy));
+  }
+}
+
+// The instances only borrow their frames, instances_ is declared after arena_ so that they go away first.
+ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+
+BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  assert(page_id != INVALID_PAGE_ID);
+  return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+}
+
+void ParallelBufferPoolManager::StartPageCleaner(double clean_ratio, size_t batch_size,
+                                                 std::chrono::milliseconds interval) {
+  for (auto &instance : instances_) {
+    instance->StartPageCleaner(clean_ratio, batch_size, interval);
+  }
+}
+
+void ParallelBufferPoolManager::StopPageCleaner() {
+  for (auto &instance : instances_) {
+    instance->StopPageCleaner();
+  }
+}
+
+BufferPoolStats ParallelBufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  for (auto &instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+void ParallelBufferPoolManager::ResetStats() {
+  for (auto &instance : instances_) {
+    instance->ResetStats();
+  }
+}
+
+std::vector<std::pair<page_id_t, lsn_t>> ParallelBufferPoolManager::GetDirtyPageTable() {
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+  for (auto &instance : instances_) {
+    auto instance_dirty_pages = instance->GetDirtyPageTable();
+    dirty_pages.insert(dirty_pages.end(), instance_dirty_pages.begin(), instance_dirty_pages.end());
+  }
+  return dirty_pages;
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::FetchPageWithHintImpl(page_id_t page_id, AccessType access_type) {
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, access_type);
+}
+
+bool ParallelBufferPoolManager::PrefetchPageImpl(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->PrefetchPage(page_id);
+}
+
+bool ParallelBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id) {
+  // Start at a different instance every call and give every instance one chance before giving up.
+  const size_t start = next_instance_++;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    Page *page = instances_[(start + i) % instances_.size()]->NewPage(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+bool ParallelBufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPagesImpl() {
+  for (auto &instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+#include <cassert>
+
+namespace bustub {
+using unique_lock = std::unique_lock<std::mutex>;
+TwoQueueReplacer::TwoQueueReplacer(size_t num_pages, double a1_ratio)
+    : a1_max_size_(static_cast<size_t>(static_cast<double>(num_pages) * a1_ratio)), frames_(num_pages) {}
+
+TwoQueueReplacer::~TwoQueueReplacer() = default;
+
+bool TwoQueueReplacer::Victim(frame_id_t *frame_id) {
+  assert(frame_id != nullptr);
+  unique_lock lock(latch_);
+  // A1 gives up a victim once it grew beyond its share, or when there is nothing else to evict
+  auto &victims = (!a1_.empty() && (a1_size_ > a1_max_size_ || am_.empty())) ? a1_ : am_;
+  if (victims.empty()) {
+    return false;
+  }
+  *frame_id = victims.begin()->second;
+  victims.erase(victims.begin());
+  auto &frame = frames_[*frame_id];
+  if (frame.queue_ == Queue::A1) {
+    a1_size_ -= 1;
+  }
+  // the frame is going to hold another page, which starts out in neither queue
+  frame.queue_ = Queue::NONE;
+  frame.evictable_ = false;
+  return true;
+}
+
+void TwoQueueReplacer::Pin(frame_id_t frame_id) {
+  assert(frame_id >= 0);
+  unique_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (!frame.evictable_) {
+    return;
+  }
+  SetOf(frame).erase({frame.timestamp_, frame_id});
+  frame.evictable_ = false;
+}
+
+void TwoQueueReplacer::Unpin(frame_id_t frame_id) {
+  assert(frame_id >= 0);
+  unique_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    return;
+  }
+  if (frame.queue_ == Queue::NONE) {
+    // nobody recorded an access, count the unpin as one
+    Access(&frame, AccessType::Unknown);
+  }
+  SetOf(frame).emplace(frame.timestamp_, frame_id);
+  frame.evictable_ = true;
+}
+
+size_t TwoQueueReplacer::Size() {
+  unique_lock lock(latch_);
+  return a1_.size() + am_.size();
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  assert(frame_id >= 0);
+  unique_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    SetOf(frame).erase({frame.timestamp_, frame_id});
+  }
+  Access(&frame, access_type);
+  if (frame.evictable_) {
+    SetOf(frame).emplace(frame.timestamp_, frame_id);
+  }
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  assert(frame_id >= 0);
+  unique_lock lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    SetOf(frame).erase({frame.timestamp_, frame_id});
+  }
+  if (frame.queue_ == Queue::A1) {
+    a1_size_ -= 1;
+  }
+  frame.queue_ = Queue::NONE;
+  frame.evictable_ = false;
+}
+
+void TwoQueueReplacer::Access(Frame *frame, AccessType access_type) {
+  current_timestamp_ += 1;
+  switch (frame->queue_) {
+    case Queue::NONE:
+      frame->queue_ = Queue::A1;
+      frame->timestamp_ = current_timestamp_;
+      a1_size_ += 1;
+      break;
+    case Queue::A1:
+      // A1 is FIFO, only a repeated access that is not part of a scan moves the frame on to Am
+      if (access_type != AccessType::Scan) {
+        frame->queue_ = Queue::AM;
+        frame->timestamp_ = current_timestamp_;
+        a1_size_ -= 1;
+      }
+      break;
+    case Queue::AM:
+      frame->timestamp_ = current_timestamp_;
+      break;
+  }
+}
+
+}  // namespace bustub
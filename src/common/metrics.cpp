@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// metrics.cpp
+//
+// Identification: src/common/metrics.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace bustub {
+
+uint64_t HistogramSnapshot::Percentile(double p) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  // the rank of the percentile, counting from 1
+  const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p / 100 * static_cast<double>(count_))));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return i == 0 ? 0 : (uint64_t{1} << i) - 1;
+    }
+  }
+  return (uint64_t{1} << (NUM_BUCKETS - 1)) - 1;
+}
+
+HistogramSnapshot &HistogramSnapshot::operator+=(const HistogramSnapshot &other) {
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  sum_ns_ += other.sum_ns_;
+  return *this;
+}
+
+std::string HistogramSnapshot::ToString(const std::string &unit) const {
+  std::ostringstream os;
+  os << "count=" << count_ << " mean=" << static_cast<uint64_t>(Mean()) << unit << " p50<=" << Percentile(50) << unit
+     << " p99<=" << Percentile(99) << unit << " p99.9<=" << Percentile(99.9) << unit;
+  return os.str();
+}
+
+HistogramSnapshot LatencyHistogram::Snapshot() const {
+  HistogramSnapshot snapshot;
+  for (const auto &shard : shards_) {
+    for (size_t i = 0; i < HistogramSnapshot::NUM_BUCKETS; ++i) {
+      const uint64_t count = shard.buckets_[i].load(std::memory_order_relaxed);
+      snapshot.buckets_[i] += count;
+      snapshot.count_ += count;
+    }
+    snapshot.sum_ns_ += shard.sum_ns_.load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+void LatencyHistogram::Reset() {
+  for (auto &shard : shards_) {
+    for (auto &bucket : shard.buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    shard.sum_ns_.store(0, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace bustub
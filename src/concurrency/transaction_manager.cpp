@@ -16,6 +16,7 @@
 #include <unordered_set>
 
 #include "catalog/catalog.h"
+#include "common/exception.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -30,6 +31,16 @@ Transaction *TransactionManager::Begin(Transaction *txn, IsolationLevel isolatio
     txn = new Transaction(next_txn_id_++, isolation_level);
   }
 
+  if (enable_logging) {
+    {
+      // a checkpoint either sees the transaction or only log records that come after its BEGIN record
+      std::scoped_lock active_txns_lock(active_txns_latch_);
+      active_txns_[txn->GetTransactionId()] = log_manager_->GetNextLSN();
+    }
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BEGIN);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+  }
+
   txn_map[txn->GetTransactionId()] = txn;
   return txn;
 }
@@ -50,6 +61,22 @@ void TransactionManager::Commit(Transaction *txn) {
   }
   write_set->clear();
 
+  if (enable_logging) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+    lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
+    txn->SetPrevLSN(lsn);
+    // Group commit: the flush thread makes every commit record appended in the meantime durable with the same write.
+    try {
+      log_manager_->Flush(lsn);
+    } catch (const Exception &e) {
+      // the commit is not durable, the transaction stays active for checkpoints so that recovery undoes it
+      ReleaseLocks(txn);
+      global_txn_latch_.RUnlock();
+      throw;
+    }
+    EndTransaction(txn);
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
@@ -100,12 +127,28 @@ void TransactionManager::Abort(Transaction *txn) {
   table_write_set->clear();
   index_write_set->clear();
 
+  if (enable_logging) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ABORT);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+    EndTransaction(txn);
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
 
+void TransactionManager::EndTransaction(Transaction *txn) {
+  std::scoped_lock active_txns_lock(active_txns_latch_);
+  active_txns_.erase(txn->GetTransactionId());
+}
+
+std::vector<std::pair<txn_id_t, lsn_t>> TransactionManager::GetActiveTransactions() {
+  std::scoped_lock active_txns_lock(active_txns_latch_);
+  return {active_txns_.begin(), active_txns_.end()};
+}
+
 void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
 
 void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
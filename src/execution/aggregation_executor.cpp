@@ -1,65 +1,77 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// aggregation_executor.cpp
-//
-// Identification: src/execution/aggregation_executor.cpp
-//
-// Copyright (c) 2015-19, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-#include <memory>
-#include <vector>
-
-#include "execution/executors/aggregation_executor.h"
-
-namespace bustub {
-
-AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
-                                         std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx),
-      plan_(plan),
-      child_(std::move(child)),
-      aht_(plan->GetAggregates(), plan->GetAggregateTypes()),
-      aht_iterator_(aht_.Begin()),
-      having_(plan->GetHaving()) {}
-
-const AbstractExecutor *AggregationExecutor::GetChildExecutor() const { return child_.get(); }
-
-void AggregationExecutor::Init() {
-  Tuple aggregation_tuple;
-  RID aggregation_rid;
-  child_->Init();
-  if (aht_.Begin() == aht_.End()) {
-    while (child_->Next(&aggregation_tuple, &aggregation_rid)) {
-      aht_.InsertCombine(MakeKey(&aggregation_tuple), MakeVal(&aggregation_tuple));
-    }
-  }
-  aht_iterator_ = aht_.Begin();
-}
-
-bool AggregationExecutor::Next(Tuple *tuple, RID *rid) {
-  auto make_out_tuple = [](const AggregateKey &key, const AggregateValue &value, const Schema *out_schema) -> Tuple {
-    Value column_value;
-    std::vector<Value> values;
-    auto columns = out_schema->GetColumns();
-    for (auto &column : columns) {
-      column_value = column.GetExpr()->EvaluateAggregate(key.group_bys_, value.aggregates_);
-      values.emplace_back(column_value);
-    }
-    return Tuple(values, out_schema);
-  };
-  while (aht_iterator_ != aht_.End()) {
-    *tuple = make_out_tuple(aht_iterator_.Key(), aht_iterator_.Val(), plan_->OutputSchema());
-    if (having_ == nullptr ||
-        having_->EvaluateAggregate(aht_iterator_.Key().group_bys_, aht_iterator_.Val().aggregates_).GetAs<bool>()) {
-      ++aht_iterator_;
-      return true;
-    }
-    ++aht_iterator_;
-  }
-  return false;
-}
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_executor.cpp
+//
+// Identification: src/execution/aggregation_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <memory>
+#include <vector>
+
+#include "execution/executors/aggregation_executor.h"
+
+namespace bustub {
+
+AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
+                                         std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_(std::move(child)),
+      aht_(plan->GetAggregates(), plan->GetAggregateTypes()),
+      having_(plan->GetHaving()) {}
+
+const AbstractExecutor *AggregationExecutor::GetChildExecutor() const { return child_.get(); }
+
+void AggregationExecutor::Init() {
+  child_->Init();
+  if (table_ != nullptr) {
+    table_->Rewind();
+    return;
+  }
+  table_ = AggregationTable::Create(plan_, &aht_, exec_ctx_->GetBufferPoolManager());
+  VectorBatch batch;
+  while (child_->NextBatch(&batch)) {
+    table_->Consume(std::move(batch));
+  }
+  table_->Finish();
+}
+
+bool AggregationExecutor::Next(Tuple *tuple, RID *rid) {
+  const AggregateValue *aggregates;
+  while (table_->NextGroup(&group_bys_, &aggregates)) {
+    if (having_ == nullptr ||
+        AbstractExpression::IsTrue(having_->EvaluateAggregate(group_bys_, aggregates->aggregates_))) {
+      std::vector<Value> values;
+      for (const auto &column : plan_->OutputSchema()->GetColumns()) {
+        values.emplace_back(column.GetExpr()->EvaluateAggregate(group_bys_, aggregates->aggregates_));
+      }
+      *tuple = Tuple(values, plan_->OutputSchema());
+      return true;
+    }
+  }
+  return false;
+}
+
+bool AggregationExecutor::NextBatch(VectorBatch *batch) {
+  batch->Reset(plan_->OutputSchema());
+  std::vector<Value> values;
+  values.reserve(plan_->OutputSchema()->GetColumnCount());
+  const AggregateValue *aggregates;
+  while (!batch->IsFull() && table_->NextGroup(&group_bys_, &aggregates)) {
+    if (having_ == nullptr ||
+        AbstractExpression::IsTrue(having_->EvaluateAggregate(group_bys_, aggregates->aggregates_))) {
+      values.clear();
+      for (const auto &column : plan_->OutputSchema()->GetColumns()) {
+        values.emplace_back(column.GetExpr()->EvaluateAggregate(group_bys_, aggregates->aggregates_));
+      }
+      batch->AppendRow(values);
+    }
+  }
+  return batch->GetNumSelected() > 0;
+}
+
+}  // namespace bustub
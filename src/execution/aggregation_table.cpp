@@ -0,0 +1,691 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_table.cpp
+//
+// Identification: src/execution/aggregation_table.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/aggregation_table.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/util/hash_util.h"
+#include "execution/executors/aggregation_executor.h"
+#include "storage/table/tmp_tuple_run.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * A group-by key of up to MAX_COLUMNS fixed-width values, each widened to 64 bits. A NULL is stored as the NULL value
+ * of its type, so all NULLs of a column fall into one group.
+ */
+struct CompactAggregateKey {
+  static constexpr size_t MAX_COLUMNS = 4;
+
+  bool operator==(const CompactAggregateKey &other) const { return words_ == other.words_; }
+
+  std::array<uint64_t, MAX_COLUMNS> words_{};
+};
+
+struct CompactAggregateKeyHash {
+  size_t operator()(const CompactAggregateKey &key) const {
+    size_t hash = 0;
+    for (const uint64_t word : key.words_) {
+      hash = HashUtil::CombineHashes(hash, std::hash<uint64_t>()(word));
+    }
+    return hash;
+  }
+};
+
+/** Packs group-by values of fixed-width types into a CompactAggregateKey. */
+class CompactKeyCodec {
+ public:
+  using Key = CompactAggregateKey;
+  using Hash = CompactAggregateKeyHash;
+  using Equal = std::equal_to<CompactAggregateKey>;
+
+  /** @return true if keys of these types fit into a CompactAggregateKey */
+  static bool Supports(const std::vector<TypeId> &types) {
+    if (types.size() > CompactAggregateKey::MAX_COLUMNS) {
+      return false;
+    }
+    for (const TypeId type : types) {
+      if (type == TypeId::VARCHAR || type == TypeId::INVALID) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  explicit CompactKeyCodec(std::vector<TypeId> types) : types_(std::move(types)) {}
+
+  /** @return the key of row, from one column of values per group-by expression */
+  Key Encode(const std::vector<std::vector<Value>> &columns, uint32_t row) const {
+    Key key;
+    for (size_t i = 0; i < types_.size(); i++) {
+      key.words_[i] = Pack(types_[i], columns[i][row]);
+    }
+    return key;
+  }
+
+  /** @return the key of a group's values */
+  Key Encode(const std::vector<Value> &values) const {
+    Key key;
+    for (size_t i = 0; i < types_.size(); i++) {
+      key.words_[i] = Pack(types_[i], values[i]);
+    }
+    return key;
+  }
+
+  /** Unpacks a key into its group-by values. */
+  void Decode(const Key &key, std::vector<Value> *values) const {
+    values->clear();
+    for (size_t i = 0; i < types_.size(); i++) {
+      switch (types_[i]) {
+        case TypeId::DECIMAL: {
+          double decimal;
+          memcpy(&decimal, &key.words_[i], sizeof(decimal));
+          values->emplace_back(types_[i], decimal);
+          break;
+        }
+        case TypeId::TIMESTAMP:
+          values->emplace_back(types_[i], key.words_[i]);
+          break;
+        default:
+          values->emplace_back(types_[i], static_cast<int64_t>(key.words_[i]));
+          break;
+      }
+    }
+  }
+
+  /** @return the bytes a key takes */
+  size_t Size(const Key & /*key*/) const { return sizeof(Key); }
+
+ private:
+  /** @return a value widened to a word */
+  static uint64_t Pack(TypeId type, const Value &value) {
+    BUSTUB_ASSERT(value.GetTypeId() == type, "Group-by value does not have the type of its expression.");
+    switch (type) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return static_cast<uint64_t>(static_cast<int64_t>(value.GetAs<int8_t>()));
+      case TypeId::SMALLINT:
+        return static_cast<uint64_t>(static_cast<int64_t>(value.GetAs<int16_t>()));
+      case TypeId::INTEGER:
+        return static_cast<uint64_t>(static_cast<int64_t>(value.GetAs<int32_t>()));
+      case TypeId::BIGINT:
+        return static_cast<uint64_t>(value.GetAs<int64_t>());
+      case TypeId::DECIMAL: {
+        // -0.0 equals 0.0, so both have to end up in the same group
+        const double decimal = value.GetAs<double>() == 0 ? 0 : value.GetAs<double>();
+        uint64_t word;
+        memcpy(&word, &decimal, sizeof(decimal));
+        return word;
+      }
+      default:
+        return value.GetAs<uint64_t>();
+    }
+  }
+
+  std::vector<TypeId> types_;
+};
+
+/**
+ * Hashes an AggregateKey like GroupKeyEqual compares it. Unlike std::hash<AggregateKey>, a NULL is hashed as a value
+ * of its own instead of being skipped.
+ */
+struct GroupKeyHash {
+  size_t operator()(const AggregateKey &key) const {
+    size_t hash = 0;
+    for (const auto &value : key.group_bys_) {
+      hash = HashUtil::CombineHashes(hash, value.IsNull() ? 0 : HashUtil::HashValue(&value));
+    }
+    return hash;
+  }
+};
+
+/** Compares AggregateKeys for grouping, where unlike in SQL comparisons NULL equals NULL. */
+struct GroupKeyEqual {
+  bool operator()(const AggregateKey &a, const AggregateKey &b) const {
+    for (size_t i = 0; i < a.group_bys_.size(); i++) {
+      const Value &lhs = a.group_bys_[i];
+      const Value &rhs = b.group_bys_[i];
+      if (lhs.IsNull() || rhs.IsNull()) {
+        if (lhs.IsNull() != rhs.IsNull()) {
+          return false;
+        }
+      } else if (lhs.CompareEquals(rhs) != CmpBool::CmpTrue) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+/** Keeps group-by values of any type in an AggregateKey. */
+class ValueKeyCodec {
+ public:
+  using Key = AggregateKey;
+  using Hash = GroupKeyHash;
+  using Equal = GroupKeyEqual;
+
+  explicit ValueKeyCodec(size_t num_columns) : num_columns_(num_columns) {}
+
+  Key Encode(const std::vector<std::vector<Value>> &columns, uint32_t row) const {
+    Key key;
+    key.group_bys_.reserve(num_columns_);
+    for (size_t i = 0; i < num_columns_; i++) {
+      key.group_bys_.push_back(columns[i][row]);
+    }
+    return key;
+  }
+
+  Key Encode(const std::vector<Value> &values) const {
+    Key key;
+    key.group_bys_ = values;
+    return key;
+  }
+
+  void Decode(const Key &key, std::vector<Value> *values) const { *values = key.group_bys_; }
+
+  size_t Size(const Key &key) const {
+    size_t size = sizeof(Key);
+    for (const auto &value : key.group_bys_) {
+      size += sizeof(Value) + (value.GetTypeId() == TypeId::VARCHAR && !value.IsNull() ? value.GetLength() : 0);
+    }
+    return size;
+  }
+
+ private:
+  size_t num_columns_;
+};
+
+/** Hands batches from the thread reading the child to the workers, blocking the reader while the workers lag. */
+class BatchQueue {
+ public:
+  static constexpr size_t MAX_BATCHES = 16;
+
+  void Push(VectorBatch &&batch) {
+    std::unique_lock lock(latch_);
+    not_full_.wait(lock, [&] { return batches_.size() < MAX_BATCHES; });
+    batches_.emplace_back(std::move(batch));
+    not_empty_.notify_one();
+  }
+
+  /** @return false once the queue is closed and drained */
+  bool Pop(VectorBatch *batch) {
+    std::unique_lock lock(latch_);
+    not_empty_.wait(lock, [&] { return !batches_.empty() || closed_; });
+    if (batches_.empty()) {
+      return false;
+    }
+    *batch = std::move(batches_.front());
+    batches_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  void Close() {
+    std::unique_lock lock(latch_);
+    closed_ = true;
+    not_empty_.notify_all();
+  }
+
+ private:
+  std::mutex latch_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<VectorBatch> batches_;
+  bool closed_{false};
+};
+
+template <class KeyCodec>
+class PartitionedAggregationTable : public AggregationTable {
+ public:
+  /** Number of hash partitions of every worker's table, and of the merged table. */
+  static constexpr size_t NUM_PARTITIONS = 16;
+  /** Number of partitions a spilled partition that does not fit into memory is split into. */
+  static constexpr size_t FANOUT = 8;
+  /** Spilled partitions are split at most this often. Deeper ones are aggregated in memory regardless. */
+  static constexpr uint32_t MAX_DEPTH = 4;
+
+  PartitionedAggregationTable(const AggregationPlanNode *plan, const SimpleAggregationHashTable *functions,
+                              BufferPoolManager *bpm, KeyCodec codec)
+      : plan_(plan),
+        functions_(functions),
+        bpm_(bpm),
+        codec_(std::move(codec)),
+        spill_schema_(MakeSpillSchema(plan)) {
+    const size_t num_threads = std::max<size_t>(plan->GetNumThreads(), 1);
+    worker_budget_ = std::max<size_t>(plan->GetMemoryBudget() / num_threads, 1);
+    for (size_t i = 0; i < num_threads; i++) {
+      workers_.emplace_back(std::make_unique<Worker>());
+    }
+    if (num_threads > 1) {
+      for (auto &worker : workers_) {
+        threads_.emplace_back(&PartitionedAggregationTable::RunWorker, this, worker.get());
+      }
+    }
+  }
+
+  ~PartitionedAggregationTable() override { JoinWorkers(); }
+
+  void Consume(VectorBatch &&batch) override {
+    if (threads_.empty()) {
+      Aggregate(workers_[0].get(), batch);
+      return;
+    }
+    queue_.Push(std::move(batch));
+  }
+
+  void Finish() override {
+    JoinWorkers();
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+    if (std::any_of(workers_.begin(), workers_.end(), [](const auto &worker) { return worker->spilled_; })) {
+      // the groups do not fit into memory: spill the rest too, they are merged a partition at a time by NextGroup
+      for (auto &worker : workers_) {
+        Spill(worker.get());
+      }
+      for (size_t partition = 0; partition < NUM_PARTITIONS; partition++) {
+        SpilledPartition spilled{{}, 0};
+        for (auto &worker : workers_) {
+          if (worker->runs_[partition] != nullptr) {
+            spilled.runs_.emplace_back(std::move(worker->runs_[partition]));
+          }
+        }
+        if (!spilled.runs_.empty()) {
+          spilled_.emplace_back(std::move(spilled));
+        }
+      }
+    } else if (workers_.size() > 1) {
+      // worker i merges the partitions i, i + n, i + 2n, ... of all tables into the first worker's table
+      std::vector<std::thread> mergers;
+      for (size_t i = 0; i < workers_.size(); i++) {
+        mergers.emplace_back([this, i] {
+          for (size_t partition = i; partition < NUM_PARTITIONS; partition += workers_.size()) {
+            MergePartition(partition);
+          }
+        });
+      }
+      for (auto &merger : mergers) {
+        merger.join();
+      }
+      if (error_) {
+        std::rethrow_exception(error_);
+      }
+    }
+    Rewind();
+  }
+
+  bool NextGroup(std::vector<Value> *group_bys, const AggregateValue **aggregates) override {
+    while (group_iter_ == current_->end()) {
+      if (!NextPartition()) {
+        return false;
+      }
+    }
+    codec_.Decode(group_iter_->first, group_bys);
+    *aggregates = &group_iter_->second;
+    ++group_iter_;
+    return true;
+  }
+
+  void Rewind() override {
+    if (spilled_.empty()) {
+      partition_index_ = 0;
+      current_ = &workers_[0]->partitions_[0];
+    } else {
+      spilled_index_ = 0;
+      loaded_.clear();
+      current_ = &loaded_;
+    }
+    group_iter_ = current_->begin();
+  }
+
+  size_t GetNumSpilledPartitions() const override { return num_spilled_partitions_; }
+
+ private:
+  using Key = typename KeyCodec::Key;
+  using Partition = std::unordered_map<Key, AggregateValue, typename KeyCodec::Hash, typename KeyCodec::Equal>;
+
+  /** The tables a worker aggregates into, the runs it spilled them to, and buffers reused across batches. */
+  struct Worker {
+    std::vector<Partition> partitions_ = std::vector<Partition>(NUM_PARTITIONS);
+    /** Estimated bytes of the groups in partitions_. */
+    size_t memory_{0};
+    std::vector<std::unique_ptr<TmpTupleRun>> runs_ = std::vector<std::unique_ptr<TmpTupleRun>>(NUM_PARTITIONS);
+    bool spilled_{false};
+    std::vector<std::vector<Value>> group_bys_;
+    std::vector<std::vector<Value>> aggregates_;
+    AggregateValue input_;
+    std::vector<Value> spill_values_;
+  };
+
+  /** The partially aggregated groups of a partition, spilled by one or more workers. */
+  struct SpilledPartition {
+    /** The runs holding the groups, empty once the partition has been split. */
+    std::vector<std::unique_ptr<TmpTupleRun>> runs_;
+    uint32_t depth_;
+  };
+
+  /**
+   * A spilled group is a tuple of its group-by values followed by a type and the raw bytes of every aggregate value,
+   * as the type of an aggregate value depends on the values it has been combined with.
+   */
+  static Schema MakeSpillSchema(const AggregationPlanNode *plan) {
+    std::vector<Column> columns;
+    for (const auto *expr : plan->GetGroupBys()) {
+      if (expr->GetReturnType() == TypeId::VARCHAR) {
+        columns.emplace_back("group_by", TypeId::VARCHAR, BUSTUB_PAGE_SIZE);
+      } else {
+        columns.emplace_back("group_by", expr->GetReturnType());
+      }
+    }
+    for (size_t i = 0; i < plan->GetAggregates().size(); i++) {
+      columns.emplace_back("aggregate_type", TypeId::TINYINT);
+      columns.emplace_back("aggregate", TypeId::BIGINT);
+    }
+    return Schema(columns);
+  }
+
+  void RunWorker(Worker *worker) {
+    VectorBatch batch;
+    while (queue_.Pop(&batch)) {
+      // after a failure the rest of the input is drained, so that the reader does not block
+      if (failed_) {
+        continue;
+      }
+      try {
+        Aggregate(worker, batch);
+      } catch (...) {
+        Fail();
+      }
+    }
+  }
+
+  void Aggregate(Worker *worker, const VectorBatch &batch) {
+    const auto &group_by_exprs = plan_->GetGroupBys();
+    const auto &aggregate_exprs = plan_->GetAggregates();
+    worker->group_bys_.resize(group_by_exprs.size());
+    worker->aggregates_.resize(aggregate_exprs.size());
+    worker->input_.aggregates_.resize(aggregate_exprs.size());
+    for (size_t i = 0; i < group_by_exprs.size(); i++) {
+      group_by_exprs[i]->EvaluateBatch(batch, &worker->group_bys_[i]);
+    }
+    for (size_t i = 0; i < aggregate_exprs.size(); i++) {
+      aggregate_exprs[i]->EvaluateBatch(batch, &worker->aggregates_[i]);
+    }
+    const typename KeyCodec::Hash hasher;
+    for (const uint32_t row : batch.GetSelection()) {
+      Key key = codec_.Encode(worker->group_bys_, row);
+      Partition &partition = worker->partitions_[hasher(key) % NUM_PARTITIONS];
+      auto iter = partition.find(key);
+      if (iter == partition.end()) {
+        worker->memory_ += GroupSize(key);
+        iter = partition.emplace(std::move(key), functions_->GenerateInitialAggregateValue()).first;
+      }
+      for (size_t i = 0; i < aggregate_exprs.size(); i++) {
+        worker->input_.aggregates_[i] = worker->aggregates_[i][row];
+      }
+      functions_->CombineAggregateValues(&iter->second, worker->input_);
+    }
+    if (worker->memory_ > worker_budget_) {
+      Spill(worker);
+    }
+  }
+
+  /** @return the estimated bytes a group takes in a table, including the node of the hash map */
+  size_t GroupSize(const Key &key) const {
+    return codec_.Size(key) + sizeof(AggregateValue) + plan_->GetAggregates().size() * sizeof(Value) +
+           2 * sizeof(void *) + sizeof(size_t);
+  }
+
+  /** Appends the groups of a worker's tables to its runs, partition by partition, and empties the tables. */
+  void Spill(Worker *worker) {
+    for (size_t i = 0; i < NUM_PARTITIONS; i++) {
+      Partition &partition = worker->partitions_[i];
+      if (partition.empty()) {
+        continue;
+      }
+      if (worker->runs_[i] == nullptr) {
+        worker->runs_[i] = std::make_unique<TmpTupleRun>(bpm_);
+      }
+      for (const auto &[key, value] : partition) {
+        worker->runs_[i]->Append(MakeSpillTuple(key, value, &worker->spill_values_));
+      }
+      // release the buckets as well
+      partition = Partition();
+    }
+    worker->memory_ = 0;
+    worker->spilled_ = true;
+  }
+
+  Tuple MakeSpillTuple(const Key &key, const AggregateValue &value, std::vector<Value> *values) const {
+    codec_.Decode(key, values);
+    for (const auto &aggregate : value.aggregates_) {
+      BUSTUB_ASSERT(aggregate.GetTypeId() != TypeId::VARCHAR, "Aggregate values are fixed-width.");
+      char raw[sizeof(int64_t)]{};
+      aggregate.SerializeTo(raw);
+      int64_t bits;
+      memcpy(&bits, raw, sizeof(bits));
+      values->emplace_back(ValueFactory::GetTinyIntValue(static_cast<int8_t>(aggregate.GetTypeId())));
+      values->emplace_back(ValueFactory::GetBigIntValue(bits));
+    }
+    return Tuple(*values, &spill_schema_);
+  }
+
+  /** Reads a spilled group back. */
+  void ReadSpillTuple(const Tuple &tuple, Key *key, AggregateValue *value) {
+    const size_t num_group_bys = plan_->GetGroupBys().size();
+    spill_values_.clear();
+    for (size_t i = 0; i < num_group_bys; i++) {
+      spill_values_.emplace_back(tuple.GetValue(&spill_schema_, i));
+    }
+    *key = codec_.Encode(spill_values_);
+    value->aggregates_.clear();
+    for (size_t i = 0; i < plan_->GetAggregates().size(); i++) {
+      const auto type = static_cast<TypeId>(tuple.GetValue(&spill_schema_, num_group_bys + 2 * i).GetAs<int8_t>());
+      const int64_t bits = tuple.GetValue(&spill_schema_, num_group_bys + 2 * i + 1).GetAs<int64_t>();
+      char raw[sizeof(int64_t)];
+      memcpy(raw, &bits, sizeof(bits));
+      value->aggregates_.emplace_back(Value::DeserializeFrom(raw, type));
+    }
+  }
+
+  /** Moves on to the next partition to produce groups from. @return false if there is none left */
+  bool NextPartition() {
+    if (spilled_.empty()) {
+      if (partition_index_ + 1 >= NUM_PARTITIONS) {
+        return false;
+      }
+      current_ = &workers_[0]->partitions_[++partition_index_];
+    } else if (!LoadSpilledPartition()) {
+      return false;
+    }
+    group_iter_ = current_->begin();
+    return true;
+  }
+
+  /**
+   * Merges the groups of the next spilled partition into loaded_. A partition whose groups exceed the memory budget
+   * is split into FANOUT partitions by a hash that differs per depth, which are loaded later on.
+   * @return false if every spilled partition has been loaded
+   */
+  bool LoadSpilledPartition() {
+    Tuple tuple;
+    Key key;
+    AggregateValue value;
+    while (spilled_index_ < spilled_.size()) {
+      const size_t index = spilled_index_++;
+      if (spilled_[index].runs_.empty()) {
+        continue;
+      }
+      loaded_.clear();
+      size_t memory = 0;
+      bool fits = true;
+      for (const auto &run : spilled_[index].runs_) {
+        auto reader = run->Read();
+        while (fits && reader.Next(&tuple)) {
+          ReadSpillTuple(tuple, &key, &value);
+          auto [iter, inserted] = loaded_.try_emplace(key, value);
+          if (inserted) {
+            memory += GroupSize(key);
+            fits = memory <= plan_->GetMemoryBudget() || spilled_[index].depth_ >= MAX_DEPTH;
+          } else {
+            functions_->MergeAggregateValues(&iter->second, value);
+          }
+        }
+      }
+      if (fits) {
+        current_ = &loaded_;
+        num_spilled_partitions_++;
+        return true;
+      }
+      loaded_.clear();
+      SplitSpilledPartition(index);
+    }
+    return false;
+  }
+
+  void SplitSpilledPartition(size_t index) {
+    const uint32_t depth = spilled_[index].depth_ + 1;
+    const auto runs = std::move(spilled_[index].runs_);
+    spilled_[index].runs_.clear();
+    std::vector<std::unique_ptr<TmpTupleRun>> split(FANOUT);
+    const typename KeyCodec::Hash hasher;
+    Tuple tuple;
+    Key key;
+    AggregateValue value;
+    for (const auto &run : runs) {
+      auto reader = run->Read();
+      while (reader.Next(&tuple)) {
+        ReadSpillTuple(tuple, &key, &value);
+        // combine the hash with the depth, so that every level splits a partition differently
+        auto &target = split[HashUtil::CombineHashes(hasher(key), depth) % FANOUT];
+        if (target == nullptr) {
+          target = std::make_unique<TmpTupleRun>(bpm_);
+        }
+        target->Append(tuple);
+      }
+    }
+    for (auto &run : split) {
+      if (run != nullptr) {
+        SpilledPartition partition{{}, depth};
+        partition.runs_.emplace_back(std::move(run));
+        spilled_.emplace_back(std::move(partition));
+      }
+    }
+  }
+
+  void MergePartition(size_t index) {
+    try {
+      Partition &result = workers_[0]->partitions_[index];
+      for (size_t i = 1; i < workers_.size(); i++) {
+        Partition &partition = workers_[i]->partitions_[index];
+        if (result.size() < partition.size()) {
+          // merge the smaller table into the larger one
+          std::swap(result, partition);
+        }
+        for (auto &[key, value] : partition) {
+          auto [iter, inserted] = result.try_emplace(key, value);
+          if (!inserted) {
+            functions_->MergeAggregateValues(&iter->second, value);
+          }
+        }
+        partition.clear();
+      }
+    } catch (...) {
+      Fail();
+    }
+  }
+
+  void Fail() {
+    std::scoped_lock lock(error_latch_);
+    if (!error_) {
+      error_ = std::current_exception();
+    }
+    failed_ = true;
+  }
+
+  void JoinWorkers() {
+    if (threads_.empty()) {
+      return;
+    }
+    queue_.Close();
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+    threads_.clear();
+  }
+
+  const AggregationPlanNode *plan_;
+  const SimpleAggregationHashTable *functions_;
+  BufferPoolManager *bpm_;
+  KeyCodec codec_;
+  Schema spill_schema_;
+  /** Estimated bytes of groups a worker may hold before it spills them. */
+  size_t worker_budget_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  BatchQueue queue_;
+
+  /** The first exception a worker ran into, rethrown by Finish. */
+  std::mutex error_latch_;
+  std::exception_ptr error_;
+  std::atomic<bool> failed_{false};
+
+  /** The spilled partitions, empty if every group fit into memory, and the next one to load. */
+  std::vector<SpilledPartition> spilled_;
+  size_t spilled_index_{0};
+  /** The groups of the spilled partition being produced. */
+  Partition loaded_;
+  size_t num_spilled_partitions_{0};
+  std::vector<Value> spill_values_;
+
+  /** The partition groups are being produced from, and the next group NextGroup produces. */
+  size_t partition_index_{0};
+  const Partition *current_{nullptr};
+  typename Partition::const_iterator group_iter_;
+};
+
+}  // namespace
+
+std::unique_ptr<AggregationTable> AggregationTable::Create(const AggregationPlanNode *plan,
+                                                           const SimpleAggregationHashTable *functions,
+                                                           BufferPoolManager *bpm) {
+  std::vector<TypeId> types;
+  for (const auto *expr : plan->GetGroupBys()) {
+    types.push_back(expr->GetReturnType());
+  }
+  if (CompactKeyCodec::Supports(types)) {
+    return std::make_unique<PartitionedAggregationTable<CompactKeyCodec>>(plan, functions, bpm,
+                                                                          CompactKeyCodec(std::move(types)));
+  }
+  return std::make_unique<PartitionedAggregationTable<ValueKeyCodec>>(plan, functions, bpm,
+                                                                      ValueKeyCodec(types.size()));
+}
+
+}  // namespace bustub
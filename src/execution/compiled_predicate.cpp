@@ -0,0 +1,210 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_predicate.cpp
+//
+// Identification: src/execution/compiled_predicate.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/expressions/compiled_predicate.h"
+
+#include <cstring>
+#include <memory>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "type/limits.h"
+
+namespace bustub {
+
+namespace {
+
+/** The C++ type a fixed-width TypeId is stored as, and the value that stands for NULL. */
+template <TypeId T>
+struct NativeType;
+
+template <>
+struct NativeType<TypeId::BOOLEAN> {
+  using Type = int8_t;
+  static constexpr Type NULL_VALUE = BUSTUB_BOOLEAN_NULL;
+};
+
+template <>
+struct NativeType<TypeId::TINYINT> {
+  using Type = int8_t;
+  static constexpr Type NULL_VALUE = BUSTUB_INT8_NULL;
+};
+
+template <>
+struct NativeType<TypeId::SMALLINT> {
+  using Type = int16_t;
+  static constexpr Type NULL_VALUE = BUSTUB_INT16_NULL;
+};
+
+template <>
+struct NativeType<TypeId::INTEGER> {
+  using Type = int32_t;
+  static constexpr Type NULL_VALUE = BUSTUB_INT32_NULL;
+};
+
+template <>
+struct NativeType<TypeId::BIGINT> {
+  using Type = int64_t;
+  static constexpr Type NULL_VALUE = BUSTUB_INT64_NULL;
+};
+
+template <>
+struct NativeType<TypeId::DECIMAL> {
+  using Type = double;
+  static constexpr Type NULL_VALUE = BUSTUB_DECIMAL_NULL;
+};
+
+template <>
+struct NativeType<TypeId::TIMESTAMP> {
+  using Type = uint64_t;
+  static constexpr Type NULL_VALUE = BUSTUB_TIMESTAMP_NULL;
+};
+
+/** Compares two raw values the way Value's comparisons do, after the usual arithmetic conversions. */
+template <TypeId L, TypeId R, ComparisonType Op>
+CmpBool Compare(const char *lhs, const char *rhs) {
+  typename NativeType<L>::Type left;
+  typename NativeType<R>::Type right;
+  // tuple data is not aligned
+  memcpy(&left, lhs, sizeof(left));
+  memcpy(&right, rhs, sizeof(right));
+  if (left == NativeType<L>::NULL_VALUE || right == NativeType<R>::NULL_VALUE) {
+    return CmpBool::CmpNull;
+  }
+  bool result;
+  if constexpr (Op == ComparisonType::Equal) {
+    result = left == right;
+  } else if constexpr (Op == ComparisonType::NotEqual) {
+    result = left != right;
+  } else if constexpr (Op == ComparisonType::LessThan) {
+    result = left < right;
+  } else if constexpr (Op == ComparisonType::LessThanOrEqual) {
+    result = left <= right;
+  } else if constexpr (Op == ComparisonType::GreaterThan) {
+    result = left > right;
+  } else {
+    result = left >= right;
+  }
+  return result ? CmpBool::CmpTrue : CmpBool::CmpFalse;
+}
+
+template <TypeId L, TypeId R>
+CompiledPredicate::CompareFunction SelectOperator(ComparisonType op) {
+  switch (op) {
+    case ComparisonType::Equal:
+      return &Compare<L, R, ComparisonType::Equal>;
+    case ComparisonType::NotEqual:
+      return &Compare<L, R, ComparisonType::NotEqual>;
+    case ComparisonType::LessThan:
+      return &Compare<L, R, ComparisonType::LessThan>;
+    case ComparisonType::LessThanOrEqual:
+      return &Compare<L, R, ComparisonType::LessThanOrEqual>;
+    case ComparisonType::GreaterThan:
+      return &Compare<L, R, ComparisonType::GreaterThan>;
+    case ComparisonType::GreaterThanOrEqual:
+      return &Compare<L, R, ComparisonType::GreaterThanOrEqual>;
+  }
+  return nullptr;
+}
+
+/** Numbers compare with numbers of any width. */
+template <TypeId L>
+CompiledPredicate::CompareFunction SelectNumeric(TypeId right, ComparisonType op) {
+  switch (right) {
+    case TypeId::TINYINT:
+      return SelectOperator<L, TypeId::TINYINT>(op);
+    case TypeId::SMALLINT:
+      return SelectOperator<L, TypeId::SMALLINT>(op);
+    case TypeId::INTEGER:
+      return SelectOperator<L, TypeId::INTEGER>(op);
+    case TypeId::BIGINT:
+      return SelectOperator<L, TypeId::BIGINT>(op);
+    case TypeId::DECIMAL:
+      return SelectOperator<L, TypeId::DECIMAL>(op);
+    default:
+      return nullptr;
+  }
+}
+
+/** @return the comparison function for the operand types, nullptr if they do not compare without a Value */
+CompiledPredicate::CompareFunction SelectFunction(TypeId left, TypeId right, ComparisonType op) {
+  switch (left) {
+    case TypeId::TINYINT:
+      return SelectNumeric<TypeId::TINYINT>(right, op);
+    case TypeId::SMALLINT:
+      return SelectNumeric<TypeId::SMALLINT>(right, op);
+    case TypeId::INTEGER:
+      return SelectNumeric<TypeId::INTEGER>(right, op);
+    case TypeId::BIGINT:
+      return SelectNumeric<TypeId::BIGINT>(right, op);
+    case TypeId::DECIMAL:
+      return SelectNumeric<TypeId::DECIMAL>(right, op);
+    case TypeId::BOOLEAN:
+      return right == TypeId::BOOLEAN ? SelectOperator<TypeId::BOOLEAN, TypeId::BOOLEAN>(op) : nullptr;
+    case TypeId::TIMESTAMP:
+      return right == TypeId::TIMESTAMP ? SelectOperator<TypeId::TIMESTAMP, TypeId::TIMESTAMP>(op) : nullptr;
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<CompiledPredicate> CompiledPredicate::Compile(const AbstractExpression *expr,
+                                                              const Schema *left_schema,
+                                                              const Schema *right_schema) {
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(expr);
+  if (comparison == nullptr) {
+    return nullptr;
+  }
+  auto predicate = std::make_unique<CompiledPredicate>();
+  TypeId left_type;
+  TypeId right_type;
+  if (!CompileOperand(comparison->GetChildAt(0), left_schema, right_schema, &predicate->lhs_, &left_type) ||
+      !CompileOperand(comparison->GetChildAt(1), left_schema, right_schema, &predicate->rhs_, &right_type)) {
+    return nullptr;
+  }
+  predicate->compare_ = SelectFunction(left_type, right_type, comparison->GetComparisonType());
+  if (predicate->compare_ == nullptr) {
+    return nullptr;
+  }
+  return predicate;
+}
+
+bool CompiledPredicate::CompileOperand(const AbstractExpression *expr, const Schema *left_schema,
+                                       const Schema *right_schema, Operand *operand, TypeId *type) {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    operand->tuple_idx_ = right_schema == nullptr ? 0 : column->GetTupleIdx();
+    const Schema *schema = operand->tuple_idx_ == 0 ? left_schema : right_schema;
+    if (column->GetColIdx() >= schema->GetColumnCount()) {
+      return false;
+    }
+    const Column &col = schema->GetColumn(column->GetColIdx());
+    operand->offset_ = col.GetOffset();
+    *type = col.GetType();
+    return col.IsInlined();
+  }
+  if (const auto *constant = dynamic_cast<const ConstantValueExpression *>(expr); constant != nullptr) {
+    const Value value = constant->Evaluate(nullptr, nullptr);
+    *type = value.GetTypeId();
+    if (*type == TypeId::VARCHAR || *type == TypeId::INVALID) {
+      return false;
+    }
+    operand->is_constant_ = true;
+    value.SerializeTo(operand->constant_);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace bustub
@@ -0,0 +1,336 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_join_executor.cpp
+//
+// Identification: src/execution/hash_join_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/hash_join_executor.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+
+namespace bustub {
+
+HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
+                                   std::unique_ptr<AbstractExecutor> &&left_executor,
+                                   std::unique_ptr<AbstractExecutor> &&right_executor)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      compiled_predicate_(plan_->Predicate() == nullptr
+                              ? nullptr
+                              : CompiledPredicate::Compile(plan_->Predicate(), plan_->GetLeftPlan()->OutputSchema(),
+                                                           plan_->GetRightPlan()->OutputSchema())),
+      left_executor_(std::move(left_executor)),
+      right_executor_(std::move(right_executor)) {}
+
+void HashJoinExecutor::Init() {
+  left_executor_->Init();
+  right_executor_->Init();
+  hash_table_.clear();
+  probe_tuples_.clear();
+  probe_index_ = 0;
+  probe_child_ = nullptr;
+  probe_reader_.reset();
+  partition_ = Partition();
+  partitions_.clear();
+  num_partitions_joined_ = 0;
+  probe_batch_.Reset(nullptr);
+  probe_pos_ = 0;
+  matches_ = nullptr;
+
+  const size_t budget = plan_->GetMemoryBudget();
+  std::vector<Tuple> left_tuples;
+  std::vector<Tuple> right_tuples;
+  size_t left_size = 0;
+  size_t right_size = 0;
+  const bool left_fits = Drain(left_executor_.get(), budget, &left_tuples, &left_size);
+  if (left_fits && left_tuples.empty()) {
+    return;
+  }
+  // the right side only becomes the build side if it is the smaller one
+  const bool right_fits = Drain(right_executor_.get(), left_fits ? left_size : budget, &right_tuples, &right_size);
+  if (right_fits) {
+    Build(
+        [&, i = size_t{0}](Tuple *tuple) mutable {
+          if (i == right_tuples.size()) {
+            return false;
+          }
+          *tuple = right_tuples[i++];
+          return true;
+        },
+        false);
+    probe_tuples_ = std::move(left_tuples);
+    probe_child_ = left_executor_.get();
+    return;
+  }
+  if (left_fits) {
+    Build(
+        [&, i = size_t{0}](Tuple *tuple) mutable {
+          if (i == left_tuples.size()) {
+            return false;
+          }
+          *tuple = left_tuples[i++];
+          return true;
+        },
+        true);
+    probe_tuples_ = std::move(right_tuples);
+    probe_child_ = right_executor_.get();
+    return;
+  }
+
+  // neither side fits, split both into partitions
+  auto buffered_then_child = [](std::vector<Tuple> *buffered, AbstractExecutor *child) {
+    return [buffered, child, i = size_t{0}](Tuple *tuple) mutable {
+      if (i < buffered->size()) {
+        *tuple = (*buffered)[i++];
+        return true;
+      }
+      RID rid;
+      return child->Next(tuple, &rid);
+    };
+  };
+  SplitAndQueue(buffered_then_child(&left_tuples, left_executor_.get()),
+                buffered_then_child(&right_tuples, right_executor_.get()), 0);
+}
+
+bool HashJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  const Tuple *build_tuple;
+  if (!NextMatch(&build_tuple)) {
+    return false;
+  }
+  const Tuple &probe_tuple = ProbeTuple();
+  const Tuple &left_tuple = build_left_ ? *build_tuple : probe_tuple;
+  const Tuple &right_tuple = build_left_ ? probe_tuple : *build_tuple;
+  const Schema *left_schema = plan_->GetLeftPlan()->OutputSchema();
+  const Schema *right_schema = plan_->GetRightPlan()->OutputSchema();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema()->GetColumnCount());
+  for (const auto &column : GetOutputSchema()->GetColumns()) {
+    values.emplace_back(column.GetExpr()->EvaluateJoin(&left_tuple, left_schema, &right_tuple, right_schema));
+  }
+  *tuple = Tuple(values, GetOutputSchema());
+  return true;
+}
+
+bool HashJoinExecutor::NextBatch(VectorBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  const Schema *left_schema = plan_->GetLeftPlan()->OutputSchema();
+  const Schema *right_schema = plan_->GetRightPlan()->OutputSchema();
+  const auto &columns = GetOutputSchema()->GetColumns();
+  std::vector<const ColumnValueExpression *> column_exprs;
+  column_exprs.reserve(columns.size());
+  for (const auto &column : columns) {
+    column_exprs.push_back(dynamic_cast<const ColumnValueExpression *>(column.GetExpr()));
+  }
+  std::vector<Value> values;
+  values.reserve(columns.size());
+  const Tuple *build_tuple;
+  while (!batch->IsFull() && NextMatch(&build_tuple)) {
+    // the build side may change with every partition pair
+    const uint32_t probe_idx = build_left_ ? 1 : 0;
+    const Schema *build_schema = build_left_ ? left_schema : right_schema;
+    values.clear();
+    for (size_t i = 0; i < columns.size(); i++) {
+      const ColumnValueExpression *expr = column_exprs[i];
+      if (expr == nullptr) {
+        const Tuple &probe_tuple = ProbeTuple();
+        const Tuple &left_tuple = build_left_ ? *build_tuple : probe_tuple;
+        const Tuple &right_tuple = build_left_ ? probe_tuple : *build_tuple;
+        values.emplace_back(columns[i].GetExpr()->EvaluateJoin(&left_tuple, left_schema, &right_tuple, right_schema));
+      } else if (expr->GetTupleIdx() == probe_idx) {
+        values.push_back(probe_batch_.GetValue(probe_row_, expr->GetColIdx()));
+      } else {
+        values.emplace_back(build_tuple->GetValue(build_schema, expr->GetColIdx()));
+      }
+    }
+    batch->AppendRow(values);
+  }
+  return batch->GetNumSelected() > 0;
+}
+
+bool HashJoinExecutor::NextMatch(const Tuple **build_tuple) {
+  const Schema *left_schema = plan_->GetLeftPlan()->OutputSchema();
+  const Schema *right_schema = plan_->GetRightPlan()->OutputSchema();
+  const AbstractExpression *predicate = plan_->Predicate();
+  while (true) {
+    while (matches_ != nullptr && match_index_ < matches_->size()) {
+      const Tuple &candidate = (*matches_)[match_index_++];
+      if (predicate != nullptr) {
+        const Tuple &probe_tuple = ProbeTuple();
+        const Tuple &left_tuple = build_left_ ? candidate : probe_tuple;
+        const Tuple &right_tuple = build_left_ ? probe_tuple : candidate;
+        const bool matches =
+            compiled_predicate_ != nullptr
+                ? compiled_predicate_->EvaluateJoin(&left_tuple, &right_tuple)
+                : AbstractExpression::IsTrue(
+                      predicate->EvaluateJoin(&left_tuple, left_schema, &right_tuple, right_schema));
+        if (!matches) {
+          continue;
+        }
+      }
+      *build_tuple = &candidate;
+      return true;
+    }
+    matches_ = nullptr;
+    if (probe_pos_ < probe_batch_.GetNumSelected()) {
+      probe_row_ = probe_batch_.GetSelection()[probe_pos_++];
+      has_probe_tuple_ = false;
+      HashJoinKey key;
+      key.keys_.reserve(probe_keys_.size());
+      for (const auto &column : probe_keys_) {
+        key.keys_.push_back(column[probe_row_]);
+      }
+      auto iter = hash_table_.find(key);
+      if (iter != hash_table_.end()) {
+        matches_ = &iter->second;
+        match_index_ = 0;
+      }
+      continue;
+    }
+    if (NextProbeBatch()) {
+      continue;
+    }
+    if (!NextPartition()) {
+      return false;
+    }
+  }
+}
+
+const Tuple &HashJoinExecutor::ProbeTuple() {
+  if (!has_probe_tuple_) {
+    probe_tuple_ = probe_batch_.MakeTuple(probe_row_);
+    has_probe_tuple_ = true;
+  }
+  return probe_tuple_;
+}
+
+HashJoinKey HashJoinExecutor::MakeKey(const Tuple &tuple, bool left) const {
+  const auto &exprs = left ? plan_->GetLeftKeys() : plan_->GetRightKeys();
+  const Schema *schema = left ? plan_->GetLeftPlan()->OutputSchema() : plan_->GetRightPlan()->OutputSchema();
+  std::vector<Value> keys;
+  keys.reserve(exprs.size());
+  for (const auto &expr : exprs) {
+    keys.emplace_back(expr->Evaluate(&tuple, schema));
+  }
+  return {keys};
+}
+
+bool HashJoinExecutor::Drain(AbstractExecutor *child, size_t limit, std::vector<Tuple> *tuples, size_t *size) {
+  Tuple tuple;
+  RID rid;
+  while (*size <= limit) {
+    if (!child->Next(&tuple, &rid)) {
+      return true;
+    }
+    *size += tuple.GetLength();
+    tuples->push_back(tuple);
+  }
+  return false;
+}
+
+std::vector<std::unique_ptr<TmpTupleRun>> HashJoinExecutor::Split(const std::function<bool(Tuple *)> &next,
+                                                                  bool left, uint32_t depth) {
+  std::vector<std::unique_ptr<TmpTupleRun>> runs;
+  for (size_t i = 0; i < FANOUT; i++) {
+    runs.emplace_back(std::make_unique<TmpTupleRun>(exec_ctx_->GetBufferPoolManager()));
+  }
+  Tuple tuple;
+  while (next(&tuple)) {
+    const HashJoinKey key = MakeKey(tuple, left);
+    bool has_null = false;
+    for (const auto &value : key.keys_) {
+      has_null = has_null || value.IsNull();
+    }
+    if (has_null) {
+      continue;
+    }
+    // combine the hash with the depth, so that every level splits a partition differently
+    const size_t hash = HashUtil::CombineHashes(std::hash<HashJoinKey>()(key), depth);
+    runs[hash % FANOUT]->Append(tuple);
+  }
+  return runs;
+}
+
+void HashJoinExecutor::SplitAndQueue(const std::function<bool(Tuple *)> &next_left,
+                                     const std::function<bool(Tuple *)> &next_right, uint32_t depth) {
+  auto left_runs = Split(next_left, true, depth);
+  auto right_runs = Split(next_right, false, depth);
+  for (size_t i = 0; i < FANOUT; i++) {
+    if (left_runs[i]->GetNumTuples() > 0 && right_runs[i]->GetNumTuples() > 0) {
+      partitions_.push_back({std::move(left_runs[i]), std::move(right_runs[i]), depth});
+    }
+  }
+}
+
+void HashJoinExecutor::Build(const std::function<bool(Tuple *)> &next, bool build_left) {
+  build_left_ = build_left;
+  hash_table_.clear();
+  Tuple tuple;
+  while (next(&tuple)) {
+    hash_table_[MakeKey(tuple, build_left)].push_back(tuple);
+  }
+}
+
+bool HashJoinExecutor::NextPartition() {
+  while (!partitions_.empty()) {
+    Partition partition = std::move(partitions_.back());
+    partitions_.pop_back();
+    const bool build_left = partition.left_->GetSize() <= partition.right_->GetSize();
+    TmpTupleRun *build = build_left ? partition.left_.get() : partition.right_.get();
+    TmpTupleRun *probe = build_left ? partition.right_.get() : partition.left_.get();
+    if (build->GetSize() > plan_->GetMemoryBudget() && partition.depth_ < MAX_DEPTH) {
+      auto left_reader = partition.left_->Read();
+      auto right_reader = partition.right_->Read();
+      SplitAndQueue([&](Tuple *tuple) { return left_reader.Next(tuple); },
+                    [&](Tuple *tuple) { return right_reader.Next(tuple); }, partition.depth_ + 1);
+      continue;
+    }
+    auto build_reader = build->Read();
+    Build([&](Tuple *tuple) { return build_reader.Next(tuple); }, build_left);
+    probe_reader_.emplace(probe->Read());
+    partition_ = std::move(partition);
+    num_partitions_joined_++;
+    return true;
+  }
+  return false;
+}
+
+bool HashJoinExecutor::NextProbeBatch() {
+  const Schema *schema = build_left_ ? plan_->GetRightPlan()->OutputSchema() : plan_->GetLeftPlan()->OutputSchema();
+  const auto &key_exprs = build_left_ ? plan_->GetRightKeys() : plan_->GetLeftKeys();
+  probe_pos_ = 0;
+  probe_batch_.Reset(schema);
+  if (probe_index_ < probe_tuples_.size()) {
+    while (!probe_batch_.IsFull() && probe_index_ < probe_tuples_.size()) {
+      probe_batch_.AppendTuple(probe_tuples_[probe_index_++], RID());
+    }
+  } else if (probe_child_ != nullptr && probe_child_->NextBatch(&probe_batch_)) {
+    // the batch came from the rest of the child
+  } else {
+    probe_child_ = nullptr;
+    probe_batch_.Reset(schema);
+    Tuple tuple;
+    while (!probe_batch_.IsFull() && probe_reader_.has_value() && probe_reader_->Next(&tuple)) {
+      probe_batch_.AppendTuple(tuple, RID());
+    }
+  }
+  if (probe_batch_.GetNumSelected() == 0) {
+    return false;
+  }
+  probe_keys_.resize(key_exprs.size());
+  for (size_t i = 0; i < key_exprs.size(); i++) {
+    key_exprs[i]->EvaluateBatch(probe_batch_, &probe_keys_[i]);
+  }
+  return true;
+}
+
+}  // namespace bustub
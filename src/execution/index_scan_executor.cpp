@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
+#include "execution/expressions/compiled_predicate.h"
 #include <set>
 using std::set;
 using std::vector;
@@ -24,6 +25,8 @@ void IndexScanExecutor::Init() {
   table_info_ = exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_);
 
   const AbstractExpression *predicate = plan_->GetPredicate();
+  auto compiled_predicate =
+      predicate == nullptr ? nullptr : CompiledPredicate::Compile(predicate, &table_info_->schema_);
   set<uint32_t> columns_idx;
   for (auto &key_index : index_info_->index_->GetKeyAttrs()) {
     columns_idx.insert(key_index);
@@ -56,7 +59,12 @@ void IndexScanExecutor::Init() {
   auto iterator = index->GetBeginIterator();
   while (iterator != end) {
     auto tmp_tuple = make_tuple(extract_values((*iterator).first, index_info_->key_schema_));
-    if (predicate == nullptr || predicate->Evaluate(&tmp_tuple, &table_info_->schema_).GetAs<bool>()) {
+    const bool matches =
+        compiled_predicate != nullptr
+            ? compiled_predicate->Evaluate(&tmp_tuple)
+            : predicate == nullptr ||
+                  AbstractExpression::IsTrue(predicate->Evaluate(&tmp_tuple, &table_info_->schema_));
+    if (matches) {
       rids_.emplace_back((*iterator).second);
     }
     ++iterator;
@@ -75,7 +83,7 @@ bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
     return Tuple(values, out_schema);
   };
   auto fetch_tuple = [this](Tuple *tuple, const RID &rid) -> bool {
-    return table_info_->table_->GetTuple(rid, tuple, exec_ctx_->GetTransaction());
+    return table_info_->table_->GetTuple(rid, tuple, exec_ctx_->GetTransaction(), AccessType::Lookup);
   };
   if (iterator_ != rids_.end() && fetch_tuple(tuple, *iterator_)) {
     *rid = (*iterator_);
@@ -53,4 +53,30 @@ bool LimitExecutor::Next(Tuple *tuple, RID *rid) {
   return fetch_tuple();
 }
 
+bool LimitExecutor::NextBatch(VectorBatch *batch) {
+  batch->Reset(plan_->OutputSchema());
+  while (offset_ < plan_->GetOffset() + plan_->GetLimit()) {
+    if (!child_executor_->NextBatch(&child_batch_)) {
+      return false;
+    }
+    auto *selection = child_batch_.MutableSelection();
+    // remove the tuples before offset, then those past the limit
+    size_t begin = 0;
+    for (; begin < selection->size() && offset_ < plan_->GetOffset(); begin++) {
+      offset_++;
+    }
+    size_t end = begin;
+    for (; end < selection->size() && offset_ < plan_->GetOffset() + plan_->GetLimit(); end++) {
+      offset_++;
+    }
+    selection->erase(selection->begin() + end, selection->end());
+    selection->erase(selection->begin(), selection->begin() + begin);
+    if (!selection->empty()) {
+      batch->Project(child_batch_);
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace bustub
@@ -102,14 +102,14 @@ bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
   if (!Next(right_tuple, right_rid)) {
     return false;
   }
-  while (predicate_ != nullptr &&
-         !predicate_->EvaluateJoin(&left_tuple_, left_schema, &right_tuple, right_schema).GetAs<bool>()) {
+  while (predicate_ != nullptr && !AbstractExpression::IsTrue(predicate_->EvaluateJoin(&left_tuple_, left_schema,
+                                                                                       &right_tuple, right_schema))) {
     if (!Next(right_tuple, right_rid)) {
       return false;
     }
   }
   // fetch right tuple by rid
-  assert(right_table_info_->table_->GetTuple(right_rid, &right_tuple, exec_ctx_->GetTransaction()));
+  assert(right_table_info_->table_->GetTuple(right_rid, &right_tuple, exec_ctx_->GetTransaction(), AccessType::Lookup));
   *tuple = GenerateJoinTuple(left_tuple_, right_tuple, left_schema, right_schema);
   return true;
 }
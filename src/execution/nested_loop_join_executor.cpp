@@ -12,6 +12,8 @@
 
 #include "execution/executors/nested_loop_join_executor.h"
 
+#include "common/exception.h"
+
 namespace bustub {
 
 NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecutorContext *exec_ctx, const NestedLoopJoinPlanNode *plan,
@@ -21,56 +23,164 @@ NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecutorContext *exec_ctx, const
       plan_(plan),
       left_executor_(std::move(left_executor)),
       right_executor_(std::move(right_executor)),
-      predicate_(plan_->Predicate()) {}
+      predicate_(plan_->Predicate()),
+      compiled_predicate_(predicate_ == nullptr
+                              ? nullptr
+                              : CompiledPredicate::Compile(predicate_, plan_->GetLeftPlan()->OutputSchema(),
+                                                           plan_->GetRightPlan()->OutputSchema())) {}
+
+NestedLoopJoinExecutor::~NestedLoopJoinExecutor() {
+  block_.clear();
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  for (auto *page : block_pages_) {
+    const page_id_t page_id = page->GetPageId();
+    bpm->UnpinPage(page_id, false);
+    bpm->DeletePage(page_id);
+  }
+}
 
 void NestedLoopJoinExecutor::Init() {
   left_executor_->Init();
   right_executor_->Init();
+  num_inner_scans_ = 1;
+  if (plan_->GetBlockPages() > 0) {
+    auto *bpm = exec_ctx_->GetBufferPoolManager();
+    while (block_pages_.size() < plan_->GetBlockPages()) {
+      page_id_t page_id;
+      auto *page = reinterpret_cast<TmpTuplePage *>(bpm->NewPage(&page_id));
+      if (page == nullptr) {
+        // make do with the frames there are
+        break;
+      }
+      block_pages_.push_back(page);
+    }
+    if (block_pages_.empty()) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "No frame left to buffer outer tuples in.");
+    }
+    has_next_outer_ = false;
+    FillBlock();
+    block_index_ = block_.size();
+    return;
+  }
   if (!left_executor_->Next(&left_tuple_, &left_rid_)) {
     throw std::logic_error("left executor is empty!");
   }
 }
 
 bool NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) {
-  auto GenerateJoinTuple = [this](const Tuple &left_tup, const Tuple &right_tup, const Schema *left_schema,
-                                  const Schema *right_schema) -> Tuple {
-    const Schema *join_schema = plan_->OutputSchema();
-    uint32_t col_count = join_schema->GetColumnCount();
-    std::vector<Value> values;
-    values.reserve(col_count);
-    for (auto &column : join_schema->GetColumns()) {
-      values.emplace_back(column.GetExpr()->EvaluateJoin(&left_tup, left_schema, &right_tup, right_schema));
-    }
-    return Tuple(values, join_schema);
-  };
+  if (plan_->GetBlockPages() > 0) {
+    return NextInBlock(tuple);
+  }
   auto Next = [this](Tuple &inner_tuple, RID &inner_rid) -> bool {
     if (!right_executor_->Next(&inner_tuple, &inner_rid)) {
       if (!left_executor_->Next(&left_tuple_, &left_rid_)) {
         return false;
       }
       right_executor_->Init();
+      num_inner_scans_++;
       if (!right_executor_->Next(&inner_tuple, &inner_rid)) {
         return false;
       }
     }
     return true;
   };
-  auto outer_schema = plan_->GetLeftPlan()->OutputSchema();
-  auto inner_schema = plan_->GetRightPlan()->OutputSchema();
   Tuple inner_tuple;
   RID inner_rid;
   if (!Next(inner_tuple, inner_rid)) {
     return false;
   }
-  while (predicate_ != nullptr &&
-         !predicate_->EvaluateJoin(&left_tuple_, outer_schema, &inner_tuple, inner_schema).GetAs<bool>()) {
+  while (!Matches(left_tuple_, inner_tuple)) {
     if (!Next(inner_tuple, inner_rid)) {
       // no more available tuple
       return false;
     }
   }
-  *tuple = GenerateJoinTuple(left_tuple_, inner_tuple, outer_schema, inner_schema);
+  *tuple = MakeOutputTuple(left_tuple_, inner_tuple);
   return true;
 }
 
+bool NestedLoopJoinExecutor::Matches(const Tuple &left_tuple, const Tuple &right_tuple) const {
+  if (compiled_predicate_ != nullptr) {
+    return compiled_predicate_->EvaluateJoin(&left_tuple, &right_tuple);
+  }
+  return predicate_ == nullptr ||
+         AbstractExpression::IsTrue(predicate_->EvaluateJoin(&left_tuple, plan_->GetLeftPlan()->OutputSchema(),
+                                                             &right_tuple, plan_->GetRightPlan()->OutputSchema()));
+}
+
+bool NestedLoopJoinExecutor::NextInBlock(Tuple *tuple) {
+  RID inner_rid;
+  while (!block_.empty()) {
+    // compare the current inner tuple with the rest of the block
+    while (block_index_ < block_.size()) {
+      const Tuple &outer_tuple = block_[block_index_++];
+      if (Matches(outer_tuple, inner_tuple_)) {
+        *tuple = MakeOutputTuple(outer_tuple, inner_tuple_);
+        return true;
+      }
+    }
+    if (right_executor_->Next(&inner_tuple_, &inner_rid)) {
+      block_index_ = 0;
+      continue;
+    }
+    // the inner side is done with this block
+    if (!FillBlock()) {
+      return false;
+    }
+    right_executor_->Init();
+    num_inner_scans_++;
+    block_index_ = block_.size();
+  }
+  return false;
+}
+
+bool NestedLoopJoinExecutor::FillBlock() {
+  block_.clear();
+  size_t page_index = 0;
+  block_pages_[0]->Init(block_pages_[0]->GetPageId(), PAGE_SIZE);
+  TmpTuple out(INVALID_PAGE_ID, 0);
+  RID rid;
+  bool oversized = false;
+  while (has_next_outer_ || left_executor_->Next(&next_outer_, &rid)) {
+    has_next_outer_ = true;
+    if (!block_pages_[page_index]->Insert(next_outer_, &out)) {
+      if (block_pages_[page_index]->GetFreeSpacePointer() == PAGE_SIZE) {
+        // The tuple does not even fit on an empty page. Once the tuples before it are joined, it makes up a block of
+        // its own, which is held in memory and joined tuple at a time.
+        oversized = page_index == 0;
+        has_next_outer_ = !oversized;
+        break;
+      }
+      if (++page_index == block_pages_.size()) {
+        // keep the tuple for the next block
+        break;
+      }
+      block_pages_[page_index]->Init(block_pages_[page_index]->GetPageId(), PAGE_SIZE);
+      continue;
+    }
+    has_next_outer_ = false;
+  }
+  for (size_t i = 0; i < block_pages_.size() && i <= page_index; i++) {
+    for (uint32_t offset = block_pages_[i]->GetFreeSpacePointer(); offset < PAGE_SIZE;) {
+      block_.emplace_back();
+      offset = block_pages_[i]->GetTupleView(offset, &block_.back());
+    }
+  }
+  if (oversized) {
+    block_.push_back(next_outer_);
+  }
+  return !block_.empty();
+}
+
+Tuple NestedLoopJoinExecutor::MakeOutputTuple(const Tuple &left_tuple, const Tuple &right_tuple) {
+  const Schema *join_schema = plan_->OutputSchema();
+  std::vector<Value> values;
+  values.reserve(join_schema->GetColumnCount());
+  for (auto &column : join_schema->GetColumns()) {
+    values.emplace_back(column.GetExpr()->EvaluateJoin(&left_tuple, plan_->GetLeftPlan()->OutputSchema(),
+                                                       &right_tuple, plan_->GetRightPlan()->OutputSchema()));
+  }
+  return Tuple(values, join_schema);
+}
+
 }  // namespace bustub
@@ -1,66 +1,156 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// seq_scan_executor.cpp
-//
-// Identification: src/execution/seq_scan_executor.cpp
-//
-// Copyright (c) 2015-19, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-#include "execution/executors/seq_scan_executor.h"
-
-namespace bustub {
-
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx),
-      plan_(plan),
-      table_info_(exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())),
-      iterator_(table_info_->table_->Begin(exec_ctx_->GetTransaction())) {}
-
-void SeqScanExecutor::Init() { iterator_ = table_info_->table_->Begin(exec_ctx_->GetTransaction()); }
-
-bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
-  auto make_tuple = [](const Tuple *tuple, const Schema *out_schema, const Schema &tuple_schema) -> Tuple {
-    std::vector<Value> values;
-    for (auto &column : out_schema->GetColumns()) {
-      values.emplace_back(column.GetExpr()->Evaluate(tuple, &tuple_schema));
-    }
-    return Tuple(values, out_schema);
-  };
-  auto txn = exec_ctx_->GetTransaction();
-  auto lock_manager = exec_ctx_->GetLockManager();
-  auto IsoLevel = txn->GetIsolationLevel();
-  while (iterator_ != table_info_->table_->End()) {
-    if (plan_->GetPredicate() == nullptr ||
-        plan_->GetPredicate()->Evaluate(&*iterator_, &table_info_->schema_).GetAs<bool>()) {
-      *rid = iterator_->GetRid();
-      *tuple = *iterator_;
-      if (!txn->IsExclusiveLocked(*rid) && !txn->IsSharedLocked(*rid)) {
-        if (IsoLevel != IsolationLevel::READ_UNCOMMITTED) {
-          lock_manager->LockShared(txn, *rid);
-          if (!table_info_->table_->GetTuple(*rid, tuple, txn)) {
-            // tuple might be removed
-            iterator_++;
-            if (IsoLevel == IsolationLevel::READ_COMMITTED) {
-              lock_manager->Unlock(txn, *rid);
-            }
-            // unable to unlock repeatable_read
-            continue;
-          }
-        }
-        if (IsoLevel == IsolationLevel::READ_COMMITTED) {
-          lock_manager->Unlock(txn, *rid);
-        }
-      }
-      iterator_++;
-      *tuple = make_tuple(tuple, plan_->OutputSchema(), table_info_->schema_);
-      return true;
-    }
-    iterator_++;
-  }
-  return false;
-}
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// seq_scan_executor.cpp
+//
+// Identification: src/execution/seq_scan_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/executors/seq_scan_executor.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())),
+      iterator_(table_info_->table_->Begin(exec_ctx_->GetTransaction())),
+      compiled_predicate_(plan_->GetPredicate() == nullptr
+                              ? nullptr
+                              : CompiledPredicate::Compile(plan_->GetPredicate(), &table_info_->schema_)) {}
+
+void SeqScanExecutor::Init() {
+  // read-ahead must not crowd out the pages of the rest of the system, so it only ever takes a small share of the pool
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  const size_t depth = std::min(static_cast<size_t>(SEQ_SCAN_PREFETCH_DEPTH), bpm->GetPoolSize() / 8);
+  if (prefetcher_ == nullptr && depth > 0) {
+    prefetcher_ = std::make_unique<PagePrefetcher>(
+        bpm, depth, [](Page *page) { return static_cast<TablePage *>(page)->GetNextPageId(); });
+  }
+  iterator_ = table_info_->table_->Begin(exec_ctx_->GetTransaction());
+  current_page_id_ = INVALID_PAGE_ID;
+  ReportPage();
+}
+
+void SeqScanExecutor::AdvanceIterator() {
+  ++iterator_;
+  ReportPage();
+}
+
+void SeqScanExecutor::ReportPage() {
+  if (prefetcher_ == nullptr || iterator_ == table_info_->table_->End()) {
+    return;
+  }
+  page_id_t page_id = iterator_->GetRid().GetPageId();
+  if (page_id != current_page_id_) {
+    current_page_id_ = page_id;
+    prefetcher_->Advance(page_id);
+  }
+}
+
+bool SeqScanExecutor::MatchesPredicate(const Tuple &tuple) const {
+  if (compiled_predicate_ != nullptr) {
+    return compiled_predicate_->Evaluate(&tuple);
+  }
+  return plan_->GetPredicate() == nullptr ||
+         AbstractExpression::IsTrue(plan_->GetPredicate()->Evaluate(&tuple, &table_info_->schema_));
+}
+
+bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
+  auto make_tuple = [](const Tuple *tuple, const Schema *out_schema, const Schema &tuple_schema) -> Tuple {
+    std::vector<Value> values;
+    for (auto &column : out_schema->GetColumns()) {
+      values.emplace_back(column.GetExpr()->Evaluate(tuple, &tuple_schema));
+    }
+    return Tuple(values, out_schema);
+  };
+  auto txn = exec_ctx_->GetTransaction();
+  auto lock_manager = exec_ctx_->GetLockManager();
+  auto IsoLevel = txn->GetIsolationLevel();
+  while (iterator_ != table_info_->table_->End()) {
+    if (MatchesPredicate(*iterator_)) {
+      *rid = iterator_->GetRid();
+      *tuple = *iterator_;
+      if (!txn->IsExclusiveLocked(*rid) && !txn->IsSharedLocked(*rid)) {
+        if (IsoLevel != IsolationLevel::READ_UNCOMMITTED) {
+          lock_manager->LockShared(txn, *rid);
+          if (!table_info_->table_->GetTuple(*rid, tuple, txn, AccessType::Scan)) {
+            // tuple might be removed
+            AdvanceIterator();
+            if (IsoLevel == IsolationLevel::READ_COMMITTED) {
+              lock_manager->Unlock(txn, *rid);
+            }
+            // unable to unlock repeatable_read
+            continue;
+          }
+        }
+        if (IsoLevel == IsolationLevel::READ_COMMITTED) {
+          lock_manager->Unlock(txn, *rid);
+        }
+      }
+      AdvanceIterator();
+      *tuple = make_tuple(tuple, plan_->OutputSchema(), table_info_->schema_);
+      return true;
+    }
+    AdvanceIterator();
+  }
+  return false;
+}
+
+bool SeqScanExecutor::NextBatch(VectorBatch *batch) {
+  batch->Reset(plan_->OutputSchema());
+  while (iterator_ != table_info_->table_->End()) {
+    scan_batch_.Reset(&table_info_->schema_);
+    while (!scan_batch_.IsFull() && iterator_ != table_info_->table_->End()) {
+      // a compiled predicate filters the tuples before their columns are copied out
+      if (compiled_predicate_ == nullptr || compiled_predicate_->Evaluate(&*iterator_)) {
+        scan_batch_.AppendTuple(*iterator_, iterator_->GetRid());
+      }
+      AdvanceIterator();
+    }
+    if (plan_->GetPredicate() != nullptr && compiled_predicate_ == nullptr) {
+      plan_->GetPredicate()->SelectBatch(&scan_batch_);
+    }
+    LockSelected();
+    if (scan_batch_.GetNumSelected() > 0) {
+      batch->Project(scan_batch_);
+      return true;
+    }
+  }
+  return false;
+}
+
+void SeqScanExecutor::LockSelected() {
+  auto txn = exec_ctx_->GetTransaction();
+  auto lock_manager = exec_ctx_->GetLockManager();
+  auto IsoLevel = txn->GetIsolationLevel();
+  auto *selection = scan_batch_.MutableSelection();
+  size_t count = 0;
+  Tuple tuple;
+  for (uint32_t row : *selection) {
+    const RID &rid = scan_batch_.GetRid(row);
+    if (!txn->IsExclusiveLocked(rid) && !txn->IsSharedLocked(rid)) {
+      if (IsoLevel != IsolationLevel::READ_UNCOMMITTED) {
+        lock_manager->LockShared(txn, rid);
+        const bool found = table_info_->table_->GetTuple(rid, &tuple, txn, AccessType::Scan);
+        if (IsoLevel == IsolationLevel::READ_COMMITTED) {
+          lock_manager->Unlock(txn, rid);
+        }
+        if (!found) {
+          // tuple might be removed
+          continue;
+        }
+        scan_batch_.SetRow(row, tuple);
+      }
+    }
+    (*selection)[count++] = row;
+  }
+  selection->resize(count);
+}
+
+}  // namespace bustub
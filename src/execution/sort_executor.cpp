@@ -0,0 +1,226 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.cpp
+//
+// Identification: src/execution/sort_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/sort_executor.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
+                           std::unique_ptr<AbstractExecutor> &&child_executor, std::optional<size_t> top_n)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)), top_n_(top_n) {}
+
+void SortExecutor::Init() {
+  child_executor_->Init();
+  entries_.clear();
+  entry_index_ = 0;
+  runs_.clear();
+  readers_.clear();
+  merge_heap_.clear();
+  num_runs_ = 0;
+  num_produced_ = 0;
+  if (top_n_.has_value()) {
+    if (SortTopN()) {
+      return;
+    }
+    // the top_n tuples do not fit into the budget: the heap holds every candidate read so far, sort those and the
+    // rest of the child like a full sort, Next stops after top_n tuples
+    SpillRun();
+  }
+
+  // run generation: sort as many tuples as fit into the budget at a time
+  size_t size = 0;
+  Tuple tuple;
+  RID rid;
+  while (child_executor_->Next(&tuple, &rid)) {
+    size += EntrySize(tuple);
+    entries_.emplace_back(MakeEntry(std::move(tuple)));
+    if (size > plan_->GetMemoryBudget()) {
+      SpillRun();
+      size = 0;
+    }
+  }
+  if (runs_.empty()) {
+    std::sort(entries_.begin(), entries_.end(),
+              [this](const SortEntry &a, const SortEntry &b) { return Less(a.keys_, b.keys_); });
+    return;
+  }
+  if (!entries_.empty()) {
+    SpillRun();
+  }
+
+  // merge passes, until the remaining runs can be merged with a page of each in memory
+  const size_t fan_in = std::max<size_t>(plan_->GetMemoryBudget() / PAGE_SIZE, 2);
+  while (runs_.size() > fan_in) {
+    std::vector<std::unique_ptr<TmpTupleRun>> merged;
+    for (size_t first = 0; first < runs_.size(); first += fan_in) {
+      const size_t last = std::min(first + fan_in, runs_.size());
+      if (last - first == 1) {
+        merged.emplace_back(std::move(runs_[first]));
+        continue;
+      }
+      StartMerge(first, last);
+      auto run = std::make_unique<TmpTupleRun>(exec_ctx_->GetBufferPoolManager());
+      SortEntry entry;
+      while (NextMerged(&entry)) {
+        run->Append(entry.tuple_);
+      }
+      merged.emplace_back(std::move(run));
+      // the merged runs are not needed anymore, free their pages
+      readers_.clear();
+      for (size_t i = first; i < last; i++) {
+        runs_[i].reset();
+      }
+    }
+    runs_ = std::move(merged);
+  }
+  StartMerge(0, runs_.size());
+}
+
+bool SortExecutor::Next(Tuple *tuple, RID *rid) {
+  if (top_n_.has_value() && num_produced_ == *top_n_) {
+    return false;
+  }
+  const SortEntry *entry;
+  SortEntry merged;
+  if (readers_.empty()) {
+    if (entry_index_ >= entries_.size()) {
+      return false;
+    }
+    entry = &entries_[entry_index_++];
+  } else {
+    if (!NextMerged(&merged)) {
+      return false;
+    }
+    entry = &merged;
+  }
+  std::vector<Value> values;
+  values.reserve(plan_->OutputSchema()->GetColumnCount());
+  for (const auto &column : plan_->OutputSchema()->GetColumns()) {
+    values.emplace_back(column.GetExpr()->Evaluate(&entry->tuple_, child_executor_->GetOutputSchema()));
+  }
+  *tuple = Tuple(values, plan_->OutputSchema());
+  num_produced_++;
+  return true;
+}
+
+size_t SortExecutor::EntrySize(const Tuple &tuple) const {
+  return tuple.GetLength() + sizeof(SortEntry) + plan_->GetOrderBys().size() * sizeof(Value);
+}
+
+SortExecutor::SortEntry SortExecutor::MakeEntry(Tuple &&tuple) const {
+  SortEntry entry;
+  entry.keys_.reserve(plan_->GetOrderBys().size());
+  for (const auto &[type, expr] : plan_->GetOrderBys()) {
+    entry.keys_.emplace_back(expr->Evaluate(&tuple, child_executor_->GetOutputSchema()));
+  }
+  entry.tuple_ = std::move(tuple);
+  return entry;
+}
+
+bool SortExecutor::Less(const std::vector<Value> &a, const std::vector<Value> &b) const {
+  const auto &order_bys = plan_->GetOrderBys();
+  for (size_t i = 0; i < order_bys.size(); i++) {
+    bool less;
+    if (a[i].IsNull() || b[i].IsNull()) {
+      if (a[i].IsNull() == b[i].IsNull()) {
+        continue;
+      }
+      // NULL is smaller than every value
+      less = a[i].IsNull();
+    } else if (a[i].CompareEquals(b[i]) == CmpBool::CmpTrue) {
+      continue;
+    } else {
+      less = a[i].CompareLessThan(b[i]) == CmpBool::CmpTrue;
+    }
+    return order_bys[i].first == OrderByType::Asc ? less : !less;
+  }
+  return false;
+}
+
+bool SortExecutor::SortTopN() {
+  // a max-heap of the top_n smallest entries read so far
+  auto less = [this](const SortEntry &a, const SortEntry &b) { return Less(a.keys_, b.keys_); };
+  size_t size = 0;
+  Tuple tuple;
+  RID rid;
+  while (child_executor_->Next(&tuple, &rid)) {
+    SortEntry entry = MakeEntry(std::move(tuple));
+    if (entries_.size() == *top_n_) {
+      if (entries_.empty() || !Less(entry.keys_, entries_.front().keys_)) {
+        continue;
+      }
+      std::pop_heap(entries_.begin(), entries_.end(), less);
+      size -= EntrySize(entries_.back().tuple_);
+      entries_.pop_back();
+    }
+    size += EntrySize(entry.tuple_);
+    entries_.emplace_back(std::move(entry));
+    std::push_heap(entries_.begin(), entries_.end(), less);
+    if (size > plan_->GetMemoryBudget()) {
+      return false;
+    }
+  }
+  std::sort_heap(entries_.begin(), entries_.end(), less);
+  return true;
+}
+
+void SortExecutor::SpillRun() {
+  std::sort(entries_.begin(), entries_.end(),
+            [this](const SortEntry &a, const SortEntry &b) { return Less(a.keys_, b.keys_); });
+  auto run = std::make_unique<TmpTupleRun>(exec_ctx_->GetBufferPoolManager());
+  for (const auto &entry : entries_) {
+    run->Append(entry.tuple_);
+  }
+  runs_.emplace_back(std::move(run));
+  entries_.clear();
+  num_runs_++;
+}
+
+void SortExecutor::StartMerge(size_t first, size_t last) {
+  readers_.clear();
+  merge_heap_.clear();
+  Tuple tuple;
+  for (size_t i = first; i < last; i++) {
+    readers_.emplace_back(runs_[i]->Read());
+    if (readers_.back().Next(&tuple)) {
+      merge_heap_.push_back({MakeEntry(std::move(tuple)), i - first});
+    }
+  }
+  std::make_heap(merge_heap_.begin(), merge_heap_.end(),
+                 [this](const MergeEntry &a, const MergeEntry &b) { return Less(b.entry_.keys_, a.entry_.keys_); });
+}
+
+bool SortExecutor::NextMerged(SortEntry *entry) {
+  // a min-heap on the next entry of every run
+  auto greater = [this](const MergeEntry &a, const MergeEntry &b) { return Less(b.entry_.keys_, a.entry_.keys_); };
+  if (merge_heap_.empty()) {
+    return false;
+  }
+  std::pop_heap(merge_heap_.begin(), merge_heap_.end(), greater);
+  MergeEntry &next = merge_heap_.back();
+  *entry = std::move(next.entry_);
+  Tuple tuple;
+  if (readers_[next.run_].Next(&tuple)) {
+    next.entry_ = MakeEntry(std::move(tuple));
+    std::push_heap(merge_heap_.begin(), merge_heap_.end(), greater);
+  } else {
+    merge_heap_.pop_back();
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// vector_batch.cpp
+//
+// Identification: src/execution/vector_batch.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/vector_batch.h"
+
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+
+namespace bustub {
+
+void VectorBatch::Reset(const Schema *schema) {
+  schema_ = schema;
+  num_rows_ = 0;
+  const uint32_t column_count = schema == nullptr ? 0 : schema->GetColumnCount();
+  columns_.resize(column_count);
+  for (auto &column : columns_) {
+    column.clear();
+    column.reserve(VECTOR_BATCH_SIZE);
+  }
+  rids_.clear();
+  rids_.reserve(VECTOR_BATCH_SIZE);
+  selection_.clear();
+  selection_.reserve(VECTOR_BATCH_SIZE);
+}
+
+void VectorBatch::AppendTuple(const Tuple &tuple, const RID &rid) {
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].emplace_back(tuple.GetValue(schema_, i));
+  }
+  rids_.push_back(rid);
+  selection_.push_back(num_rows_++);
+}
+
+void VectorBatch::AppendRow(const std::vector<Value> &values, const RID &rid) {
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(values[i]);
+  }
+  rids_.push_back(rid);
+  selection_.push_back(num_rows_++);
+}
+
+void VectorBatch::SetRow(uint32_t row, const Tuple &tuple) {
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i][row] = tuple.GetValue(schema_, i);
+  }
+}
+
+void VectorBatch::Project(const VectorBatch &input) {
+  num_rows_ = input.num_rows_;
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    schema_->GetColumn(i).GetExpr()->EvaluateBatch(input, &columns_[i]);
+  }
+  rids_ = input.rids_;
+  selection_ = input.selection_;
+}
+
+Tuple VectorBatch::MakeTuple(uint32_t row) const {
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    values.push_back(column[row]);
+  }
+  return Tuple(values, schema_);
+}
+
+}  // namespace bustub
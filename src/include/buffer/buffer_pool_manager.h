@@ -6,43 +6,69 @@
 //
 // Identification: src/include/buffer/buffer_pool_manager.h
 //
-// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <chrono>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
-#include "recovery/log_manager.h"
-#include "storage/disk/disk_manager.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/metrics.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
 /**
- * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ * Statistics of a buffer pool, see BufferPoolManager::GetStats.
+ */
+struct BufferPoolStats {
+  /** Fetches of pages that were in the pool already. */
+  uint64_t hits_{0};
+  /** Fetches of pages that were not in the pool. */
+  uint64_t misses_{0};
+  /** Frames taken away from a page by the replacer. */
+  uint64_t evictions_{0};
+  /** Evicted pages that were dirty and had to be written back on the way, by the thread that needed the frame. */
+  uint64_t dirty_write_backs_{0};
+  /** Dirty pages written back by the page cleaner, see BufferPoolManager::StartPageCleaner. */
+  uint64_t cleaner_write_backs_{0};
+  /** FetchPage and NewPage calls that returned nullptr because every frame was pinned. */
+  uint64_t pin_failures_{0};
+  /** Time spent waiting for the buffer pool latch, an uncontended acquisition counts as 0ns. */
+  HistogramSnapshot latch_wait_;
+
+  /** @return hits / (hits + misses), 0 if nothing was fetched */
+  double HitRatio() const {
+    return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+
+  /** Adds the statistics of other to these, e.g. to combine the instances of a parallel buffer pool. */
+  BufferPoolStats &operator+=(const BufferPoolStats &other);
+
+  /** @return the counters and the latch wait histogram on one line */
+  std::string ToString() const;
+};
+
+/**
+ * BufferPoolManager reads disk pages to and from its internal buffer pool. It is the interface that the rest of the
+ * system works with, implemented by a single BufferPoolManagerInstance or by a ParallelBufferPoolManager of several.
  */
 class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
 
-  /**
-   * Creates a new BufferPoolManager.
-   * @param pool_size the size of the buffer pool
-   * @param disk_manager the disk manager
-   * @param log_manager the log manager (for testing only: nullptr = disable logging)
-   */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
-
+  BufferPoolManager() = default;
   /**
    * Destroys an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager() = default;
 
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
@@ -52,6 +78,24 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetch the requested page, telling the replacement policy how the page is accessed.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed, e.g. AccessType::Scan for sequential scans
+   * @return the requested page
+   */
+  Page *FetchPage(page_id_t page_id, AccessType access_type) { return FetchPageWithHintImpl(page_id, access_type); }
+
+  /**
+   * Starts reading the requested page into the buffer pool without waiting for the read, e.g. to read ahead of a scan.
+   * The frame stays pinned by the read until it completes, and whoever fetches the page meanwhile waits for it. The
+   * completion of the read marks the page READY and unpins it, or gives the frame up if the read failed.
+   * @param page_id id of page to be read
+   * @return false if every frame is pinned, true otherwise
+   * @throws Exception if the dirty page that had to make room could not be written back
+   */
+  bool PrefetchPage(page_id_t page_id) { return PrefetchPageImpl(page_id); }
+
   /** Grading function. Do not modify! */
   bool UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -91,11 +135,38 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Collects the dirty page table for a checkpoint: every page that may hold changes which are not on disk yet,
+   * with the LSN from which on its changes may be missing on disk (its recLSN).
+   * @return the page id and recLSN of every such page
+   */
+  virtual std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable() = 0;
+
   /** @return pointer to all the pages in the buffer pool */
-  Page *GetPages() { return pages_; }
+  virtual Page *GetPages() = 0;
 
   /** @return size of the buffer pool */
-  size_t GetPoolSize() { return pool_size_; }
+  virtual size_t GetPoolSize() = 0;
+
+  /**
+   * Starts writing back dirty unpinned pages in the background, before they are evicted.
+   * @param clean_ratio the share of the unpinned frames the cleaner keeps clean, between 0 and 1
+   * @param batch_size the maximum number of pages written back per batch
+   * @param interval how long the cleaner sleeps between checks when it is not woken up by a dirty eviction
+   */
+  virtual void StartPageCleaner(double clean_ratio, size_t batch_size = 32,
+                                std::chrono::milliseconds interval = std::chrono::milliseconds(10)) = 0;
+
+  /**
+   * Stops the background cleaner, if it is running.
+   */
+  virtual void StopPageCleaner() = 0;
+
+  /** @return the statistics of this buffer pool since construction or the last ResetStats */
+  virtual BufferPoolStats GetStats() = 0;
+
+  /** Drops the statistics collected so far. */
+  virtual void ResetStats() = 0;
 
  protected:
   /**
@@ -116,7 +187,22 @@ class BufferPoolManager {
    * @param page_id id of page to be fetched
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  virtual Page *FetchPageImpl(page_id_t page_id) = 0;
+
+  /**
+   * Fetch the requested page from the buffer pool, telling the replacement policy how the page is accessed.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
+   * @return the requested page
+   */
+  virtual Page *FetchPageWithHintImpl(page_id_t page_id, AccessType access_type) = 0;
+
+  /**
+   * Start reading the requested page into the buffer pool, see PrefetchPage.
+   * @param page_id id of page to be read
+   * @return false if every frame is pinned, true otherwise
+   */
+  virtual bool PrefetchPageImpl(page_id_t page_id) = 0;
 
   /**
    * Unpin the target page from the buffer pool.
@@ -124,49 +210,33 @@ class BufferPoolManager {
    * @param is_dirty true if the page should be marked as dirty, false otherwise
    * @return false if the page pin count is <= 0 before this call, true otherwise
    */
-  bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPageImpl(page_id_t page_id, bool is_dirty) = 0;
 
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
-  bool FlushPageImpl(page_id_t page_id);
+  virtual bool FlushPageImpl(page_id_t page_id) = 0;
 
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  virtual Page *NewPageImpl(page_id_t *page_id) = 0;
 
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  bool DeletePageImpl(page_id_t page_id);
+  virtual bool DeletePageImpl(page_id_t page_id) = 0;
 
   /**
    * Flushes all the pages in the buffer pool to disk.
    */
-  void FlushAllPagesImpl();
-
-  /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. */
-  Page *pages_;
-  /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  Replacer *replacer_;
-  /** List of free pages. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  virtual void FlushAllPagesImpl() = 0;
 };
+
 }  // namespace bustub
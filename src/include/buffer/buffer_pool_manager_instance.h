@@ -0,0 +1,357 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.h
+//
+// Identification: src/include/buffer/buffer_pool_manager_instance.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <list>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_replacer.h"
+#include "common/metrics.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolManagerInstance reads disk pages to and from its own buffer pool, with a single page table, free list,
+ * replacer and latch. It is a buffer pool on its own, or one instance of a ParallelBufferPoolManager.
+ */
+class BufferPoolManagerInstance : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new BufferPoolManagerInstance.
+   * @param pool_size the size of the buffer pool
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_policy the replacement policy used to pick victims
+   */
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRU);
+
+  /**
+   * Creates a new BufferPoolManagerInstance that is one instance of a ParallelBufferPoolManager.
+   * Page ids allocated by this instance are striped, i.e. page_id % num_instances == instance_index.
+   * @param pool_size the size of this instance
+   * @param num_instances the total number of instances in the parallel buffer pool
+   * @param instance_index the index of this instance in the parallel buffer pool
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param pages frames borrowed from the owner of the whole arena (nullptr = allocate our own)
+   * @param replacer_policy the replacement policy used to pick victims
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr, Page *pages = nullptr,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRU);
+
+  /**
+   * Destroys an existing BufferPoolManagerInstance.
+   */
+  ~BufferPoolManagerInstance() override;
+
+  /**
+   * Collects the dirty page table for a checkpoint: every page that may hold changes which are not on disk yet,
+   * with the LSN from which on its changes may be missing on disk (its recLSN). Pages that are pinned count as
+   * dirty, since whoever pins them may have changed them without unpinning yet.
+   * @return the page id and recLSN of every such page
+   */
+  std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable() override;
+
+  /** @return pointer to all the pages in the buffer pool */
+  Page *GetPages() override { return pages_; }
+
+  /** @return size of the buffer pool */
+  size_t GetPoolSize() override { return pool_size_; }
+
+  /**
+   * Starts a background thread that writes back dirty unpinned pages before they are evicted, so that evictions on
+   * the foreground path rarely have to write. Pages that were unpinned the longest are cleaned first, and every batch
+   * is written in page id order. With logging enabled, pages whose LSN is not persistent yet are left alone.
+   * @param clean_ratio the share of the unpinned frames the cleaner keeps clean, between 0 and 1
+   * @param batch_size the maximum number of pages written back per batch
+   * @param interval how long the cleaner sleeps between checks when it is not woken up by a dirty eviction
+   */
+  void StartPageCleaner(double clean_ratio, size_t batch_size = 32,
+                        std::chrono::milliseconds interval = std::chrono::milliseconds(10)) override;
+
+  /**
+   * Stops the background cleaner, if it is running.
+   */
+  void StopPageCleaner() override;
+
+  /**
+   * The statistics are kept in per-thread shards, so collecting them is cheap enough to leave on. Disk I/O latencies
+   * are kept by the disk manager, see DiskManager::GetStats.
+   * @return the statistics of this buffer pool since construction or the last ResetStats
+   */
+  BufferPoolStats GetStats() override;
+
+  /** Drops the statistics collected so far. */
+  void ResetStats() override;
+
+ protected:
+  /**
+   * Fetch the requested page from the buffer pool.
+   * @param page_id id of page to be fetched
+   * @return the requested page
+   */
+  Page *FetchPageImpl(page_id_t page_id) override;
+
+  /**
+   * Fetch the requested page from the buffer pool, telling the replacement policy how the page is accessed.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
+   * @return the requested page
+   */
+  Page *FetchPageWithHintImpl(page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Start reading the requested page into the buffer pool, see PrefetchPage.
+   * @param page_id id of page to be read
+   * @return false if every frame is pinned, true otherwise
+   */
+  bool PrefetchPageImpl(page_id_t page_id) override;
+
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page in the buffer pool.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  /**
+   * Deletes a page from the buffer pool.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /**
+   * Flushes all the pages in the buffer pool to disk.
+   */
+  void FlushAllPagesImpl() override;
+
+  /**
+   * Allocates a page id owned by this instance.
+   * @return the next striped page id of this instance
+   */
+  page_id_t AllocatePage();
+
+  /**
+   * Shared implementation of FetchPageImpl and FetchPageWithHintImpl.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
+   * @return the requested page
+   */
+  Page *FetchPageInternal(page_id_t page_id, AccessType access_type);
+
+  /**
+   * Acquires latch_, recording how long that took in latch_wait_.
+   * @return the acquired latch
+   */
+  std::unique_lock<std::mutex> LockLatch();
+
+  /**
+   * Write-ahead logging: with logging enabled, waits until the log records of the page are persistent, so that the
+   * page can be written back. Must be called WITHOUT latch_ held.
+   * @param page the page about to be written
+   */
+  void FlushLogFor(Page *page);
+
+  /** Body of the page cleaner thread. */
+  void RunPageCleaner();
+
+  /**
+   * Picks the dirty unpinned frames the cleaner should write back next, pins them and marks them clean. Must be
+   * called with latch_ held.
+   * @return the picked frames, ordered by page id
+   */
+  std::vector<frame_id_t> PickFramesToClean();
+
+  /**
+   * The life cycle of a frame. Disk I/O on a frame happens without holding latch_, so a frame that is in the page
+   * table is not necessarily usable yet.
+   * READY:    the frame holds the contents of its page (or is free).
+   * EVICTING: the frame has been handed to a new page, but the dirty contents of its previous page are still being
+   *           written back.
+   * LOADING:  the contents of the new page are being read in.
+   */
+  enum class FrameState { READY, EVICTING, LOADING };
+
+  /** @return the LSN the next log record will get, INVALID_LSN without a log manager */
+  lsn_t NextLSN() { return log_manager_ != nullptr ? log_manager_->GetNextLSN() : INVALID_LSN; }
+
+  /**
+   * Writes back the page of a READY frame, marking it clean first so that changes made meanwhile dirty it again. If the
+   * write fails, the page is marked dirty again and the exception is passed on. Must be called with latch_ held, which
+   * is dropped during the write.
+   * @param lock the lock on latch_
+   * @param frame_id frame to write back
+   */
+  void WriteBackFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id);
+
+  /**
+   * Pins the frame, taking it out of the replacer if it was unpinned. Must be called with latch_ held.
+   * @param frame_id frame to pin
+   */
+  void PinFrame(frame_id_t frame_id);
+
+  /**
+   * Unpins the frame, handing it to the replacer once nobody pins it anymore, or to the free list if it holds no page.
+   * Must be called with latch_ held.
+   * @param frame_id frame to unpin
+   * @param is_dirty true if the page should be marked as dirty
+   * @return false if the pin count of the frame is already 0, true otherwise
+   */
+  bool UnpinFrame(frame_id_t frame_id, bool is_dirty);
+
+  /**
+   * Picks a frame from the free list or, failing that, a victim from the replacer and removes the victim from the
+   * page table. A dirty victim is registered in evicting_ until it has been written back. Must be called with latch_
+   * held.
+   * @param[out] frame_id the frame picked
+   * @param[out] dirty_page_id the page that has to be written back first, INVALID_PAGE_ID if there is none
+   * @return false if every frame is pinned, true otherwise
+   */
+  bool FindFrame(frame_id_t *frame_id, page_id_t *dirty_page_id);
+
+  /**
+   * Installs page_id into the frame picked by FindFrame, pinned once and not READY yet. Must be called with latch_
+   * held.
+   * @param frame_id frame picked by FindFrame
+   * @param page_id page that is going to live in the frame
+   * @param dirty_page_id page that has to be written back first, INVALID_PAGE_ID if there is none
+   */
+  void InstallPage(frame_id_t frame_id, page_id_t page_id, page_id_t dirty_page_id);
+
+  /**
+   * Writes back the previous page of a frame installed by InstallPage, if there is one. Must be called WITHOUT latch_
+   * held; the frame moves on from EVICTING to LOADING. If the write fails, the previous page gets the frame back,
+   * READY and dirty, page_id leaves the page table and the exception is rethrown.
+   * @param frame_id frame installed by InstallPage
+   * @param page_id page that is going to live in the frame
+   * @param dirty_page_id page that has to be written back, INVALID_PAGE_ID if there is none
+   */
+  void WriteBackVictim(frame_id_t frame_id, page_id_t page_id, page_id_t dirty_page_id);
+
+  /**
+   * Writes back the previous page of a frame installed by InstallPage, fills the frame with its new page and marks it
+   * READY. Must be called WITHOUT latch_ held; every thread waiting on the frame is woken up.
+   * @param frame_id frame installed by InstallPage
+   * @param page_id page that lives in the frame
+   * @param dirty_page_id page that has to be written back first, INVALID_PAGE_ID if there is none
+   * @param read_page true to read page_id from disk, false to leave the frame zeroed (for new pages)
+   * @throws Exception if the write-back or the read fails, once the frame went back to the victim or was abandoned
+   */
+  void LoadFrame(frame_id_t frame_id, page_id_t page_id, page_id_t dirty_page_id, bool read_page);
+
+  /**
+   * Gives up a frame whose page could not be read: page_id leaves the page table, the frame is emptied and marked
+   * READY, and it goes to the free list once the last waiter unpins it. Must be called with latch_ held.
+   * @param frame_id frame installed by InstallPage
+   * @param page_id page that failed to load
+   */
+  void AbandonFrame(frame_id_t frame_id, page_id_t page_id);
+
+  /** Number of pages in the buffer pool. */
+  size_t pool_size_;
+  /** Array of buffer pool pages. */
+  Page *pages_;
+  /** The arena of pages_ if it was allocated by this instance, nullptr if pages_ is a slice of a larger arena. */
+  std::unique_ptr<FrameArena> arena_;
+  /** Number of instances in the parallel buffer pool this instance belongs to (1 if standalone). */
+  const uint32_t num_instances_ = 1;
+  /** Index of this instance in the parallel buffer pool. */
+  const uint32_t instance_index_ = 0;
+  /** Next page id to be allocated by this instance. */
+  std::atomic<page_id_t> next_page_id_ = 0;
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Pointer to the log manager. */
+  LogManager *log_manager_ __attribute__((__unused__));
+  /** Page table for keeping track of buffer pool pages. */
+  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  /** Replacer to find unpinned pages for replacement. */
+  Replacer *replacer_;
+  /** List of free pages. */
+  std::list<frame_id_t> free_list_;
+  /** State of every frame, see FrameState. */
+  std::vector<FrameState> frame_states_;
+  /** Signalled whenever the state of the corresponding frame changes, so that waiters only wake up for their frame. */
+  std::vector<std::condition_variable> frame_cvs_;
+  /** Dirty pages that were evicted but are still being written back, mapped to the frame they are written from. */
+  std::unordered_map<page_id_t, frame_id_t> evicting_;
+  /** Logical time of the last unpin of every frame that left it unpinned, see unpin_clock_. */
+  std::vector<uint64_t> unpin_times_;
+  /**
+   * recLSN of every frame, the oldest LSN of a change to its page that may not be on disk, INVALID_LSN if there is
+   * none. It belongs to the evicted page while a frame is EVICTING.
+   */
+  std::vector<lsn_t> rec_lsns_;
+  /** Next LSN when every frame was last pinned by nobody else, no change made under the pin has an older LSN. */
+  std::vector<lsn_t> pin_lsns_;
+  /** Bumped every time a frame becomes unpinned. */
+  uint64_t unpin_clock_{0};
+  /** Share of the unpinned frames the cleaner keeps clean. */
+  double clean_ratio_{0};
+  /** Maximum number of pages the cleaner writes back per batch. */
+  size_t cleaner_batch_size_{0};
+  /** How long the cleaner sleeps between checks. */
+  std::chrono::milliseconds cleaner_interval_{0};
+  /** True while the cleaner should keep running. */
+  bool cleaner_running_{false};
+  /** Wakes up the cleaner early, when it is stopped or when a dirty page had to be written back on eviction. */
+  std::condition_variable cleaner_cv_;
+  /** The page cleaner thread, not joinable if there is no cleaner. */
+  std::thread cleaner_;
+  /** Statistics, see BufferPoolStats. */
+  ShardedCounter num_hits_;
+  ShardedCounter num_misses_;
+  ShardedCounter num_evictions_;
+  ShardedCounter num_dirty_write_backs_;
+  ShardedCounter num_cleaner_write_backs_;
+  ShardedCounter num_pin_failures_;
+  LatencyHistogram latch_wait_;
+  /**
+   * This latch protects page_table_, free_list_, evicting_, frame_states_, the cleaner settings and the book-keeping
+   * of every page (page id, pin count, dirty flag, recLSN, unpin time). It is never held during disk I/O.
+   */
+  std::mutex latch_;
+};
+}  // namespace bustub
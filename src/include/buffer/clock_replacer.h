@@ -12,9 +12,8 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <vector>
+#include <atomic>
+#include <memory>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
@@ -23,6 +22,12 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * It is lock-free: every frame is a single atomic byte holding its "in the replacer" flag and its reference bit, so
+ * Pin and Unpin are one atomic read-modify-write each, on that byte only. Only Victim sweeps the clock hand, and it
+ * claims a frame with a compare-and-swap on its state, which loses gracefully against a concurrent Pin or Unpin of the
+ * same frame. There is no shared counter: Victim gives up after two full rotations without a candidate, and Size
+ * counts the frames on demand.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -46,7 +51,17 @@ class ClockReplacer : public Replacer {
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** The frame can be victimized. */
+  static constexpr uint8_t IN_REPLACER = 1;
+  /** The frame was unpinned since the clock hand last passed it. */
+  static constexpr uint8_t REFERENCED = 2;
+
+  /** Number of frames in the clock. */
+  const size_t num_pages_;
+  /** IN_REPLACER | REFERENCED bits of every frame. */
+  std::unique_ptr<std::atomic<uint8_t>[]> states_;
+  /** The clock hand, taken modulo num_pages_. Victim claims one position at a time with fetch_add. */
+  std::atomic<size_t> hand_{0};
 };
 
 }  // namespace bustub
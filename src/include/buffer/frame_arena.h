@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the frames of a buffer pool. All frames live back to back in one anonymous mapping, so a large pool
+ * can be backed by huge pages, which cuts down on TLB misses. The mapping can be split into equal parts that are bound
+ * to different NUMA nodes, e.g. one part per socket for the instances of a ParallelBufferPoolManager.
+ *
+ * The data of a page is the first member of Page and callers rely on that, so frames are not PAGE_SIZE aligned; the
+ * mapping starts on a (huge) page boundary and frames are sizeof(Page) apart.
+ *
+ * Huge pages are taken from the hugetlbfs pool if it has enough of them (MAP_HUGETLB), otherwise the mapping is
+ * aligned to the huge page size and transparent huge pages are requested with madvise. Both are best effort, as is
+ * binding to NUMA nodes: if the kernel refuses, the arena warns and falls back to regular pages on any node. Arenas
+ * smaller than HUGE_PAGE_THRESHOLD are plain mappings of regular pages.
+ */
+class FrameArena {
+ public:
+  /**
+   * Creates a new arena. Constructing the frames touches all of their memory, after it has been bound to its node.
+   * @param num_frames the number of frames
+   * @param num_numa_nodes the number of NUMA nodes to split the arena over, part i is bound to node i (1 = no binding)
+   * @param huge_pages true if the arena should be backed by huge pages, if it is at least HUGE_PAGE_THRESHOLD large
+   */
+  explicit FrameArena(size_t num_frames, size_t num_numa_nodes = 1, bool huge_pages = true);
+
+  ~FrameArena();
+
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  /** @return the frames of this arena */
+  Page *GetPages() { return pages_; }
+
+  /** @return the number of frames of this arena */
+  size_t GetNumFrames() const { return num_frames_; }
+
+  /** @return true if the arena was mapped for huge pages, from the hugetlbfs pool or with THP requested */
+  bool UsesHugePages() const { return huge_pages_; }
+
+  /** @return true if the page data comes from the hugetlbfs pool */
+  bool IsHugeTlb() const { return huge_tlb_; }
+
+  /** @return true if the page data is bound to NUMA nodes */
+  bool IsNumaBound() const { return numa_bound_; }
+
+  /** @return the number of NUMA nodes of this machine */
+  static size_t GetNumNumaNodes();
+
+  /** Size of a huge page. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /** Size from which on an arena is backed by huge pages, so that rounding up to whole huge pages wastes little. */
+  static constexpr size_t HUGE_PAGE_THRESHOLD = 8 * HUGE_PAGE_SIZE;
+
+ private:
+  /** Maps length_ bytes of anonymous memory aligned to HUGE_PAGE_SIZE, with THP requested. */
+  void MapAligned();
+
+  /** Binds part i of memory_ to node i. */
+  void BindToNodes(size_t num_numa_nodes);
+
+  const size_t num_frames_;
+  /** The frames, constructed in place at the start of memory_. */
+  Page *pages_{nullptr};
+  /** The mapping that holds the frames. */
+  char *memory_{nullptr};
+  /** Length of memory_, a multiple of alignment_. */
+  size_t length_{0};
+  /** HUGE_PAGE_SIZE if the arena uses huge pages, the regular page size otherwise. */
+  size_t alignment_{0};
+  bool huge_pages_{false};
+  bool huge_tlb_{false};
+  bool numa_bound_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy. It evicts the frame whose K-th most recent access lies
+ * furthest in the past. Frames with fewer than K accesses count as infinitely far in the past and go first, oldest
+ * access first, so that pages touched once by a scan are evicted before pages that are looked up again and again.
+ *
+ * Scan accesses never add to the history of a frame beyond its first access, so a scan that touches the same page
+ * for every tuple on it does not make that page look hot.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of accesses that are remembered per frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = 2);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+ private:
+  /** Per-frame book-keeping. */
+  struct Frame {
+    /** Timestamps of the last (at most) k_ accesses, oldest first. */
+    std::deque<uint64_t> history_;
+    /** True if the frame can be victimized. */
+    bool evictable_{false};
+  };
+
+  /** @return the evictable set the frame belongs in, given its history */
+  std::set<std::pair<uint64_t, frame_id_t>> &SetOf(const Frame &frame) {
+    return frame.history_.size() < k_ ? cold_ : hot_;
+  }
+
+  /** Appends an access to the history of the frame. Must be called with latch_ held, frame not in cold_ or hot_. */
+  void Access(Frame *frame, AccessType access_type);
+
+  /** Number of accesses remembered per frame. */
+  const size_t k_;
+  /** Logical clock, bumped on every access. */
+  uint64_t current_timestamp_{0};
+  std::vector<Frame> frames_;
+  /** Evictable frames with fewer than k_ accesses, ordered by their oldest access. */
+  std::set<std::pair<uint64_t, frame_id_t>> cold_;
+  /** Evictable frames with k_ accesses, ordered by their k-th most recent access. */
+  std::set<std::pair<uint64_t, frame_id_t>> hot_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_prefetcher.h
+//
+// Identification: src/include/buffer/page_prefetcher.h
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * PagePrefetcher reads ahead along a chain of pages, e.g. the pages of a TableHeap, so that a scan finds the next
+ * pages already in the buffer pool instead of blocking on each one in turn.
+ *
+ * The consumer reports every page it moves onto with Advance(). A background thread then follows the next-page links
+ * from there and reads up to `depth` pages ahead of the consumer into the buffer pool with
+ * BufferPoolManager::PrefetchPage. A prefetched page is only pinned while it is read, so read-ahead never holds on to
+ * frames the rest of the system needs.
+ */
+class PagePrefetcher {
+ public:
+  /** Reads the id of the page that follows the given page in the chain, INVALID_PAGE_ID at the end of the chain. */
+  using next_page_fn = std::function<page_id_t(Page *)>;
+
+  /**
+   * Creates a new PagePrefetcher and starts its background thread.
+   * @param bpm the buffer pool manager to prefetch into
+   * @param depth the maximum number of pages to read ahead of the consumer
+   * @param next_page reads the next-page link of a page, called with the page read latched
+   */
+  PagePrefetcher(BufferPoolManager *bpm, size_t depth, next_page_fn next_page);
+
+  /**
+   * Stops the background thread.
+   */
+  ~PagePrefetcher();
+
+  /**
+   * Tells the prefetcher that the consumer moved onto the given page. If the page was prefetched, read-ahead keeps
+   * going from the end of the window, otherwise it restarts from this page.
+   * @param page_id the page the consumer is on now
+   */
+  void Advance(page_id_t page_id);
+
+  /** @return the number of pages that were read ahead so far */
+  size_t GetNumPrefetched();
+
+ private:
+  /** Body of the background thread. */
+  void Run();
+
+  /** The buffer pool manager to prefetch into. */
+  BufferPoolManager *bpm_;
+  /** The maximum number of pages to read ahead. */
+  const size_t depth_;
+  /** Reads the next-page link of a page. */
+  next_page_fn next_page_;
+
+  /** Protects all members below. */
+  std::mutex latch_;
+  /** Signalled when the consumer advances or the prefetcher is stopped. */
+  std::condition_variable cv_;
+  /** Pages read ahead of the consumer that it has not reached yet, in chain order. */
+  std::deque<page_id_t> window_;
+  /** The page whose next-page link is followed next, INVALID_PAGE_ID if there is nothing to follow. */
+  page_id_t cursor_{INVALID_PAGE_ID};
+  /** The page the background thread is reading ahead right now, INVALID_PAGE_ID if none. */
+  page_id_t fetching_{INVALID_PAGE_ID};
+  /** True if the consumer moved onto fetching_ before it was read, so it does not go into the window. */
+  bool fetching_consumed_{false};
+  /** Bumped whenever read-ahead restarts, so that a fetch that raced with the restart is dropped. */
+  uint64_t generation_{0};
+  /** Number of pages read ahead so far. */
+  size_t num_prefetched_{0};
+  /** True once the background thread should exit. */
+  bool stop_{false};
+  /** The background thread. */
+  std::thread worker_;
+};
+
+}  // namespace bustub
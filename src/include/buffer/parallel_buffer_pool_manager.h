@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/frame_arena.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager hashes page ids to a fixed number of independent BufferPoolManagerInstances, each with
+ * its own page table, free list, replacer and latch, so that threads touching different pages do not contend.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_policy the replacement policy of every instance
+   * @param num_numa_nodes the number of NUMA nodes to spread the frames of the instances over (1 = no binding)
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr, ReplacerPolicy replacer_policy = ReplacerPolicy::LRU,
+                            size_t num_numa_nodes = 1);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return the number of instances in this parallel buffer pool */
+  size_t GetNumInstances() { return instances_.size(); }
+
+  /** @return pointer to all the pages of all instances, one consecutive slice per instance */
+  Page *GetPages() override { return arena_->GetPages(); }
+
+  /** @return size of the buffer pool, the pool size of every instance added up */
+  size_t GetPoolSize() override { return arena_->GetNumFrames(); }
+
+  /**
+   * @param page_id id of page
+   * @return the instance responsible for handling the given page id
+   */
+  BufferPoolManager *GetBufferPoolManager(page_id_t page_id);
+
+  /** Starts a page cleaner in every instance, see BufferPoolManagerInstance::StartPageCleaner. */
+  void StartPageCleaner(double clean_ratio, size_t batch_size = 32,
+                        std::chrono::milliseconds interval = std::chrono::milliseconds(10)) override;
+
+  /** Stops the page cleaner of every instance. */
+  void StopPageCleaner() override;
+
+  /** @return the statistics of all instances added up, see BufferPoolManagerInstance::GetStats */
+  BufferPoolStats GetStats() override;
+
+  /** Drops the statistics of every instance. */
+  void ResetStats() override;
+
+  /** @return the dirty page tables of all instances together, see BufferPoolManagerInstance::GetDirtyPageTable */
+  std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable() override;
+
+ protected:
+  Page *FetchPageImpl(page_id_t page_id) override;
+
+  Page *FetchPageWithHintImpl(page_id_t page_id, AccessType access_type) override;
+
+  bool PrefetchPageImpl(page_id_t page_id) override;
+
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page, trying the instances round robin so that allocations are spread evenly.
+   * @param[out] page_id id of created page
+   * @return nullptr if no instance could create a new page, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  void FlushAllPagesImpl() override;
+
+ private:
+  /** The frames of every instance. */
+  std::unique_ptr<FrameArena> arena_;
+  /** The instances, indexed by page_id % instances_.size(). Each one works on a slice of the arena. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** The instance that NewPage tries first. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
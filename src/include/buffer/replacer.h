@@ -16,6 +16,12 @@
 
 namespace bustub {
 
+/** How a page is accessed, so that a replacement policy can tell one-off scans apart from repeated lookups. */
+enum class AccessType { Unknown, Lookup, Scan };
+
+/** The replacement policies a BufferPoolManager can be constructed with. */
+enum class ReplacerPolicy { LRU, CLOCK, LRU_K, TWO_Q };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -45,6 +51,21 @@ class Replacer {
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
+
+  /**
+   * Records an access to the page held by a frame. The buffer pool calls this on every fetch, before pinning the
+   * frame. Policies that only look at the order of unpins ignore it.
+   * @param frame_id the id of the accessed frame
+   * @param access_type how the page is accessed
+   */
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type) {}
+
+  /**
+   * Forgets a frame entirely, e.g. because its page was deleted, so that its history does not carry over to the next
+   * page that is held by the frame.
+   * @param frame_id the id of the frame to forget
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
 };
 
 }  // namespace bustub
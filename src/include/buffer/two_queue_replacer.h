@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the simplified 2Q replacement policy. A frame enters the FIFO queue A1 on its first
+ * access and is promoted to the LRU queue Am when it is accessed again. Victims come from A1 as long as A1 holds more
+ * than its share of the evictable frames, so a long scan only ever cycles through A1 and leaves the pages in Am alone.
+ *
+ * Scan accesses never promote a frame to Am.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * Create a new TwoQueueReplacer.
+   * @param num_pages the maximum number of pages the TwoQueueReplacer will be required to store
+   * @param a1_ratio the share of the frames that A1 may hold before it is always the one to give up a victim
+   */
+  explicit TwoQueueReplacer(size_t num_pages, double a1_ratio = 0.25);
+
+  /**
+   * Destroys the TwoQueueReplacer.
+   */
+  ~TwoQueueReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+ private:
+  /** The queue a frame belongs to. */
+  enum class Queue { NONE, A1, AM };
+
+  /** Per-frame book-keeping. */
+  struct Frame {
+    Queue queue_{Queue::NONE};
+    /** First access for frames in A1, last access for frames in Am. */
+    uint64_t timestamp_{0};
+    /** True if the frame can be victimized. */
+    bool evictable_{false};
+  };
+
+  /** @return the evictable set of the queue the frame belongs to */
+  std::set<std::pair<uint64_t, frame_id_t>> &SetOf(const Frame &frame) { return frame.queue_ == Queue::AM ? am_ : a1_; }
+
+  /** Records an access to the frame. Must be called with latch_ held, frame not in a1_ or am_. */
+  void Access(Frame *frame, AccessType access_type);
+
+  /** Number of frames in A1, evictable or not. */
+  size_t a1_size_{0};
+  /** Maximum number of frames in A1 before A1 is always victimized first. */
+  const size_t a1_max_size_;
+  /** Logical clock, bumped on every access. */
+  uint64_t current_timestamp_{0};
+  std::vector<Frame> frames_;
+  /** Evictable frames in A1, in FIFO order. */
+  std::set<std::pair<uint64_t, frame_id_t>> a1_;
+  /** Evictable frames in Am, in LRU order. */
+  std::set<std::pair<uint64_t, frame_id_t>> am_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
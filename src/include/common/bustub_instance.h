@@ -10,32 +10,73 @@
 //
 //===----------------------------------------------------------------------===//
 
+#pragma once
+
+#include <memory>
 #include <string>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
+#include "recovery/log_recovery.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
+/**
+ * Sizes of the components of a BustubInstance, chosen at runtime. The defaults are the constants in common/config.h;
+ * only the page size is fixed when building.
+ */
+struct BustubConfig {
+  /** Number of frames in the buffer pool, split evenly over the instances. */
+  size_t buffer_pool_size_{BUFFER_POOL_SIZE};
+  /** Number of independent buffer pool instances, more than one makes a ParallelBufferPoolManager. */
+  size_t buffer_pool_instances_{1};
+  /** Replacement policy of every buffer pool instance. */
+  ReplacerPolicy replacer_policy_{ReplacerPolicy::LRU};
+  /** Number of NUMA nodes the frames are spread over, with more than one buffer pool instance (1 = no binding). */
+  size_t numa_nodes_{1};
+  /** Share of the unpinned frames a page cleaner thread per instance keeps clean, 0 for no page cleaners. */
+  double page_cleaner_ratio_{0};
+  /** Size of the log buffer in bytes, i.e. of the largest log record. */
+  int log_buffer_size_{LOG_BUFFER_SIZE};
+  /** Number of buckets the lock table starts with. */
+  size_t lock_table_buckets_{0};
+  /** Number of threads recovery runs on, 0 for one per hardware thread. */
+  size_t recovery_threads_{0};
+};
+
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  explicit BustubInstance(const std::string &db_file_name, const BustubConfig &config = BustubConfig())
+      : config_(config) {
     enable_logging = false;
 
     // storage related
     disk_manager_ = new DiskManager(db_file_name);
 
     // log related
-    log_manager_ = new LogManager(disk_manager_);
+    log_manager_ = new LogManager(disk_manager_, config_.log_buffer_size_);
 
-    buffer_pool_manager_ = new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    if (config_.buffer_pool_instances_ > 1) {
+      const size_t instance_size =
+          (config_.buffer_pool_size_ + config_.buffer_pool_instances_ - 1) / config_.buffer_pool_instances_;
+      buffer_pool_manager_ =
+          new ParallelBufferPoolManager(config_.buffer_pool_instances_, instance_size, disk_manager_, log_manager_,
+                                        config_.replacer_policy_, config_.numa_nodes_);
+    } else {
+      buffer_pool_manager_ = new BufferPoolManagerInstance(config_.buffer_pool_size_, disk_manager_, log_manager_,
+                                                           config_.replacer_policy_);
+    }
+    if (config_.page_cleaner_ratio_ > 0) {
+      buffer_pool_manager_->StartPageCleaner(config_.page_cleaner_ratio_);
+    }
 
     // txn related
-    lock_manager_ = new LockManager();
+    lock_manager_ = new LockManager(config_.lock_table_buckets_);
     transaction_manager_ = new TransactionManager(lock_manager_, log_manager_);
 
     // checkpoints
@@ -54,6 +95,21 @@ class BustubInstance {
     delete disk_manager_;
   }
 
+  /** @return a new LogRecovery over this instance's log and buffer pool, sized by the config; the caller owns it */
+  LogRecovery *NewLogRecovery() {
+    return new LogRecovery(disk_manager_, buffer_pool_manager_, log_manager_, config_.recovery_threads_,
+                           config_.log_buffer_size_);
+  }
+
+  /** Recover from the log before logging is enabled, new LSNs and transaction ids continue after the recovered ones. */
+  void Recover() {
+    std::unique_ptr<LogRecovery> log_recovery(NewLogRecovery());
+    log_recovery->Redo();
+    log_recovery->Undo();
+    transaction_manager_->SetNextTxnId(log_recovery->GetMaxTxnId() + 1);
+  }
+
+  const BustubConfig config_;
   DiskManager *disk_manager_;
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
@@ -16,6 +16,12 @@
 #include <chrono>  // NOLINT
 #include <cstdint>
 
+// Page size in bytes, chosen when building, see BUSTUB_PAGE_SIZE in CMakeLists.txt. Every page layout derives its
+// capacity from it.
+#ifndef BUSTUB_PAGE_SIZE
+#define BUSTUB_PAGE_SIZE 4096
+#endif
+
 namespace bustub {
 
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
@@ -31,15 +37,23 @@ static constexpr int INVALID_PAGE_ID = -1;                                    //
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
-static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int PAGE_SIZE = BUSTUB_PAGE_SIZE;                            // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
+static constexpr int LOG_SEGMENT_SIZE = 1 << 20;                              // size of a log segment file in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int SEQ_SCAN_PREFETCH_DEPTH = 8;                             // seq scan read-ahead, 0 = off
+static constexpr int EXECUTOR_MEMORY_BUDGET = 1 << 24;                        // bytes an executor holds before spilling
+static constexpr int VECTOR_BATCH_SIZE = 1024;                                // rows an executor passes per NextBatch
+static constexpr int AGGREGATION_THREADS = 4;                                 // threads of a hash aggregation
+
+static_assert(PAGE_SIZE == 4096 || PAGE_SIZE == 8192 || PAGE_SIZE == 16384, "Pages are 4K, 8K or 16K in size.");
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
 using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
+using log_offset_t = int64_t;  // log file offset type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
 
@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// metrics.h
+//
+// Identification: src/include/common/metrics.h
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * Metrics are updated on hot paths by many threads at once, so every metric is split into shards on cache lines of
+ * their own. A thread always updates the same shard, picked round robin when the thread first touches a metric, and
+ * only readers pay for adding up the shards. Updates are relaxed: a snapshot taken while threads are running is not
+ * an atomic cut across metrics, but every update shows up eventually.
+ */
+static constexpr size_t METRICS_NUM_SHARDS = 16;
+
+/** @return the shard the calling thread updates */
+inline size_t MetricsShard() {
+  static std::atomic<size_t> next_shard{0};
+  thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % METRICS_NUM_SHARDS;
+  return shard;
+}
+
+/**
+ * A monotonic event counter.
+ */
+class ShardedCounter {
+ public:
+  ShardedCounter() = default;
+  DISALLOW_COPY_AND_MOVE(ShardedCounter);
+
+  /** Adds n to the counter. */
+  void Add(uint64_t n = 1) { shards_[MetricsShard()].value_.fetch_add(n, std::memory_order_relaxed); }
+
+  /** @return the sum over all shards */
+  uint64_t Get() const {
+    uint64_t sum = 0;
+    for (const auto &shard : shards_) {
+      sum += shard.value_.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  /** Sets the counter back to 0. Updates that race with the reset may or may not survive it. */
+  void Reset() {
+    for (auto &shard : shards_) {
+      shard.value_.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> value_{0};
+  };
+  std::array<Shard, METRICS_NUM_SHARDS> shards_;
+};
+
+/**
+ * A point in time copy of a LatencyHistogram. Bucket 0 counts latencies of 0ns, bucket i > 0 counts latencies in
+ * [2^(i-1), 2^i) ns and the last bucket everything above. A histogram of other values, e.g. sizes, has the same
+ * buckets in its own unit.
+ */
+struct HistogramSnapshot {
+  static constexpr size_t NUM_BUCKETS = 40;
+
+  std::array<uint64_t, NUM_BUCKETS> buckets_{};
+  /** Number of recorded latencies. */
+  uint64_t count_{0};
+  /** Sum of the recorded latencies in ns, or of the recorded values. */
+  uint64_t sum_ns_{0};
+
+  /** @return the mean latency in ns, 0 if nothing was recorded */
+  double Mean() const { return count_ == 0 ? 0 : static_cast<double>(sum_ns_) / static_cast<double>(count_); }
+
+  /**
+   * @param p a percentile between 0 and 100
+   * @return an upper bound of the p-th percentile in ns, i.e. the upper end of the bucket it falls into
+   */
+  uint64_t Percentile(double p) const;
+
+  /** Adds the latencies of other to this snapshot, e.g. to combine the instances of a parallel buffer pool. */
+  HistogramSnapshot &operator+=(const HistogramSnapshot &other);
+
+  /**
+   * @param unit the unit of the recorded values
+   * @return count, mean, p50, p99 and p99.9 on one line
+   */
+  std::string ToString(const std::string &unit = "ns") const;
+};
+
+/**
+ * A histogram of latencies with power of two buckets. It takes other values as well, see RecordValue.
+ */
+class LatencyHistogram {
+ public:
+  LatencyHistogram() = default;
+  DISALLOW_COPY_AND_MOVE(LatencyHistogram);
+
+  /** Records one latency. */
+  void Record(std::chrono::nanoseconds latency) {
+    RecordValue(static_cast<uint64_t>(latency.count() < 0 ? 0 : latency.count()));
+  }
+
+  /** Records one value that is not a latency, e.g. a size. The snapshot then counts in the unit of the values. */
+  void RecordValue(uint64_t value) {
+    size_t bucket = value == 0 ? 0 : 64 - __builtin_clzll(value);
+    if (bucket >= HistogramSnapshot::NUM_BUCKETS) {
+      bucket = HistogramSnapshot::NUM_BUCKETS - 1;
+    }
+    auto &shard = shards_[MetricsShard()];
+    shard.buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.sum_ns_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  /** @return the sum over all shards */
+  HistogramSnapshot Snapshot() const;
+
+  /** Drops every recorded latency. Records that race with the reset may or may not survive it. */
+  void Reset();
+
+ private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, HistogramSnapshot::NUM_BUCKETS> buckets_{};
+    std::atomic<uint64_t> sum_ns_{0};
+  };
+  std::array<Shard, METRICS_NUM_SHARDS> shards_;
+};
+
+/**
+ * Records the time between its construction and its destruction into a histogram.
+ */
+class LatencyTimer {
+ public:
+  explicit LatencyTimer(LatencyHistogram *histogram)
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+  ~LatencyTimer() { histogram_->Record(std::chrono::steady_clock::now() - start_); }
+  DISALLOW_COPY_AND_MOVE(LatencyTimer);
+
+ private:
+  LatencyHistogram *histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace bustub
@@ -66,8 +66,10 @@ class LockManager {
  public:
   /**
    * Creates a new lock manager configured for the deadlock detection policy.
+   * @param num_buckets number of buckets the lock table starts with, so that it does not rehash while it grows
    */
-  LockManager() {
+  explicit LockManager(size_t num_buckets = 0) {
+    lock_table_.rehash(num_buckets);
     enable_cycle_detection_ = true;
     cycle_detection_thread_ = new std::thread(&LockManager::RunCycleDetection, this);
     LOG_INFO("Cycle detection thread launched");
@@ -13,8 +13,11 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
@@ -42,9 +45,16 @@ class TransactionManager {
    */
   Transaction *Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ);
 
+  /**
+   * Makes new transactions start at txn_id, past the transactions an earlier run left in the log, see LogRecovery.
+   * @param txn_id the id of the next transaction
+   */
+  void SetNextTxnId(txn_id_t txn_id) { next_txn_id_ = txn_id; }
+
   /**
    * Commits a transaction.
    * @param txn the transaction to commit
+   * @throws Exception if the commit record could not be made persistent, the locks of txn are released anyway
    */
   void Commit(Transaction *txn);
 
@@ -73,6 +83,13 @@ class TransactionManager {
     return res;
   }
 
+  /**
+   * The active transaction table of a checkpoint. With logging enabled, every transaction that has begun and has not
+   * logged its COMMIT or ABORT record yet is in it.
+   * @return the id of every active transaction and an LSN at or before its first log record
+   */
+  std::vector<std::pair<txn_id_t, lsn_t>> GetActiveTransactions();
+
   /** Prevents all transactions from performing operations, used for checkpointing. */
   void BlockAllTransactions();
 
@@ -97,12 +114,23 @@ class TransactionManager {
     }
   }
 
+  /**
+   * Removes the transaction from the active transaction table, once its COMMIT or ABORT record is logged.
+   * @param txn the transaction that ended
+   */
+  void EndTransaction(Transaction *txn);
+
   std::atomic<txn_id_t> next_txn_id_{0};
   LockManager *lock_manager_ __attribute__((__unused__));
   LogManager *log_manager_ __attribute__((__unused__));
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
+
+  /** With logging enabled, the running transactions mapped to the next LSN when they began. */
+  std::unordered_map<txn_id_t, lsn_t> active_txns_;
+  /** Protects active_txns_. */
+  std::mutex active_txns_latch_;
 };
 
 }  // namespace bustub
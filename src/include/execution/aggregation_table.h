@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_table.h
+//
+// Identification: src/include/execution/aggregation_table.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/vector_batch.h"
+#include "type/value.h"
+
+namespace bustub {
+
+class SimpleAggregationHashTable;
+
+/**
+ * AggregationTable groups the rows of an aggregation's child and aggregates every group.
+ *
+ * The rows are aggregated by plan->GetNumThreads() workers, each into tables of its own, split into partitions by the
+ * hash of the group-by key. Finish merges the tables partition by partition, a partition per worker at a time. When
+ * every group-by expression has a fixed-width type, keys are packed into a fixed number of 64-bit words instead of a
+ * vector of Values.
+ *
+ * A worker whose groups exceed its share of plan->GetMemoryBudget() appends them to temporary pages, a run per
+ * partition, and starts over with empty tables. If any worker spilled, Finish spills the remaining groups as well and
+ * NextGroup merges the spilled partitions one at a time. A partition that still exceeds the budget is split further
+ * by a different hash, so memory stays bounded however many groups there are.
+ */
+class AggregationTable {
+ public:
+  /**
+   * Creates a table for an aggregation.
+   * @param plan the aggregation plan
+   * @param functions the aggregate functions of the plan, used to combine the values of a group
+   * @param bpm the buffer pool the groups are spilled to
+   * @return the table
+   */
+  static std::unique_ptr<AggregationTable> Create(const AggregationPlanNode *plan,
+                                                  const SimpleAggregationHashTable *functions, BufferPoolManager *bpm);
+
+  /** Stops the workers. */
+  virtual ~AggregationTable() = default;
+
+  /** Aggregates the selected rows of a batch of the child's rows, on a worker thread if there are any. */
+  virtual void Consume(VectorBatch &&batch) = 0;
+
+  /** Waits for the workers to aggregate every batch, merges their tables, and starts producing groups. */
+  virtual void Finish() = 0;
+
+  /**
+   * Produces the next group, in no particular order.
+   * @param[out] group_bys the values of the group-by expressions of the group
+   * @param[out] aggregates the aggregate values of the group, valid until the table changes
+   * @return false if there are no more groups
+   */
+  virtual bool NextGroup(std::vector<Value> *group_bys, const AggregateValue **aggregates) = 0;
+
+  /** Produces the groups from the first one again. */
+  virtual void Rewind() = 0;
+
+  /** @return the number of spilled partitions merged back into memory, 0 if every group fit into memory */
+  virtual size_t GetNumSpilledPartitions() const = 0;
+};
+
+}  // namespace bustub
@@ -20,6 +20,7 @@
 #include "execution/executor_context.h"
 #include "execution/executor_factory.h"
 #include "execution/plans/abstract_plan.h"
+#include "execution/vector_batch.h"
 #include "storage/table/tuple.h"
 namespace bustub {
 class ExecutionEngine {
@@ -50,6 +51,8 @@ class ExecutionEngine {
         case PlanType::Limit:
         case PlanType::NestedLoopJoin:
         case PlanType::NestedIndexJoin:
+        case PlanType::HashJoin:
+        case PlanType::Sort:
           return true;
         default:
           throw NotImplementedException("Unknown Plan Type");
@@ -57,11 +60,20 @@ class ExecutionEngine {
       return false;
     };
     try {
-      Tuple tuple;
-      RID rid;
-      while (executor->Next(&tuple, &rid)) {
-        if (result_set != nullptr && HasReturnType(plan->GetType())) {
-          result_set->push_back(tuple);
+      if (HasReturnType(plan->GetType())) {
+        // queries pull their result a batch at a time, only the result set holds tuples
+        VectorBatch batch;
+        while (executor->NextBatch(&batch)) {
+          if (result_set != nullptr) {
+            for (uint32_t row : batch.GetSelection()) {
+              result_set->push_back(batch.MakeTuple(row));
+            }
+          }
+        }
+      } else {
+        Tuple tuple;
+        RID rid;
+        while (executor->Next(&tuple, &rid)) {
         }
       }
     } catch (Exception &e) {
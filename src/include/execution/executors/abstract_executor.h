@@ -13,11 +13,13 @@
 #pragma once
 
 #include "execution/executor_context.h"
+#include "execution/vector_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 /**
- * AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
+ * AbstractExecutor implements the Volcano tuple-at-a-time iterator model. NextBatch passes the same tuples a batch
+ * at a time, Next and NextBatch may be called in any interleaving and continue where the other stopped.
  */
 class AbstractExecutor {
  public:
@@ -44,6 +46,22 @@ class AbstractExecutor {
    */
   virtual bool Next(Tuple *tuple, RID *rid) = 0;
 
+  /**
+   * Produces the next batch of tuples from this executor. The default fills the batch by calling Next, executors
+   * that can produce whole batches cheaper override it.
+   * @param[out] batch reset to the output schema, then filled with up to VECTOR_BATCH_SIZE rows
+   * @return true if the batch holds a selected row, false if there are no more tuples
+   */
+  virtual bool NextBatch(VectorBatch *batch) {
+    batch->Reset(GetOutputSchema());
+    Tuple tuple;
+    RID rid;
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->AppendTuple(tuple, rid);
+    }
+    return batch->GetNumSelected() > 0;
+  }
+
   /** @return the schema of the tuples that this executor produces */
   virtual const Schema *GetOutputSchema() = 0;
 
@@ -19,10 +19,12 @@
 
 #include "common/util/hash_util.h"
 #include "container/hash/hash_function.h"
+#include "execution/aggregation_table.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/aggregation_plan.h"
+#include "execution/vector_batch.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
 
@@ -42,7 +44,7 @@ class SimpleAggregationHashTable {
       : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
 
   /** @return the initial aggregrate value for this aggregation executor */
-  AggregateValue GenerateInitialAggregateValue() {
+  AggregateValue GenerateInitialAggregateValue() const {
     std::vector<Value> values;
     for (const auto &agg_type : agg_types_) {
       switch (agg_type) {
@@ -68,7 +70,7 @@ class SimpleAggregationHashTable {
   }
 
   /** Combines the input into the aggregation result. */
-  void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) {
+  void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) const {
     for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
       switch (agg_types_[i]) {
         case AggregationType::CountAggregate:
@@ -91,6 +93,25 @@ class SimpleAggregationHashTable {
     }
   }
 
+  /** Combines the partial aggregation of some other inputs into the aggregation result. */
+  void MergeAggregateValues(AggregateValue *result, const AggregateValue &partial) const {
+    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+      switch (agg_types_[i]) {
+        case AggregationType::CountAggregate:
+        case AggregationType::SumAggregate:
+          // Counts and sums add up.
+          result->aggregates_[i] = result->aggregates_[i].Add(partial.aggregates_[i]);
+          break;
+        case AggregationType::MinAggregate:
+          result->aggregates_[i] = result->aggregates_[i].Min(partial.aggregates_[i]);
+          break;
+        case AggregationType::MaxAggregate:
+          result->aggregates_[i] = result->aggregates_[i].Max(partial.aggregates_[i]);
+          break;
+      }
+    }
+  }
+
   /**
    * Inserts a value into the hash table and then combines it with the current aggregation.
    * @param agg_key the key to be inserted
@@ -151,6 +172,8 @@ class SimpleAggregationHashTable {
 
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX) on the tuples of a child executor.
+ * The groups are built by an AggregationTable on the plan's number of threads, within the plan's memory budget,
+ * SimpleAggregationHashTable supplies the aggregate functions.
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -168,10 +191,17 @@ class AggregationExecutor : public AbstractExecutor {
 
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
 
+  /** Hands the child's batches to the aggregation table, unless it has been built by an earlier Init already. */
   void Init() override;
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /** Emits the groups that pass the having clause straight into the batch's columns. */
+  bool NextBatch(VectorBatch *batch) override;
+
+  /** @return the number of spilled partitions merged back into memory, 0 if every group fit into memory */
+  size_t GetNumSpilledPartitions() const { return table_ == nullptr ? 0 : table_->GetNumSpilledPartitions(); }
+
   /** @return the tuple as an AggregateKey */
   AggregateKey MakeKey(const Tuple *tuple) {
     std::vector<Value> keys;
@@ -195,10 +225,12 @@ class AggregationExecutor : public AbstractExecutor {
   const AggregationPlanNode *plan_;
   /** The child executor whose tuples we are aggregating. */
   std::unique_ptr<AbstractExecutor> child_;
-  /** Simple aggregation hash table. */
+  /** Simple aggregation hash table, for its aggregate functions. */
   SimpleAggregationHashTable aht_;
-  /** Simple aggregation hash table iterator. */
-  SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** The groups, built by the first Init. */
+  std::unique_ptr<AggregationTable> table_;
+  /** The group-by values of the group being produced. */
+  std::vector<Value> group_bys_;
   /*  having clasue*/
   const AbstractExpression *having_;
 };
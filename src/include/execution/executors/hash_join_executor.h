@@ -0,0 +1,163 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_join_executor.h
+//
+// Identification: src/include/execution/executors/hash_join_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/expressions/compiled_predicate.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/vector_batch.h"
+#include "storage/table/tmp_tuple_run.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * HashJoinExecutor joins two children on equal keys. It builds a hash table on the smaller side and probes it with
+ * the tuples of the other side.
+ *
+ * Init reads the left side until it ends or exceeds the memory budget, then reads the right side until it ends or
+ * exceeds the size of the left side (or the budget). Whichever side ended first within its limit is the build side,
+ * the probe side is streamed. If neither side fits, both are partitioned by key hash into temporary pages, and every
+ * pair of partitions is joined on its own, building on the smaller of the two. A pair whose build side still exceeds
+ * the budget is partitioned again with a different hash, up to MAX_DEPTH levels.
+ *
+ * The probe side is read a batch at a time and its keys are evaluated per column. A probe row is only turned into a
+ * tuple when the predicate or an output column needs it as one.
+ */
+class HashJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new hash join executor.
+   * @param exec_ctx the executor context
+   * @param plan the hash join plan to be executed
+   * @param left_executor the child executor that produces tuples for the left side of the join
+   * @param right_executor the child executor that produces tuples for the right side of the join
+   */
+  HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
+                   std::unique_ptr<AbstractExecutor> &&left_executor,
+                   std::unique_ptr<AbstractExecutor> &&right_executor);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  /** Copies the output columns that refer to a column of either side straight into the batch's columns. */
+  bool NextBatch(VectorBatch *batch) override;
+
+  /** @return the number of partition pairs joined since Init, 0 if the build side fit into memory */
+  size_t GetNumPartitionsJoined() const { return num_partitions_joined_; }
+
+ private:
+  /** Number of partitions a side is split into when it does not fit into memory. */
+  static constexpr size_t FANOUT = 8;
+  /** Partitions are split at most this often. Deeper ones are joined in memory regardless, they may share one key. */
+  static constexpr uint32_t MAX_DEPTH = 4;
+
+  /** The tuples of both sides whose keys fall into the same partition. */
+  struct Partition {
+    std::unique_ptr<TmpTupleRun> left_;
+    std::unique_ptr<TmpTupleRun> right_;
+    uint32_t depth_;
+  };
+
+  /** @return the join key of a tuple of the left or the right side */
+  HashJoinKey MakeKey(const Tuple &tuple, bool left) const;
+
+  /**
+   * Reads tuples from a child until it ends or more than limit bytes have been read.
+   * @param[out] tuples the tuples read
+   * @param[out] size the number of tuple bytes read
+   * @return true if the child ended within the limit
+   */
+  static bool Drain(AbstractExecutor *child, size_t limit, std::vector<Tuple> *tuples, size_t *size);
+
+  /**
+   * Splits the tuples of one side into FANOUT runs by the hash of their keys, dropping those with a NULL key.
+   * @param next produces the tuples of the side
+   * @param left true for the left side
+   * @param depth the depth of the partitions, the hash differs per depth
+   * @return the runs, one per partition
+   */
+  std::vector<std::unique_ptr<TmpTupleRun>> Split(const std::function<bool(Tuple *)> &next, bool left,
+                                                  uint32_t depth);
+
+  /** Splits both sides and queues the partition pairs. */
+  void SplitAndQueue(const std::function<bool(Tuple *)> &next_left, const std::function<bool(Tuple *)> &next_right,
+                     uint32_t depth);
+
+  /** Builds the hash table on one side. */
+  void Build(const std::function<bool(Tuple *)> &next, bool build_left);
+
+  /** Makes the next queued partition pair the one to join. @return false if there is none left */
+  bool NextPartition();
+
+  /** Reads the next batch of the probe side and evaluates its keys. @return false if the probe side is exhausted */
+  bool NextProbeBatch();
+
+  /**
+   * Finds the next pair of the current probe row and a build tuple with the same key that satisfies the predicate,
+   * moving on to further probe rows and partition pairs as needed.
+   * @param[out] build_tuple the build tuple, the probe row is probe_row_
+   * @return false if there are no more pairs
+   */
+  bool NextMatch(const Tuple **build_tuple);
+
+  /** @return the current probe row as a tuple, materialized at most once per row */
+  const Tuple &ProbeTuple();
+
+  /** The hash join plan node to be executed. */
+  const HashJoinPlanNode *plan_;
+  /** The predicate compiled against the schemas of both sides, nullptr if there is none or it does not compile. */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+
+  /** True if the hash table holds tuples of the left side. */
+  bool build_left_{true};
+  std::unordered_map<HashJoinKey, std::vector<Tuple>> hash_table_;
+
+  /** The probe side: buffered tuples first, then the rest of a child or a spilled run. */
+  std::vector<Tuple> probe_tuples_;
+  size_t probe_index_{0};
+  AbstractExecutor *probe_child_{nullptr};
+  std::optional<TmpTupleRun::Reader> probe_reader_;
+
+  /** The partition pair being joined, and those still to join. */
+  Partition partition_;
+  std::vector<Partition> partitions_;
+  size_t num_partitions_joined_{0};
+
+  /** The batch of the probe side being joined, its keys column by column, and the position of the next probe row. */
+  VectorBatch probe_batch_;
+  std::vector<std::vector<Value>> probe_keys_;
+  size_t probe_pos_{0};
+
+  /** The current probe row, and the build tuples with the same key. */
+  uint32_t probe_row_{0};
+  Tuple probe_tuple_;
+  bool has_probe_tuple_{false};
+  const std::vector<Tuple> *matches_{nullptr};
+  size_t match_index_{0};
+};
+
+}  // namespace bustub
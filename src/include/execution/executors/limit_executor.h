@@ -17,6 +17,7 @@
 
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/limit_plan.h"
+#include "execution/vector_batch.h"
 
 namespace bustub {
 /**
@@ -39,6 +40,9 @@ class LimitExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /** Drops the rows before the offset and past the limit from the child's batches by shrinking their selection. */
+  bool NextBatch(VectorBatch *batch) override;
+
  private:
   /** The limit plan node to be executed. */
   const LimitPlanNode *plan_;
@@ -46,5 +50,7 @@ class LimitExecutor : public AbstractExecutor {
   std::unique_ptr<AbstractExecutor> child_executor_;
   /** The current offset of plan. */
   size_t offset_;
+  /** The batch NextBatch reads from the child. */
+  VectorBatch child_batch_;
 };
 }  // namespace bustub
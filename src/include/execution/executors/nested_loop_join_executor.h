@@ -14,16 +14,23 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/compiled_predicate.h"
 #include "execution/plans/nested_loop_join_plan.h"
+#include "storage/page/tmp_tuple_page.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 /**
  * NestedLoopJoinExecutor joins two tables using nested loop.
  * The child executor can either be a sequential scan
+ *
+ * With a block size in the plan, the executor reads as many outer tuples as fit into that many pinned buffer pool
+ * pages, and then scans the inner side once for the whole block, evaluating the predicate of every inner tuple against
+ * every buffered outer tuple. The outer tuples are not copied out of the pages.
  */
 class NestedLoopJoinExecutor : public AbstractExecutor {
  public:
@@ -39,19 +46,54 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
                          std::unique_ptr<AbstractExecutor> &&left_executor,
                          std::unique_ptr<AbstractExecutor> &&right_executor);
 
+  /** Releases the pages of the outer block. */
+  ~NestedLoopJoinExecutor() override;
+
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
 
   void Init() override;
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /** @return the number of times the inner side has been scanned since Init */
+  size_t GetNumInnerScans() const { return num_inner_scans_; }
+
  private:
+  /** Next of the block nested loop join. */
+  bool NextInBlock(Tuple *tuple);
+
+  /**
+   * Fills the block pages with the next outer tuples. An outer tuple too large for a page makes up a block of its own.
+   * @return false if the outer side is exhausted
+   */
+  bool FillBlock();
+
+  /** @return true if there is no predicate or it holds on a pair of outer and inner tuples */
+  bool Matches(const Tuple &left_tuple, const Tuple &right_tuple) const;
+
+  /** @return the output tuple of a pair of outer and inner tuples */
+  Tuple MakeOutputTuple(const Tuple &left_tuple, const Tuple &right_tuple);
+
   /** The NestedLoop plan node to be executed. */
   const NestedLoopJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> left_executor_;
   std::unique_ptr<AbstractExecutor> right_executor_;
   const AbstractExpression *predicate_;
+  /** The predicate compiled against the schemas of both sides, nullptr if there is none or it does not compile. */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
   Tuple left_tuple_{};
   RID left_rid_{};
+  size_t num_inner_scans_{0};
+
+  /** The pinned pages the outer block is buffered in. */
+  std::vector<TmpTuplePage *> block_pages_;
+  /** The outer tuples of the block, pointing into block_pages_ unless a tuple too large for a page is on its own. */
+  std::vector<Tuple> block_;
+  /** The outer tuple after the block, which did not fit into it. */
+  Tuple next_outer_{};
+  bool has_next_outer_{false};
+  /** Index of the next outer tuple to compare the inner tuple with. */
+  size_t block_index_{0};
+  Tuple inner_tuple_{};
 };
 }  // namespace bustub
@@ -12,11 +12,15 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
+#include "buffer/page_prefetcher.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/compiled_predicate.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "execution/vector_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -37,12 +41,38 @@ class SeqScanExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /** Reads tuples off the table a batch at a time, evaluating the predicate and the output columns per column. */
+  bool NextBatch(VectorBatch *batch) override;
+
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
 
  private:
+  /** Moves the iterator to the next tuple and tells the prefetcher when it moves onto another page. */
+  void AdvanceIterator();
+
+  /** Reports the page of the current tuple to the prefetcher if it changed. */
+  void ReportPage();
+
+  /** @return true if there is no predicate or it holds on a tuple of the table */
+  bool MatchesPredicate(const Tuple &tuple) const;
+
+  /**
+   * Locks the tuples of the selected rows of scan_batch_ the way Next does, rereading them once locked. Drops the
+   * rows whose tuples are gone by then.
+   */
+  void LockSelected();
+
   /** The sequential scan plan node to be executed. */
   const SeqScanPlanNode *plan_;
   TableMetadata *table_info_;
   TableIterator iterator_;
+  /** The predicate compiled against the table schema, nullptr if there is none or it does not compile. */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
+  /** Reads the pages of the table ahead of iterator_, created by the first Init, nullptr if read-ahead is disabled. */
+  std::unique_ptr<PagePrefetcher> prefetcher_;
+  /** The page iterator_ was on when it was last reported to prefetcher_. */
+  page_id_t current_page_id_{INVALID_PAGE_ID};
+  /** The tuples NextBatch read off the table, in the table schema. */
+  VectorBatch scan_batch_;
 };
 }  // namespace bustub
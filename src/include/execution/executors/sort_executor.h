@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.h
+//
+// Identification: src/include/execution/executors/sort_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/sort_plan.h"
+#include "storage/table/tmp_tuple_run.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * SortExecutor orders the tuples of its child with an external merge sort.
+ *
+ * Init buffers the child's tuples until they exceed the memory budget, sorts them and spills them to temporary pages
+ * as a sorted run, then goes on with the next run. If every tuple fit into memory, they are produced from the buffer.
+ * Otherwise the runs are merged, at most budget / PAGE_SIZE of them at a time so that only a page of every run being
+ * merged is held in memory, until few enough are left to be merged while producing the tuples.
+ *
+ * When the parent only consumes the first top_n tuples, e.g. a limit, the executor keeps the top_n smallest tuples in
+ * a heap instead and never spills, unless the heap outgrows the memory budget. It then falls back to the external
+ * sort of the heap and the rest of the child, and stops after top_n tuples.
+ */
+class SortExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new sort executor.
+   * @param exec_ctx the executor context
+   * @param plan the sort plan to be executed
+   * @param child_executor the child executor that produces the tuples to sort
+   * @param top_n the number of leading tuples the parent consumes at most, std::nullopt if it may consume all
+   */
+  SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor,
+               std::optional<size_t> top_n = std::nullopt);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  /** @return the number of sorted runs spilled since Init, 0 if every tuple fit into memory */
+  size_t GetNumRuns() const { return num_runs_; }
+
+ private:
+  /** A tuple of the child and the values of the order-by expressions on it. */
+  struct SortEntry {
+    std::vector<Value> keys_;
+    Tuple tuple_;
+  };
+
+  /** The next tuple of a run being merged. */
+  struct MergeEntry {
+    SortEntry entry_;
+    /** The index of the run's reader. */
+    size_t run_;
+  };
+
+  /** @return the bytes an entry of tuple accounts for against the memory budget */
+  size_t EntrySize(const Tuple &tuple) const;
+
+  /** @return the entry of a tuple of the child */
+  SortEntry MakeEntry(Tuple &&tuple) const;
+
+  /** @return true if the keys of a sort before the keys of b */
+  bool Less(const std::vector<Value> &a, const std::vector<Value> &b) const;
+
+  /**
+   * Reads the child into the top_n heap, then sorts it.
+   * @return false if the heap outgrew the memory budget, the heap is left in entries_ and the child partly read
+   */
+  bool SortTopN();
+
+  /** Sorts the buffered entries and appends them to a new run. */
+  void SpillRun();
+
+  /**
+   * Starts merging runs, pushing the first entry of every run onto the merge heap.
+   * @param first the index of the first run in runs_ to merge
+   * @param last the index past the last run to merge
+   */
+  void StartMerge(size_t first, size_t last);
+
+  /** @param[out] entry the smallest entry of the runs being merged @return false if the runs are exhausted */
+  bool NextMerged(SortEntry *entry);
+
+  /** The sort plan node to be executed. */
+  const SortPlanNode *plan_;
+  /** The child executor that produces the tuples to sort. */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  std::optional<size_t> top_n_;
+  /** The number of tuples Next produced since Init. */
+  size_t num_produced_{0};
+
+  /** The buffered entries, and the next one to produce once every tuple fit into memory. */
+  std::vector<SortEntry> entries_;
+  size_t entry_index_{0};
+
+  /** The spilled runs, a reader per run being merged, and the next entry of every run that has one left. */
+  std::vector<std::unique_ptr<TmpTupleRun>> runs_;
+  std::vector<TmpTupleRun::Reader> readers_;
+  std::vector<MergeEntry> merge_heap_;
+  size_t num_runs_{0};
+};
+
+}  // namespace bustub
@@ -16,7 +16,9 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/vector_batch.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 /**
@@ -58,6 +60,43 @@ class AbstractExpression {
    */
   virtual Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const = 0;
 
+  /**
+   * Evaluates the expression on every selected row of a batch. The default evaluates each row as a tuple, expressions
+   * that are cheaper to evaluate column by column override it.
+   * @param batch the rows, of the schema the expression refers to
+   * @param[out] result resized to the rows of the batch, holds the value of each selected row at its row index
+   */
+  virtual void EvaluateBatch(const VectorBatch &batch, std::vector<Value> *result) const {
+    result->resize(batch.GetNumRows());
+    for (uint32_t row : batch.GetSelection()) {
+      const Tuple tuple = batch.MakeTuple(row);
+      (*result)[row] = Evaluate(&tuple, batch.GetSchema());
+    }
+  }
+
+  /**
+   * A predicate only holds where it is true: a comparison with a NULL operand is NULL, which does not hold either.
+   * @param value the value of a predicate
+   * @return true if the value is true, false if it is false or NULL
+   */
+  static bool IsTrue(const Value &value) {
+    return value.CompareEquals(ValueFactory::GetBooleanValue(true)) == CmpBool::CmpTrue;
+  }
+
+  /** Drops the selected rows of batch the expression is false or NULL on. */
+  void SelectBatch(VectorBatch *batch) const {
+    std::vector<Value> result;
+    EvaluateBatch(*batch, &result);
+    auto *selection = batch->MutableSelection();
+    size_t count = 0;
+    for (uint32_t row : *selection) {
+      if (IsTrue(result[row])) {
+        (*selection)[count++] = row;
+      }
+    }
+    selection->resize(count);
+  }
+
   /** @return the child_idx'th child of this expression */
   const AbstractExpression *GetChildAt(uint32_t child_idx) const { return children_[child_idx]; }
 
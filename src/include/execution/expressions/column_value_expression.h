@@ -35,6 +35,14 @@ class ColumnValueExpression : public AbstractExpression {
 
   Value Evaluate(const Tuple *tuple, const Schema *schema) const override { return tuple->GetValue(schema, col_idx_); }
 
+  void EvaluateBatch(const VectorBatch &batch, std::vector<Value> *result) const override {
+    const std::vector<Value> &column = batch.GetColumn(col_idx_);
+    result->resize(batch.GetNumRows());
+    for (uint32_t row : batch.GetSelection()) {
+      (*result)[row] = column[row];
+    }
+  }
+
   Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
                      const Schema *right_schema) const override {
     return tuple_idx_ == 0 ? left_tuple->GetValue(left_schema, col_idx_)
@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_predicate.h
+//
+// Identification: src/include/execution/expressions/compiled_predicate.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/tuple.h"
+#include "type/type.h"
+
+namespace bustub {
+
+/**
+ * CompiledPredicate is a comparison of two columns or constants lowered into a single comparison function, which is
+ * instantiated for the types of both operands and the operator. It reads the operands straight from the tuple data,
+ * without virtual calls or building a Value per node.
+ *
+ * Only comparisons between fixed-width types compile: the integer types and DECIMAL with each other, BOOLEAN with
+ * BOOLEAN and TIMESTAMP with TIMESTAMP. A comparison with a NULL operand is CmpNull, which Evaluate treats as false.
+ */
+class CompiledPredicate {
+ public:
+  /**
+   * Compiles a predicate.
+   * @param expr the predicate
+   * @param left_schema the schema of the tuple, or of the left tuple of a join
+   * @param right_schema the schema of the right tuple of a join, nullptr if the predicate is not on a join
+   * @return the compiled predicate, nullptr if expr is not a comparison of columns and constants of fixed-width types
+   */
+  static std::unique_ptr<CompiledPredicate> Compile(const AbstractExpression *expr, const Schema *left_schema,
+                                                    const Schema *right_schema = nullptr);
+
+  /** @return true if the predicate holds on a tuple of the left schema */
+  bool Evaluate(const Tuple *tuple) const { return EvaluateJoin(tuple, tuple); }
+
+  /** @return true if the predicate holds on a tuple of the left and one of the right schema */
+  bool EvaluateJoin(const Tuple *left_tuple, const Tuple *right_tuple) const {
+    return compare_(lhs_.Data(left_tuple, right_tuple), rhs_.Data(left_tuple, right_tuple)) == CmpBool::CmpTrue;
+  }
+
+  /** Compares the raw values of two operands. */
+  using CompareFunction = CmpBool (*)(const char *lhs, const char *rhs);
+
+ private:
+  /** A column of either tuple, or a constant held inline. */
+  struct Operand {
+    /** @return the bytes of the operand's value */
+    const char *Data(const Tuple *left_tuple, const Tuple *right_tuple) const {
+      if (is_constant_) {
+        return constant_;
+      }
+      return (tuple_idx_ == 0 ? left_tuple : right_tuple)->GetData() + offset_;
+    }
+
+    bool is_constant_{false};
+    uint32_t tuple_idx_{0};
+    uint32_t offset_{0};
+    /** Large enough for every fixed-width type. */
+    char constant_[sizeof(uint64_t)]{};
+  };
+
+  /** Lowers a column or constant expression. @return false if it is neither or its type is not fixed-width */
+  static bool CompileOperand(const AbstractExpression *expr, const Schema *left_schema, const Schema *right_schema,
+                             Operand *operand, TypeId *type);
+
+  CompareFunction compare_{nullptr};
+  Operand lhs_;
+  Operand rhs_;
+};
+
+}  // namespace bustub
@@ -27,6 +27,10 @@ class ConstantValueExpression : public AbstractExpression {
 
   Value Evaluate(const Tuple *tuple, const Schema *schema) const override { return val_; }
 
+  void EvaluateBatch(const VectorBatch &batch, std::vector<Value> *result) const override {
+    result->assign(batch.GetNumRows(), val_);
+  }
+
   Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
                      const Schema *right_schema) const override {
     return val_;
@@ -15,6 +15,7 @@
 #include <utility>
 #include <vector>
 
+#include "common/config.h"
 #include "common/util/hash_util.h"
 #include "execution/plans/abstract_plan.h"
 #include "storage/table/tuple.h"
@@ -39,15 +40,20 @@ class AggregationPlanNode : public AbstractPlanNode {
    * @param group_bys the group by clause of the aggregation
    * @param aggregates the expressions that we are aggregating
    * @param agg_types the types that we are aggregating
+   * @param num_threads the number of threads aggregating the child's tuples, 1 to aggregate on the calling thread
+   * @param memory_budget bytes of groups the aggregation may hold in memory before it spills to temporary pages
    */
   AggregationPlanNode(const Schema *output_schema, const AbstractPlanNode *child, const AbstractExpression *having,
                       std::vector<const AbstractExpression *> &&group_bys,
-                      std::vector<const AbstractExpression *> &&aggregates, std::vector<AggregationType> &&agg_types)
+                      std::vector<const AbstractExpression *> &&aggregates, std::vector<AggregationType> &&agg_types,
+                      size_t num_threads = AGGREGATION_THREADS, size_t memory_budget = EXECUTOR_MEMORY_BUDGET)
       : AbstractPlanNode(output_schema, {child}),
         having_(having),
         group_bys_(std::move(group_bys)),
         aggregates_(std::move(aggregates)),
-        agg_types_(std::move(agg_types)) {}
+        agg_types_(std::move(agg_types)),
+        num_threads_(num_threads),
+        memory_budget_(memory_budget) {}
 
   PlanType GetType() const override { return PlanType::Aggregation; }
 
@@ -75,11 +81,19 @@ class AggregationPlanNode : public AbstractPlanNode {
   /** @return the aggregate types */
   const std::vector<AggregationType> &GetAggregateTypes() const { return agg_types_; }
 
+  /** @return the number of threads aggregating the child's tuples */
+  size_t GetNumThreads() const { return num_threads_; }
+
+  /** @return bytes of groups the aggregation may hold in memory */
+  size_t GetMemoryBudget() const { return memory_budget_; }
+
  private:
   const AbstractExpression *having_;
   std::vector<const AbstractExpression *> group_bys_;
   std::vector<const AbstractExpression *> aggregates_;
   std::vector<AggregationType> agg_types_;
+  size_t num_threads_;
+  size_t memory_budget_;
 };
 
 struct AggregateKey {
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_join_plan.h
+//
+// Identification: src/include/execution/plans/hash_join_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/**
+ * HashJoinPlanNode joins the tuples of two children whose join keys are equal, i.e. an equi-join
+ * left_keys[0] = right_keys[0] AND left_keys[1] = right_keys[1] AND ... AND predicate.
+ */
+class HashJoinPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new hash join plan node.
+   * @param output_schema the output format of this hash join node
+   * @param children the left and the right child plan, either side may be the larger one
+   * @param left_keys the join key expressions, evaluated on the tuples of the left child
+   * @param right_keys the join key expressions, evaluated on the tuples of the right child
+   * @param predicate an additional join predicate on the pairs of tuples with equal keys, nullptr for none
+   * @param memory_budget bytes of tuples the join may hold in memory before it spills to temporary pages
+   */
+  HashJoinPlanNode(const Schema *output_schema, std::vector<const AbstractPlanNode *> &&children,
+                   std::vector<const AbstractExpression *> &&left_keys,
+                   std::vector<const AbstractExpression *> &&right_keys, const AbstractExpression *predicate = nullptr,
+                   size_t memory_budget = EXECUTOR_MEMORY_BUDGET)
+      : AbstractPlanNode(output_schema, std::move(children)),
+        left_keys_(std::move(left_keys)),
+        right_keys_(std::move(right_keys)),
+        predicate_(predicate),
+        memory_budget_(memory_budget) {
+    BUSTUB_ASSERT(left_keys_.size() == right_keys_.size(), "Both sides of a hash join need as many keys.");
+  }
+
+  PlanType GetType() const override { return PlanType::HashJoin; }
+
+  /** @return the join key expressions of the left side */
+  const std::vector<const AbstractExpression *> &GetLeftKeys() const { return left_keys_; }
+
+  /** @return the join key expressions of the right side */
+  const std::vector<const AbstractExpression *> &GetRightKeys() const { return right_keys_; }
+
+  /** @return the additional join predicate, nullptr if there is none */
+  const AbstractExpression *Predicate() const { return predicate_; }
+
+  /** @return bytes of tuples the join may hold in memory */
+  size_t GetMemoryBudget() const { return memory_budget_; }
+
+  /** @return the left plan node of the hash join */
+  const AbstractPlanNode *GetLeftPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 2, "Hash joins should have exactly two children plans.");
+    return GetChildAt(0);
+  }
+
+  /** @return the right plan node of the hash join */
+  const AbstractPlanNode *GetRightPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 2, "Hash joins should have exactly two children plans.");
+    return GetChildAt(1);
+  }
+
+ private:
+  std::vector<const AbstractExpression *> left_keys_;
+  std::vector<const AbstractExpression *> right_keys_;
+  const AbstractExpression *predicate_;
+  size_t memory_budget_;
+};
+
+/** The join key of a tuple. Keys holding a NULL never match. */
+struct HashJoinKey {
+  std::vector<Value> keys_;
+
+  /** @return true if both keys are equal in every column */
+  bool operator==(const HashJoinKey &other) const {
+    for (uint32_t i = 0; i < other.keys_.size(); i++) {
+      if (keys_[i].CompareEquals(other.keys_[i]) != CmpBool::CmpTrue) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+}  // namespace bustub
+
+namespace std {
+
+/**
+ * Implements std::hash on HashJoinKey.
+ */
+template <>
+struct hash<bustub::HashJoinKey> {
+  std::size_t operator()(const bustub::HashJoinKey &join_key) const {
+    size_t curr_hash = 0;
+    for (const auto &key : join_key.keys_) {
+      if (!key.IsNull()) {
+        curr_hash = bustub::HashUtil::CombineHashes(curr_hash, bustub::HashUtil::HashValue(&key));
+      }
+    }
+    return curr_hash;
+  }
+};
+
+}  // namespace std
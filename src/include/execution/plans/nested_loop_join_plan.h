@@ -31,16 +31,21 @@ class NestedLoopJoinPlanNode : public AbstractPlanNode {
    * @param children two sequential scan children plans
    * @param predicate the predicate to join with, the tuples are joined if predicate(tuple) = true or predicate =
    * nullptr
+   * @param block_pages number of buffer pool pages the outer tuples are buffered in, the inner side is scanned once per
+   * block of outer tuples; 0 to scan it once per outer tuple
    */
   NestedLoopJoinPlanNode(const Schema *output_schema, std::vector<const AbstractPlanNode *> &&children,
-                         const AbstractExpression *predicate)
-      : AbstractPlanNode(output_schema, std::move(children)), predicate_(predicate) {}
+                         const AbstractExpression *predicate, size_t block_pages = 0)
+      : AbstractPlanNode(output_schema, std::move(children)), predicate_(predicate), block_pages_(block_pages) {}
 
   PlanType GetType() const override { return PlanType::NestedLoopJoin; }
 
   /** @return the predicate to be used in the nested loop join */
   const AbstractExpression *Predicate() const { return predicate_; }
 
+  /** @return the number of pages outer tuples are buffered in, 0 for a tuple-at-a-time nested loop join */
+  size_t GetBlockPages() const { return block_pages_; }
+
   /** @return the left plan node of the nested loop join, by convention it should be the smaller table*/
   const AbstractPlanNode *GetLeftPlan() const {
     BUSTUB_ASSERT(GetChildren().size() == 2, "Nested loop joins should have exactly two children plans.");
@@ -56,6 +61,8 @@ class NestedLoopJoinPlanNode : public AbstractPlanNode {
  private:
   /** The join predicate. */
   const AbstractExpression *predicate_;
+  /** The number of pages a block of outer tuples takes up. */
+  size_t block_pages_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_plan.h
+//
+// Identification: src/include/execution/plans/sort_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/** OrderByType is the direction the tuples are sorted in by an order-by expression. */
+enum class OrderByType { Asc, Desc };
+
+/**
+ * SortPlanNode orders the tuples of its child by a list of expressions, i.e. ORDER BY. NULLs sort before every other
+ * value in ascending and after every other value in descending order.
+ */
+class SortPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new sort plan node.
+   * @param output_schema the output format of this sort node, its columns are evaluated on the child's tuples
+   * @param child the child plan to sort the tuples of
+   * @param order_bys the directions and the expressions to sort by, evaluated on the child's tuples
+   * @param memory_budget bytes of tuples the sort may hold in memory before it spills sorted runs to temporary pages
+   */
+  SortPlanNode(const Schema *output_schema, const AbstractPlanNode *child,
+               std::vector<std::pair<OrderByType, const AbstractExpression *>> &&order_bys,
+               size_t memory_budget = EXECUTOR_MEMORY_BUDGET)
+      : AbstractPlanNode(output_schema, {child}), order_bys_(std::move(order_bys)), memory_budget_(memory_budget) {}
+
+  PlanType GetType() const override { return PlanType::Sort; }
+
+  /** @return the child plan whose tuples are sorted */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Sort should have exactly one child plan.");
+    return GetChildAt(0);
+  }
+
+  /** @return the directions and the expressions to sort by */
+  const std::vector<std::pair<OrderByType, const AbstractExpression *>> &GetOrderBys() const { return order_bys_; }
+
+  /** @return bytes of tuples the sort may hold in memory */
+  size_t GetMemoryBudget() const { return memory_budget_; }
+
+ private:
+  std::vector<std::pair<OrderByType, const AbstractExpression *>> order_bys_;
+  size_t memory_budget_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// vector_batch.h
+//
+// Identification: src/include/execution/vector_batch.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * VectorBatch holds up to VECTOR_BATCH_SIZE rows of a schema column by column, the unit AbstractExecutor::NextBatch
+ * passes between executors.
+ *
+ * Rows are addressed by their index in the columns. Only the rows in the selection vector are part of the batch, a
+ * filter drops rows by removing them from the selection instead of moving the values of the others. The selection is
+ * in ascending row order. Columns keep their capacity across Reset, so a batch reused by an executor allocates only
+ * for the values themselves.
+ */
+class VectorBatch {
+ public:
+  VectorBatch() = default;
+
+  /** Creates an empty batch of rows of schema. */
+  explicit VectorBatch(const Schema *schema) { Reset(schema); }
+
+  /** Drops all rows and makes the batch hold rows of schema. */
+  void Reset(const Schema *schema);
+
+  /** @return the schema of the rows */
+  const Schema *GetSchema() const { return schema_; }
+
+  /** @return the number of rows in the columns, selected or not */
+  uint32_t GetNumRows() const { return num_rows_; }
+
+  /** @return the number of selected rows */
+  uint32_t GetNumSelected() const { return static_cast<uint32_t>(selection_.size()); }
+
+  /** @return true if no further row can be appended */
+  bool IsFull() const { return num_rows_ >= static_cast<uint32_t>(VECTOR_BATCH_SIZE); }
+
+  /** @return the indexes of the selected rows, ascending */
+  const std::vector<uint32_t> &GetSelection() const { return selection_; }
+
+  /** @return the selection, to drop rows from. It must stay ascending and only hold rows below GetNumRows(). */
+  std::vector<uint32_t> *MutableSelection() { return &selection_; }
+
+  /** @return the values of column col_idx, one per row */
+  const std::vector<Value> &GetColumn(uint32_t col_idx) const { return columns_[col_idx]; }
+
+  /** @return the values of column col_idx, one per row */
+  std::vector<Value> *MutableColumn(uint32_t col_idx) { return &columns_[col_idx]; }
+
+  /** @return the value of column col_idx in row */
+  const Value &GetValue(uint32_t row, uint32_t col_idx) const { return columns_[col_idx][row]; }
+
+  /** @return the RID of row, invalid if the row does not come from a table */
+  const RID &GetRid(uint32_t row) const { return rids_[row]; }
+
+  /** Appends a selected row holding the columns of a tuple of the batch's schema. */
+  void AppendTuple(const Tuple &tuple, const RID &rid);
+
+  /** Appends a selected row holding values, one per column. */
+  void AppendRow(const std::vector<Value> &values, const RID &rid = RID());
+
+  /** Replaces the values of row by the columns of a tuple of the batch's schema. */
+  void SetRow(uint32_t row, const Tuple &tuple);
+
+  /**
+   * Makes the batch hold as many rows as input with the same selection and RIDs, each column the value of the
+   * expression of the schema's column on the rows of input.
+   * @param input the rows to project, of the schema the column expressions refer to
+   */
+  void Project(const VectorBatch &input);
+
+  /** @return row as a tuple of the batch's schema */
+  Tuple MakeTuple(uint32_t row) const;
+
+ private:
+  const Schema *schema_{nullptr};
+  uint32_t num_rows_{0};
+  std::vector<std::vector<Value>> columns_;
+  std::vector<RID> rids_;
+  std::vector<uint32_t> selection_;
+};
+
+}  // namespace bustub
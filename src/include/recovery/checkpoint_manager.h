@@ -12,6 +12,10 @@
 
 #pragma once
 
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction_manager.h"
 #include "recovery/log_manager.h"
@@ -19,7 +23,14 @@
 namespace bustub {
 
 /**
- * CheckpointManager creates consistent checkpoints by blocking all other transactions temporarily.
+ * CheckpointManager takes fuzzy checkpoints, transactions keep running while a checkpoint is taken.
+ *
+ * BeginCheckpoint logs a BEGIN_CHECKPOINT record and starts writing back the pages that are dirty at that point in
+ * the background. EndCheckpoint waits for the write-back, logs an END_CHECKPOINT record with the active transaction
+ * table and the dirty page table, and points the master record at the checkpoint once that record is persistent.
+ * Recovery then redoes the log from the oldest recLSN of the dirty page table (or the checkpoint, if that is older),
+ * and reads it from the first record of the oldest active transaction. Both are bounded by the time between two
+ * checkpoints, as the write-back leaves few pages with an older recLSN behind.
  */
 class CheckpointManager {
  public:
@@ -29,15 +40,23 @@ class CheckpointManager {
         log_manager_(log_manager),
         buffer_pool_manager_(buffer_pool_manager) {}
 
-  ~CheckpointManager() = default;
+  ~CheckpointManager();
 
+  /** Logs the start of a checkpoint and starts writing back the dirty pages, without waiting for the writes. */
   void BeginCheckpoint();
+
+  /** Waits for the write-back, logs the end of the checkpoint and makes the checkpoint the one recovery starts at. */
   void EndCheckpoint();
 
  private:
-  TransactionManager *transaction_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  TransactionManager *transaction_manager_;
+  LogManager *log_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+
+  /** LSN of the BEGIN_CHECKPOINT record of the checkpoint in progress. */
+  lsn_t begin_lsn_{INVALID_LSN};
+  /** Writes back the pages that were dirty when the checkpoint began. */
+  std::thread page_writer_;
 };
 
 }  // namespace bustub
@@ -14,31 +14,70 @@
 
 #include <algorithm>
 #include <condition_variable>  // NOLINT
-#include <future>              // NOLINT
-#include <mutex>               // NOLINT
-
+#include <deque>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "common/metrics.h"
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
+/**
+ * Statistics of a log manager, see LogManager::GetStats.
+ */
+struct LogManagerStats {
+  /** Log records appended. */
+  uint64_t records_appended_{0};
+  /** Bytes of log records appended. */
+  uint64_t bytes_appended_{0};
+  /** Writes of the log buffer to the log file, every one of them synced. */
+  uint64_t flushes_{0};
+  /** Bytes written per flush. */
+  HistogramSnapshot flush_bytes_;
+  /** Log records written per flush, i.e. the size of a commit group. */
+  HistogramSnapshot flush_records_;
+  /** Time a flush takes to write and sync the log file. */
+  HistogramSnapshot sync_latency_;
+  /** Time Flush callers, committing transactions above all, wait until their records are persistent. */
+  HistogramSnapshot flush_wait_;
+
+  /** @return the counters and the histograms on one line */
+  std::string ToString() const;
+};
+
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * The log buffer is a ring. AppendLogRecord reserves an LSN and the bytes of its record with a single fetch_add and
+ * serializes the record into its slot without taking a latch, so threads append in parallel. Once a record is in
+ * place its size is published in a completion slot indexed by LSN; the flusher only writes out the prefix of the ring
+ * in which every record is complete, while appenders keep filling the rest of the ring.
+ *
+ * Threads that need their records on disk (committing transactions, the buffer pool writing back a page) wake the
+ * flush thread up and wait. Every record appended while a write is in progress is covered by the next write, so one
+ * sync serves a whole group of commits.
  */
 class LogManager {
  public:
-  explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
-  }
+  /**
+   * @param disk_manager the disk manager the log is written through
+   * @param log_buffer_size size of the log buffer in bytes, i.e. of the largest record that can be appended. The ring
+   * holds at least two log buffers, so that appenders fill one while the other is written.
+   */
+  explicit LogManager(DiskManager *disk_manager, int log_buffer_size = LOG_BUFFER_SIZE);
 
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
-    delete[] flush_buffer_;
+    delete[] record_sizes_;
     log_buffer_ = nullptr;
-    flush_buffer_ = nullptr;
+    record_sizes_ = nullptr;
   }
 
   void RunFlushThread();
@@ -46,29 +85,141 @@ class LogManager {
 
   lsn_t AppendLogRecord(LogRecord *log_record);
 
-  inline lsn_t GetNextLSN() { return next_lsn_; }
+  /**
+   * Blocks until every log record up to and including lsn is persistent, waking the flush thread up if needed.
+   * @param lsn the log sequence number that has to be persistent
+   * @throws Exception if a write of the log failed before lsn became persistent
+   */
+  void Flush(lsn_t lsn);
+
+  /**
+   * Looks up where a persistent log record is in the log file. Only the first record of every write is indexed, so
+   * the offset is that of a record at or before lsn, and reading the log from there reaches lsn.
+   * @param lsn a persistent log sequence number, INVALID_LSN for the start of the log
+   * @return offset of a record boundary at or before the record lsn in the log file
+   */
+  log_offset_t GetLogOffset(lsn_t lsn);
+
+  /**
+   * Drops the part of the log recovery no longer needs: the log segments before the one holding lsn, and the index
+   * entries GetLogOffset no longer needs, since nobody will look up an LSN below lsn again.
+   * @param lsn the oldest LSN recovery needs, it has to be persistent
+   */
+  void TruncateLog(lsn_t lsn);
+
+  /**
+   * Points the master record at a checkpoint, so that recovery starts at it.
+   * @param checkpoint_lsn LSN of the persistent BEGIN_CHECKPOINT record of a complete checkpoint
+   */
+  void WriteMasterRecord(lsn_t checkpoint_lsn) {
+    disk_manager_->WriteMasterRecord(checkpoint_lsn, GetLogOffset(checkpoint_lsn));
+  }
+
+  /** @return the statistics of this log manager since construction or the last ResetStats */
+  LogManagerStats GetStats() const;
+
+  /** Drops the statistics collected so far. */
+  void ResetStats();
+
+  /**
+   * Continues the LSNs after the records an earlier run left in the log, see LogRecovery. Everything before lsn counts
+   * as persistent. Only allowed before the first record is appended.
+   * @param lsn the LSN of the next record
+   */
+  void SetNextLSN(lsn_t lsn);
+
+  inline lsn_t GetNextLSN() { return static_cast<lsn_t>(reservation_.load() & LSN_MASK); }
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline char *GetLogBuffer() { return log_buffer_; }
+  /** @return the size of the log buffer, records larger than that cannot be appended */
+  inline int GetLogBufferSize() const { return log_buffer_size_; }
 
  private:
-  // TODO(students): you may add your own member variables
-
-  /** The atomic counter which records the next log sequence number. */
-  std::atomic<lsn_t> next_lsn_;
+  /** reservation_ holds the next LSN in its low 32 bits and the next ring position in its high 32 bits. */
+  static constexpr uint64_t LSN_MASK = 0xffffffff;
+  static constexpr int POSITION_SHIFT = 32;
+
+  /**
+   * Writes out the complete records that have not been written yet, without holding latch_ during the write.
+   * Waits for a write in progress first, so there is only ever one.
+   * @param lock lock on latch_, held on entry and on return
+   * @return false if there was nothing complete to write, or the write failed
+   */
+  bool FlushBuffer(std::unique_lock<std::mutex> *lock);
+
+  /** Body of the flush thread. */
+  void FlushLoop();
+
+  /**
+   * Waits until the ring has room for the bytes [position, position + size), flushing if needed.
+   * @param position ring position reserved for a record
+   * @param size size of the record
+   * @throws Exception if a write of the log failed, the ring then never drains
+   */
+  void WaitForSpace(uint32_t position, int32_t size);
+
+  /**
+   * Serializes a log record in the format described in log_record.h.
+   * @param log_record the record, its LSN already assigned
+   * @param[out] data where to write the record, at least log_record->GetSize() bytes
+   */
+  static void SerializeLogRecord(LogRecord *log_record, char *data);
+
+  /** Size of the log buffer, the largest record that can be appended. */
+  const int log_buffer_size_;
+  /** Size of the ring, two log buffers at least. A power of two, so that positions can wrap around at 2^32. */
+  const uint32_t ring_size_;
+  /** Number of completion slots. Every slot is flushed before it is reused, since records take up HEADER_SIZE bytes. */
+  const uint32_t num_slots_;
+
+  /** Next LSN and next ring position, reserved together, see LSN_MASK. */
+  std::atomic<uint64_t> reservation_{0};
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
+  /**
+   * Ring position up to which records have been written to disk, appenders may fill the ring up to here + ring_size_.
+   */
+  std::atomic<uint32_t> flushed_position_{0};
 
+  /** The ring, followed by room for a record that wraps around. */
   char *log_buffer_;
-  char *flush_buffer_;
-
+  /** Size of every complete record that has not been flushed yet, indexed by LSN % num_slots_, 0 otherwise. */
+  std::atomic<int32_t> *record_sizes_;
+  /** First LSN and log file offset of every write since the last TruncateLog, in LSN order. */
+  std::deque<std::pair<lsn_t, log_offset_t>> log_offsets_;
+  /** Log file offset of flushed_position_. Ring positions wrap around at 2^32, log offsets do not. */
+  log_offset_t flushed_offset_;
+  /** LSN of the first record that has not been written yet, owned by whoever is flushing. */
+  lsn_t flush_lsn_{0};
+  /** True while a flush is writing. */
+  bool flushing_{false};
+  /** True if some thread waits for the log, the flush thread then flushes without waiting for the timeout. */
+  bool flush_requested_{false};
+  /** True once a write of the log failed. Nothing is flushed anymore, and waiting for the log throws. */
+  bool write_failed_{false};
+  /** True while the flush thread should keep running. */
+  bool running_{false};
+
+  /** Protects the flags above and log_offsets_, and serializes flushes. Appending a record does not take it. */
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread flush_thread_;
 
+  /** Wakes up the flush thread. */
   std::condition_variable cv_;
-
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Signalled whenever a flush completes. */
+  std::condition_variable flushed_cv_;
+
+  DiskManager *disk_manager_;
+
+  /** Statistics, see LogManagerStats. */
+  ShardedCounter num_records_appended_;
+  ShardedCounter num_bytes_appended_;
+  LatencyHistogram flush_bytes_;
+  LatencyHistogram flush_records_;
+  LatencyHistogram sync_latency_;
+  LatencyHistogram flush_wait_;
 };
 
 }  // namespace bustub
@@ -14,6 +14,8 @@
 
 #include <cassert>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/table/tuple.h"
@@ -32,6 +34,12 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** Start of a fuzzy checkpoint, see CheckpointManager. */
+  BEGIN_CHECKPOINT,
+  /** End of a fuzzy checkpoint, carrying the active transaction and dirty page tables. */
+  END_CHECKPOINT,
+  /** Compensation of a change recovery rolled back, see LogRecord::MakeCompensation. */
+  CLR,
 };
 
 /**
@@ -49,16 +57,34 @@ enum class LogRecordType {
  *----------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
  *---------------------------------------------------------------
- * For update type log record
- *-----------------------------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
- *-----------------------------------------------------------------------------------
+ * For update type log record, only the byte ranges in which the old and the new tuple differ. Every field after the
+ * HEADER is a varint (7 bits per byte, the high bit set on all but the last byte).
+ *------------------------------------------------------------------------------------------------------------
+ * | HEADER | page_id | slot_num | old_size | new_size | num_ranges | (gap, length, old_bytes, new_bytes) ... |
+ *------------------------------------------------------------------------------------------------------------
+ * gap is the distance from the end of the previous range (from 0 for the first one). A range past the end of the
+ * shorter tuple only carries the bytes of the longer one, so old_bytes and new_bytes are the parts of the range that
+ * lie within old_size and within new_size.
  * For new page type log record
  *--------------------------
  * | HEADER | prev_page_id |
  *--------------------------
+ * For begin checkpoint type log record
+ *----------
+ * | HEADER |
+ *----------
+ * For end checkpoint type log record, prevLSN is the LSN of the matching begin checkpoint record
+ *--------------------------------------------------------------------------------------------------
+ * | HEADER | log_offset | num_txns | (txn_id, first_lsn) ... | num_pages | (page_id, rec_lsn) ... |
+ *--------------------------------------------------------------------------------------------------
+ * For compensation log record, the change undoing a change of a loser transaction in any of the formats above but
+ * BEGIN, COMMIT, ABORT and the checkpoints. undo_next_lsn is the prevLSN of the record it undoes.
+ *-------------------------------------------------------------------------------------
+ * | HEADER | undo_next_lsn | compensated_type | the compensating record after its HEADER |
+ *-------------------------------------------------------------------------------------
  */
 class LogRecord {
+  friend class CheckpointManager;
   friend class LogManager;
   friend class LogRecovery;
 
@@ -85,18 +111,9 @@ class LogRecord {
     size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
   }
 
-  // constructor for UPDATE type
+  // constructor for UPDATE type, see the record format above
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &update_rid,
-            const Tuple &old_tuple, const Tuple &new_tuple)
-      : txn_id_(txn_id),
-        prev_lsn_(prev_lsn),
-        log_record_type_(log_record_type),
-        update_rid_(update_rid),
-        old_tuple_(old_tuple),
-        new_tuple_(new_tuple) {
-    // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
-  }
+            const Tuple &old_tuple, const Tuple &new_tuple);
 
   // constructor for NEWPAGE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t prev_page_id, page_id_t page_id)
@@ -110,8 +127,39 @@ class LogRecord {
     size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
   }
 
+  // constructor for END_CHECKPOINT type
+  LogRecord(lsn_t begin_checkpoint_lsn, log_offset_t log_offset, std::vector<std::pair<txn_id_t, lsn_t>> active_txns,
+            std::vector<std::pair<page_id_t, lsn_t>> dirty_pages)
+      : prev_lsn_(begin_checkpoint_lsn),
+        log_record_type_(LogRecordType::END_CHECKPOINT),
+        log_offset_(log_offset),
+        active_txns_(std::move(active_txns)),
+        dirty_pages_(std::move(dirty_pages)) {
+    // calculate log record size, header size + log offset + both tables with their lengths
+    size_ = HEADER_SIZE + sizeof(log_offset_t) + 2 * sizeof(int32_t) + active_txns_.size() * sizeof(int32_t) * 2 +
+            dirty_pages_.size() * sizeof(int32_t) * 2;
+  }
+
   ~LogRecord() = default;
 
+  /**
+   * Turns a record of a change into the CLR of a change recovery rolled back, redone like the change but never undone.
+   * @param undo_next_lsn the prevLSN of the record that has been undone, undo goes on from there after a crash
+   */
+  void MakeCompensation(lsn_t undo_next_lsn) {
+    undo_next_lsn_ = undo_next_lsn;
+    compensated_type_ = log_record_type_;
+    log_record_type_ = LogRecordType::CLR;
+    size_ += sizeof(lsn_t) + sizeof(LogRecordType);
+  }
+
+  /** @return the type of the change the record redoes, that of the compensating change for a CLR */
+  LogRecordType GetRedoType() const {
+    return log_record_type_ == LogRecordType::CLR ? compensated_type_ : log_record_type_;
+  }
+
+  inline lsn_t GetUndoNextLSN() { return undo_next_lsn_; }
+
   inline Tuple &GetDeleteTuple() { return delete_tuple_; }
 
   inline RID &GetDeleteRID() { return delete_rid_; }
@@ -120,14 +168,25 @@ class LogRecord {
 
   inline RID &GetInsertRID() { return insert_rid_; }
 
-  inline Tuple &GetOriginalTuple() { return old_tuple_; }
-
-  inline Tuple &GetUpdateTuple() { return new_tuple_; }
-
   inline RID &GetUpdateRID() { return update_rid_; }
 
+  /**
+   * Rebuilds one side of an UPDATE from the other one.
+   * @param tuple the tuple before the update to redo it, the tuple after the update to undo it
+   * @param redo true to rebuild the tuple after the update, false to rebuild the tuple before it
+   * @param[out] result the rebuilt tuple
+   * @return false if tuple cannot be the one the update started from (or ended with)
+   */
+  bool ApplyUpdate(const Tuple &tuple, bool redo, Tuple *result) const;
+
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  inline log_offset_t GetCheckpointLogOffset() { return log_offset_; }
+
+  inline std::vector<std::pair<txn_id_t, lsn_t>> &GetCheckpointActiveTxns() { return active_txns_; }
+
+  inline std::vector<std::pair<page_id_t, lsn_t>> &GetCheckpointDirtyPages() { return dirty_pages_; }
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -152,6 +211,21 @@ class LogRecord {
   }
 
  private:
+  /**
+   * Writes the part of an UPDATE record after the HEADER.
+   * @param[out] data where to write it, nullptr to only compute its size
+   * @return the number of bytes
+   */
+  int SerializeUpdate(char *data) const;
+
+  /**
+   * Reads the part of an UPDATE record after the HEADER.
+   * @param data the part after the HEADER
+   * @param size its size
+   * @return false if it is malformed
+   */
+  bool DeserializeUpdate(const char *data, int size);
+
   // the length of log record(for serialization, in bytes)
   int32_t size_{0};
   // must have fields
@@ -168,14 +242,27 @@ class LogRecord {
   RID insert_rid_;
   Tuple insert_tuple_;
 
-  // case3: for update operation
+  // case3: for update operation, the (offset, length) of every byte range in which the tuples differ and the bytes
+  // of all ranges within each tuple, back to back
   RID update_rid_;
-  Tuple old_tuple_;
-  Tuple new_tuple_;
+  uint32_t update_old_size_{0};
+  uint32_t update_new_size_{0};
+  std::vector<std::pair<uint32_t, uint32_t>> update_ranges_;
+  std::string update_old_bytes_;
+  std::string update_new_bytes_;
 
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
+
+  // case5: for end checkpoint, where recovery starts reading the log and the tables it needs
+  log_offset_t log_offset_{0};
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns_;
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages_;
+
+  // case6: for compensation, where undo goes on and the type of the compensating change
+  lsn_t undo_next_lsn_{INVALID_LSN};
+  LogRecordType compensated_type_{LogRecordType::INVALID};
   static const int HEADER_SIZE = 20;
 };  // namespace bustub
 
@@ -13,24 +13,43 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
+#include "recovery/log_manager.h"
 #include "recovery/log_record.h"
+#include "storage/page/table_page.h"
 
 namespace bustub {
 
 /**
  * Read log file from disk, redo and undo.
+ *
+ * Redo reads the log once from the last checkpoint, see CheckpointManager, and hands every record the checkpoint does
+ * not cover to the worker owning its page: pages are partitioned over the workers by page id, and a worker applies
+ * the records of its pages in LSN order, skipping those the page already reflects. The records of transactions still
+ * active at the end of the log are kept in memory, and undo rolls those transactions back in parallel, one
+ * transaction per worker at a time.
+ *
+ * With a LogManager, redo continues its LSNs after the last record in the log, and undo logs a CLR per change it rolls
+ * back and an ABORT record per transaction, so that a crash during or after recovery neither redoes new changes below
+ * an older page LSN nor undoes a change twice. Transaction ids have to continue after GetMaxTxnId().
  */
 class LogRecovery {
  public:
-  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
-      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-  }
+  /**
+   * @param log_manager the log manager of the restarted system, nullptr to neither continue nor write the log
+   * @param num_workers number of threads redo and undo run on, 0 for one per hardware thread. It is capped so that
+   * the workers can never pin the whole buffer pool.
+   * @param log_buffer_size size of the buffer the log is read into, at least the log buffer size of the LogManager
+   * that wrote the log
+   */
+  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, LogManager *log_manager = nullptr,
+              size_t num_workers = 0, int log_buffer_size = LOG_BUFFER_SIZE);
 
   ~LogRecovery() {
     delete[] log_buffer_;
@@ -41,16 +60,71 @@ class LogRecovery {
   void Undo();
   bool DeserializeLogRecord(const char *data, LogRecord *log_record);
 
+  /** @return the number of threads redo and undo run on */
+  size_t GetNumWorkers() const { return num_workers_; }
+
+  /** @return the largest LSN redo has read, INVALID_LSN if the log is empty */
+  lsn_t GetMaxLSN() const { return max_lsn_; }
+
+  /** @return the largest transaction id redo has read, INVALID_TXN_ID if there is none */
+  txn_id_t GetMaxTxnId() const { return max_txn_id_; }
+
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** Number of records the log reader hands to a redo worker at once. */
+  static constexpr size_t REDO_BATCH_SIZE = 256;
+
+  /** A log record to redo on one page. A NEWPAGE record is redone on the new page and on the page linked to it. */
+  struct RedoTask {
+    page_id_t page_id_;
+    LogRecord log_record_;
+  };
+  class RedoQueue;
+
+  /**
+   * Reads the log from offset on, log_buffer_size_ bytes at a time, and hands every record to visit, until visit
+   * returns false or the log ends.
+   * @param offset where to start reading, the offset of a record in the log file
+   * @param visit called with every record in log order
+   */
+  void ScanLog(log_offset_t offset, const std::function<bool(LogRecord *)> &visit);
+
+  /**
+   * Looks up the checkpoint the master record points at.
+   * @param[out] scan_offset where to start reading the log, at or before the first record recovery needs
+   * @param[out] redo_lsn the LSN from which on records have to be redone
+   * @return false if there is no complete checkpoint, the whole log has to be read and redone then
+   */
+  bool FindCheckpoint(log_offset_t *scan_offset, lsn_t *redo_lsn);
+
+  /** Applies the records of one redo partition until the log reader closes its queue. */
+  void RedoWorker(RedoQueue *queue);
+  /** Reapplies a log record to a page that does not reflect it yet. */
+  void RedoLogRecord(TablePage *page, RedoTask *task);
+  /**
+   * Rolls back the changes of a transaction, newest first, and ends it with an ABORT record if there is a log manager.
+   * @param txn_id the transaction
+   * @param last_lsn the LSN of the last record of the transaction
+   * @param log_records the records of its changes that have not been undone yet, in LSN order
+   */
+  void UndoTransaction(txn_id_t txn_id, lsn_t last_lsn, std::vector<LogRecord> *log_records);
+
+  /** @return the page the change of a data record or CLR is on, the new page for NEWPAGE */
+  static page_id_t GetPageId(const LogRecord &log_record);
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  LogManager *log_manager_;
+  size_t num_workers_;
+  lsn_t max_lsn_{INVALID_LSN};
+  txn_id_t max_txn_id_{INVALID_TXN_ID};
 
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
-  /** Mapping the log sequence number to log file offset for undos. */
-  std::unordered_map<lsn_t, int> lsn_mapping_;
+  /** The data records of every active transaction in LSN order, for undos, without those a CLR has undone already. */
+  std::unordered_map<txn_id_t, std::vector<LogRecord>> txn_records_;
 
-  int offset_ __attribute__((__unused__));
+  log_offset_t offset_;
+  int log_buffer_size_;
   char *log_buffer_;
 };
 
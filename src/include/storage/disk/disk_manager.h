@@ -6,34 +6,56 @@
 //
 // Identification: src/include/storage/disk/disk_manager.h
 //
-// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
 
 #pragma once
 
 #include <atomic>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <future>  // NOLINT
+#include <mutex>   // NOLINT
 #include <string>
 
 #include "common/config.h"
+#include "common/metrics.h"
 
 namespace bustub {
 
+/**
+ * Page I/O statistics of a DiskManager, see DiskManager::GetStats.
+ */
+struct DiskManagerStats {
+  /** Latencies of page reads, from the call (or submission) until the data is in the caller's buffer. */
+  HistogramSnapshot read_latency_;
+  /** Latencies of page writes, from the call (or submission) until the write has completed. */
+  HistogramSnapshot write_latency_;
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
  */
 class DiskManager {
  public:
+  /** Called once an asynchronous I/O has completed, with nullptr or the error it failed with. */
+  using io_done_fn = std::function<void(std::exception_ptr)>;
+
+  /**
+   * Creates a memory based manager used for buffer pool performance testing
+   */
+  DiskManager();
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
    */
   explicit DiskManager(const std::string &db_file);
 
-  ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -45,21 +67,49 @@ class DiskManager {
    * @param page_id id of the page
    * @param page_data raw page data
    */
-  void WritePage(page_id_t page_id, const char *page_data);
+  virtual void WritePage(page_id_t page_id, const char *page_data);
 
   /**
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  virtual void ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Write a page to the database file without waiting for the write to complete.
+   * The default implementation writes synchronously and hands back a future that is already ready.
+   * @param page_id id of the page
+   * @param page_data raw page data, must stay valid until the future is ready
+   * @return a future that becomes ready once the page has been written
+   */
+  virtual std::future<void> WritePageAsync(page_id_t page_id, const char *page_data);
+
+  /**
+   * Read a page from the database file without waiting for the read to complete.
+   * The default implementation reads synchronously and hands back a future that is already ready.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, must stay valid until the future is ready
+   * @return a future that becomes ready once page_data has been filled
+   */
+  virtual std::future<void> ReadPageAsync(page_id_t page_id, char *page_data);
+
+  /**
+   * Read a page from the database file and call on_done from whichever thread completes the read, so that nobody has
+   * to wait for it. The default implementation reads synchronously and calls on_done before returning.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, must stay valid until on_done is called
+   * @param on_done called once page_data has been filled, or the read failed
+   */
+  virtual void ReadPageAsync(page_id_t page_id, char *page_data, io_done_fn on_done);
 
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
    * @param size size of log entry
+   * @return false if the log could not be written or synced
    */
-  void WriteLog(char *log_data, int size);
+  virtual bool WriteLog(char *log_data, int size);
 
   /**
    * Read a log entry from the log file.
@@ -68,7 +118,41 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  bool ReadLog(char *log_data, int size, log_offset_t offset);
+
+  /** @return the size of the log in bytes, including the truncated part, 0 if there is none */
+  log_offset_t GetLogSize();
+
+  /** @return offset of the first byte of the log that has not been truncated */
+  log_offset_t GetLogStart();
+
+  /**
+   * Drops the log segments that only hold records before offset, after recording in the manifest that recovery does
+   * not need them anymore. The segment holding offset and every later one are kept.
+   * @param offset offset of a record at or before the oldest record recovery needs in the log
+   */
+  void TruncateLog(log_offset_t offset);
+
+  /**
+   * Makes TruncateLog move dropped segments into a directory instead of deleting them.
+   * @param archive_dir an existing directory, empty to delete dropped segments again
+   */
+  void SetLogArchiveDirectory(const std::string &archive_dir);
+
+  /**
+   * Durably replaces the master record, which tells recovery where the last complete checkpoint is.
+   * @param checkpoint_lsn LSN of the BEGIN_CHECKPOINT record of the checkpoint
+   * @param offset offset of a log record at or before the BEGIN_CHECKPOINT record in the log file
+   */
+  void WriteMasterRecord(lsn_t checkpoint_lsn, log_offset_t offset);
+
+  /**
+   * Reads the master record written by WriteMasterRecord.
+   * @param[out] checkpoint_lsn LSN of the BEGIN_CHECKPOINT record of the last complete checkpoint
+   * @param[out] offset offset of a log record at or before the BEGIN_CHECKPOINT record in the log file
+   * @return false if no checkpoint has been completed since the log file was created
+   */
+  bool ReadMasterRecord(lsn_t *checkpoint_lsn, log_offset_t *offset);
 
   /**
    * Allocate a page on disk.
@@ -91,6 +175,12 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the page I/O statistics since construction or the last ResetStats */
+  DiskManagerStats GetStats() const;
+
+  /** Drops the page I/O statistics collected so far. */
+  void ResetStats();
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -100,19 +190,51 @@ class DiskManager {
   /** Checks if the non-blocking flush future was set. */
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
- private:
+ protected:
   int GetFileSize(const std::string &file_name);
-  // stream to write log file
-  std::fstream log_io_;
+  /** @return the name of the log segment file holding the log bytes from segment * LOG_SEGMENT_SIZE on */
+  std::string GetSegmentName(int segment) const;
+  /**
+   * Opens the segment the log continues in for appending, creating it if needed.
+   * @return false if the segment it leaves could not be synced or the new one could not be opened
+   */
+  bool OpenWriteSegment(int segment);
+  /** Durably replaces the manifest, the same way as the master record. */
+  void WriteManifest(int first_segment);
+  // The log is a sequence of segment files <log_name_>.<n> of LOG_SEGMENT_SIZE bytes each, log offsets keep counting
+  // across segments. The manifest holds the first segment that has not been truncated. Without a manifest there is no
+  // log, stray segments are deleted.
   std::string log_name_;
+  // file holding the manifest, next to the log segments
+  std::string manifest_name_;
+  // file holding the master record, next to the log file
+  std::string master_name_;
+  // descriptor of the segment the log is appended to, -1 if there is no log file
+  int log_fd_{-1};
+  int log_fd_segment_{-1};
+  // descriptor of the segment last read from, kept open since recovery reads the log sequentially
+  int read_fd_{-1};
+  int read_fd_segment_{-1};
+  // offset of the end of the log, only the thread writing the log advances it
+  std::atomic<log_offset_t> log_size_{0};
+  // first segment that has not been truncated
+  std::atomic<int> first_segment_{0};
+  // serializes TruncateLog and SetLogArchiveDirectory
+  std::mutex truncate_latch_;
+  std::string archive_dir_;
   // stream to write db file
   std::fstream db_io_;
+  // serializes the seek + read/write pairs on db_io_, pages may be read and written by several threads at once
+  std::mutex db_io_latch_;
   std::string file_name_;
   std::atomic<page_id_t> next_page_id_;
-  int num_flushes_;
-  int num_writes_;
-  bool flush_log_;
-  std::future<void> *flush_log_f_;
+  int num_flushes_{0};
+  int num_writes_{0};
+  /** Page I/O latencies, recorded by every ReadPage/WritePage implementation. */
+  LatencyHistogram read_latency_;
+  LatencyHistogram write_latency_;
+  bool flush_log_{false};
+  std::future<void> *flush_log_f_{nullptr};
 };
 
 }  // namespace bustub
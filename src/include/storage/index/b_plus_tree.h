@@ -10,6 +10,8 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <fstream>
 #include <queue>
 #include <shared_mutex>
 #include <string>
@@ -52,7 +54,7 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // return the value associated with a given key, reading the pages optimistically without latching them
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
   // index iterator
@@ -102,6 +104,10 @@ class BPlusTree {
                                   bool leftMost = false);
 
  private:
+  // optimistic descent for read-only operations, returns the pinned leaf and its version to validate reads against
+  Page *FindLeafPageOptimistic(const KeyType &key, bool leftMost, uint64_t *version);
+  // sanity check of a page read optimistically, before its size is used to index into it
+  bool IsConsistent(const BPlusTreePage *node) const;
   template <typename targetPage>
   page_ptr<targetPage> FetchPage(Transaction *transaction, page_id_t page_id, BPlusTreeOperation type);
   void ClearPage(Transaction *transaction, BPlusTreeOperation type);
@@ -137,7 +143,8 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  // read without root_latch_ by optimistic readers
+  std::atomic<page_id_t> root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
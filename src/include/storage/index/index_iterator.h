@@ -39,6 +39,7 @@ class IndexIterator {
     this->leaf_ = std::move(rhs.leaf_);
     index_ = rhs.index_;
     bpm_ = rhs.bpm_;
+    item_ = rhs.item_;
     return *this;
   }
   bool operator==(const IndexIterator &itr) const {
@@ -52,9 +53,12 @@ class IndexIterator {
 
  private:
   // add your own private member variables here
+  // the leaf is pinned but not latched, it is read optimistically and every read is validated against its version
   page_ptr<LeafPage> leaf_;
   int index_;
   BufferPoolManager *bpm_;
+  // copy of the current item, validated against the version of the leaf
+  MappingType item_;
 };
 
 }  // namespace bustub
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstring>
+
 #include "storage/page/page.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
@@ -20,14 +22,77 @@ namespace bustub {
  */
 class TmpTuplePage : public Page {
  public:
-  void Init(page_id_t page_id, uint32_t page_size) {}
+  /**
+   * Initializes an empty page.
+   * @param page_id the id of this page
+   * @param page_size the size of this page
+   */
+  void Init(page_id_t page_id, uint32_t page_size) {
+    memcpy(GetData(), &page_id, sizeof(page_id_t));
+    SetLSN(INVALID_LSN);
+    SetFreeSpacePointer(page_size);
+  }
+
+  /** @return the page id of this page */
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /**
+   * Inserts a tuple in front of the tuples already on the page.
+   * @param tuple the tuple to insert
+   * @param[out] out where the tuple was placed
+   * @return false if the tuple does not fit
+   */
+  bool Insert(const Tuple &tuple, TmpTuple *out) {
+    const uint32_t size = sizeof(uint32_t) + tuple.GetLength();
+    const uint32_t free_space_pointer = GetFreeSpacePointer();
+    if (free_space_pointer < SIZE_HEADER + size) {
+      return false;
+    }
+    const uint32_t offset = free_space_pointer - size;
+    tuple.SerializeTo(GetData() + offset);
+    SetFreeSpacePointer(offset);
+    *out = TmpTuple(GetTablePageId(), offset);
+    return true;
+  }
 
-  page_id_t GetTablePageId() { return INVALID_PAGE_ID; }
+  /**
+   * Reads a tuple back.
+   * @param offset the offset Insert placed the tuple at
+   * @param[out] tuple the tuple
+   * @return the offset of the tuple inserted before it, or the end of the page
+   */
+  uint32_t GetTuple(uint32_t offset, Tuple *tuple) {
+    tuple->DeserializeFrom(GetData() + offset);
+    return offset + sizeof(uint32_t) + tuple->GetLength();
+  }
 
-  bool Insert(const Tuple &tuple, TmpTuple *out) { return false; }
+  /**
+   * Points a tuple at one on this page without copying it. The tuple is only valid while the page stays pinned.
+   * @param offset the offset Insert placed the tuple at
+   * @param[out] tuple the tuple
+   * @return the offset of the tuple inserted before it, or the end of the page
+   */
+  uint32_t GetTupleView(uint32_t offset, Tuple *tuple) {
+    if (tuple->allocated_) {
+      delete[] tuple->data_;
+    }
+    tuple->allocated_ = false;
+    tuple->size_ = *reinterpret_cast<uint32_t *>(GetData() + offset);
+    tuple->data_ = GetData() + offset + sizeof(uint32_t);
+    return offset + sizeof(uint32_t) + tuple->size_;
+  }
+
+  /** @return the offset of the tuple inserted last, the page size if the page is empty */
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
  private:
   static_assert(sizeof(page_id_t) == 4);
+  static constexpr uint32_t OFFSET_FREE_SPACE = 8;
+  static constexpr uint32_t SIZE_HEADER = 12;
+
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
 };
 
 }  // namespace bustub
@@ -95,9 +95,10 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param access_type how the page of the tuple is accessed, AccessType::Scan when reading tuples in order
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, AccessType access_type = AccessType::Unknown);
 
   /** @return the begin iterator of this table */
   TableIterator Begin(Transaction *txn);
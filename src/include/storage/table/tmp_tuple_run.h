@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_run.h
+//
+// Identification: src/include/storage/table/tmp_tuple_run.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TmpTupleRun is a sequence of tuples that executors spill to temporary pages when their input does not fit into
+ * memory, e.g. a partition of a hash join. The pages live in the buffer pool like any other page and are deleted
+ * together with the run. No page stays pinned between calls, so any number of runs can be written at once.
+ */
+class TmpTupleRun {
+ public:
+  /**
+   * Reads the tuples of a run in the order they were appended, one page at a time.
+   */
+  class Reader {
+   public:
+    explicit Reader(const TmpTupleRun *run) : run_(run) {}
+
+    /**
+     * @param[out] tuple the next tuple of the run
+     * @return false if every tuple has been read
+     */
+    bool Next(Tuple *tuple);
+
+   private:
+    const TmpTupleRun *run_;
+    /** Index of the next page to read. */
+    size_t next_page_{0};
+    /** The tuples of the page read last, in reverse order. */
+    std::vector<Tuple> tuples_;
+  };
+
+  explicit TmpTupleRun(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  /** Deletes the pages of the run. */
+  ~TmpTupleRun();
+
+  DISALLOW_COPY_AND_MOVE(TmpTupleRun);
+
+  /**
+   * Appends a tuple, allocating a new page when the last one is full. Throws OUT_OF_MEMORY if there is no frame left
+   * to spill to, or if the tuple is too large for a page.
+   * @param tuple the tuple
+   */
+  void Append(const Tuple &tuple);
+
+  /** @return the number of tuples appended */
+  size_t GetNumTuples() const { return num_tuples_; }
+
+  /** @return the number of tuple bytes appended */
+  size_t GetSize() const { return size_; }
+
+  /** @return a reader positioned at the first tuple */
+  Reader Read() const { return Reader(this); }
+
+ private:
+  BufferPoolManager *bpm_;
+  std::vector<page_id_t> page_ids_;
+  size_t num_tuples_{0};
+  size_t size_{0};
+};
+
+}  // namespace bustub
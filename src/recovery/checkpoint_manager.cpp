@@ -12,16 +12,85 @@
 
 #include "recovery/checkpoint_manager.h"
 
+#include <algorithm>
+
 namespace bustub {
 
+CheckpointManager::~CheckpointManager() {
+  if (page_writer_.joinable()) {
+    page_writer_.join();
+  }
+}
+
 void CheckpointManager::BeginCheckpoint() {
-  // Block all the transactions and ensure that both the WAL and all dirty buffer pool pages are persisted to disk,
-  // creating a consistent checkpoint. Do NOT allow transactions to resume at the end of this method, resume them
-  // in CheckpointManager::EndCheckpoint() instead. This is for grading purposes.
+  // a checkpoint that never ended is simply superseded
+  if (page_writer_.joinable()) {
+    page_writer_.join();
+  }
+  begin_lsn_ = INVALID_LSN;
+  if (enable_logging) {
+    LogRecord log_record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::BEGIN_CHECKPOINT);
+    begin_lsn_ = log_manager_->AppendLogRecord(&log_record);
+  }
+  // Every change older than the BEGIN_CHECKPOINT record is on one of these pages. Writing them back one at a time
+  // only latches one page at a time, so transactions keep going.
+  auto dirty_pages = buffer_pool_manager_->GetDirtyPageTable();
+  std::sort(dirty_pages.begin(), dirty_pages.end());
+  page_writer_ = std::thread([this, dirty_pages = std::move(dirty_pages)] {
+    for (const auto &dirty_page : dirty_pages) {
+      // a page that is not in the buffer pool anymore has been written back by its eviction
+      buffer_pool_manager_->FlushPage(dirty_page.first);
+    }
+  });
 }
 
 void CheckpointManager::EndCheckpoint() {
-  // Allow transactions to resume, completing the checkpoint.
+  if (page_writer_.joinable()) {
+    page_writer_.join();
+  }
+  if (!enable_logging || begin_lsn_ == INVALID_LSN) {
+    return;
+  }
+  auto active_txns = transaction_manager_->GetActiveTransactions();
+  auto dirty_pages = buffer_pool_manager_->GetDirtyPageTable();
+
+  // Recovery reads the log from the oldest LSN it needs, to redo a page or to undo a transaction. A dirty page with
+  // an invalid recLSN was changed without a log manager, the log cannot help it.
+  lsn_t scan_lsn = begin_lsn_;
+  for (const auto &active_txn : active_txns) {
+    scan_lsn = std::min(scan_lsn, active_txn.second);
+  }
+  for (const auto &dirty_page : dirty_pages) {
+    if (dirty_page.second != INVALID_LSN) {
+      scan_lsn = std::min(scan_lsn, dirty_page.second);
+    }
+  }
+  // every record up to the checkpoint is persistent, so the log offset of scan_lsn is known
+  log_manager_->Flush(begin_lsn_);
+  const log_offset_t log_offset = log_manager_->GetLogOffset(scan_lsn);
+
+  // The record has to fit into the log buffer. Recovery only needs the oldest LSNs of both tables, so if they are
+  // too large the youngest entries are dropped.
+  const size_t max_entries =
+      (log_manager_->GetLogBufferSize() - LogRecord::HEADER_SIZE - sizeof(log_offset_t) - 2 * sizeof(int32_t)) /
+      (2 * sizeof(int32_t));
+  auto by_lsn = [](const auto &a, const auto &b) { return a.second < b.second; };
+  if (active_txns.size() > max_entries) {
+    std::sort(active_txns.begin(), active_txns.end(), by_lsn);
+    active_txns.resize(max_entries);
+  }
+  if (active_txns.size() + dirty_pages.size() > max_entries) {
+    std::sort(dirty_pages.begin(), dirty_pages.end(), by_lsn);
+    dirty_pages.resize(max_entries - active_txns.size());
+  }
+
+  LogRecord log_record(begin_lsn_, log_offset, std::move(active_txns), std::move(dirty_pages));
+  const lsn_t end_lsn = log_manager_->AppendLogRecord(&log_record);
+  log_manager_->Flush(end_lsn);
+  log_manager_->WriteMasterRecord(begin_lsn_);
+  // neither recovery nor later checkpoints read the log from an older LSN
+  log_manager_->TruncateLog(scan_lsn);
+  begin_lsn_ = INVALID_LSN;
 }
 
 }  // namespace bustub
@@ -12,7 +12,58 @@
 
 #include "recovery/log_manager.h"
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+
 namespace bustub {
+using unique_lock = std::unique_lock<std::mutex>;
+
+namespace {
+
+/** @return the smallest power of two that is at least value */
+uint32_t NextPowerOfTwo(uint64_t value) {
+  uint64_t power = 1;
+  while (power < value) {
+    power <<= 1;
+  }
+  return static_cast<uint32_t>(power);
+}
+
+}  // namespace
+
+LogManager::LogManager(DiskManager *disk_manager, int log_buffer_size)
+    : log_buffer_size_(log_buffer_size),
+      ring_size_(NextPowerOfTwo(2 * static_cast<uint64_t>(log_buffer_size))),
+      num_slots_(NextPowerOfTwo((ring_size_ + LogRecord::HEADER_SIZE - 1) / LogRecord::HEADER_SIZE)),
+      persistent_lsn_(INVALID_LSN),
+      disk_manager_(disk_manager) {
+  // ring distances are compared as unsigned 32 bit differences
+  BUSTUB_ASSERT(log_buffer_size_ >= LogRecord::HEADER_SIZE && log_buffer_size_ <= (1 << 29),
+                "The log buffer size is out of range.");
+  // the tail holds the part of a record that wraps around, until it is copied to the start of the ring
+  log_buffer_ = new char[ring_size_ + log_buffer_size_];
+  record_sizes_ = new std::atomic<int32_t>[num_slots_]();
+  // records are appended behind whatever an earlier run left in the log file
+  flushed_offset_ = disk_manager_->GetLogSize();
+  log_offsets_.emplace_back(0, flushed_offset_);
+}
+
+std::string LogManagerStats::ToString() const {
+  std::ostringstream os;
+  os << "records_appended=" << records_appended_ << " bytes_appended=" << bytes_appended_ << " flushes=" << flushes_
+     << " flush_bytes: " << flush_bytes_.ToString("B") << " flush_records: " << flush_records_.ToString("")
+     << " sync_latency: " << sync_latency_.ToString() << " flush_wait: " << flush_wait_.ToString();
+  return os.str();
+}
+
 /*
  * set enable_logging = true
  * Start a separate thread to execute flush to disk operation periodically
@@ -22,33 +73,296 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  unique_lock lock(latch_);
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  enable_logging = true;
+  flush_thread_ = std::thread(&LogManager::FlushLoop, this);
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
+ * Everything appended before the call is persistent once it returns.
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  {
+    unique_lock lock(latch_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+    enable_logging = false;
+  }
+  cv_.notify_one();
+  flush_thread_.join();
+}
+
+void LogManager::FlushLoop() {
+  unique_lock lock(latch_);
+  while (!write_failed_ && (running_ || flush_lsn_ < GetNextLSN())) {
+    // sleep until the timeout unless somebody waits for the log, the ring is full or we are asked to stop
+    cv_.wait_for(lock, log_timeout, [&] { return flush_requested_ || !running_; });
+    if (!FlushBuffer(&lock) && !running_) {
+      // draining, but the next record is still being serialized
+      lock.unlock();
+      std::this_thread::yield();
+      lock.lock();
+    }
+  }
+}
+
+bool LogManager::FlushBuffer(unique_lock *lock) {
+  flushed_cv_.wait(*lock, [&] { return !flushing_; });
+  flush_requested_ = false;
+  if (write_failed_) {
+    return false;
+  }
+  // collect the complete records, up to the first one that is still being serialized
+  const uint32_t start = flushed_position_.load(std::memory_order_relaxed);
+  uint32_t end = start;
+  lsn_t lsn = flush_lsn_;
+  while (true) {
+    auto &record_size = record_sizes_[static_cast<uint32_t>(lsn) % num_slots_];
+    const int32_t size = record_size.load(std::memory_order_acquire);
+    // write half of the ring at most, like a log buffer, so that appenders can keep going during the write
+    if (size == 0 || end - start + size > ring_size_ / 2) {
+      break;
+    }
+    record_size.store(0, std::memory_order_relaxed);
+    end += size;
+    lsn++;
+  }
+  if (end == start) {
+    // waiters check again, and ask again if they still need the log
+    flushed_cv_.notify_all();
+    return false;
+  }
+  flushing_ = true;
+  log_offsets_.emplace_back(flush_lsn_, flushed_offset_);
+
+  lock->unlock();
+  const uint32_t offset = start % ring_size_;
+  const uint32_t length = end - start;
+  bool written;
+  {
+    LatencyTimer timer(&sync_latency_);
+    if (offset + length <= ring_size_) {
+      written = disk_manager_->WriteLog(log_buffer_ + offset, length);
+    } else {
+      written = disk_manager_->WriteLog(log_buffer_ + offset, ring_size_ - offset) &&
+                disk_manager_->WriteLog(log_buffer_, length - (ring_size_ - offset));
+    }
+  }
+  flush_bytes_.RecordValue(length);
+  flush_records_.RecordValue(lsn - flush_lsn_);
+  lock->lock();
+
+  if (!written) {
+    // what reached the log file may not be durable, so nothing is persistent from here on and waiters give up
+    LOG_ERROR("the log could not be written, records from LSN %d on are not persistent", flush_lsn_);
+    log_offsets_.pop_back();
+    write_failed_ = true;
+    flushing_ = false;
+    flushed_cv_.notify_all();
+    return false;
+  }
+
+  flush_lsn_ = lsn;
+  persistent_lsn_ = lsn - 1;
+  flushed_offset_ += length;
+  // appenders may reuse the bytes now
+  flushed_position_.store(end, std::memory_order_release);
+  flushing_ = false;
+  flushed_cv_.notify_all();
+  return true;
+}
+
+void LogManager::Flush(lsn_t lsn) {
+  LatencyTimer timer(&flush_wait_);
+  unique_lock lock(latch_);
+  // e.g. pages that were never logged can carry any LSN
+  lsn = std::min<lsn_t>(lsn, GetNextLSN() - 1);
+  while (persistent_lsn_ < lsn) {
+    if (write_failed_) {
+      throw Exception(ExceptionType::INVALID, "the log could not be written");
+    }
+    if (!running_) {
+      if (!FlushBuffer(&lock)) {
+        lock.unlock();
+        std::this_thread::yield();
+        lock.lock();
+      }
+      continue;
+    }
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+}
+
+log_offset_t LogManager::GetLogOffset(lsn_t lsn) {
+  unique_lock lock(latch_);
+  // the last write that started at or before lsn
+  auto it = std::upper_bound(log_offsets_.begin(), log_offsets_.end(), lsn,
+                             [](lsn_t lsn, const std::pair<lsn_t, log_offset_t> &entry) { return lsn < entry.first; });
+  return it == log_offsets_.begin() ? log_offsets_.front().second : std::prev(it)->second;
+}
+
+void LogManager::TruncateLog(lsn_t lsn) {
+  disk_manager_->TruncateLog(GetLogOffset(lsn));
+  unique_lock lock(latch_);
+  // keep the entry GetLogOffset(lsn) returns, and the first one for lookups before every write
+  while (log_offsets_.size() > 2 && log_offsets_[2].first <= lsn) {
+    log_offsets_.erase(log_offsets_.begin() + 1);
+  }
+}
+
+void LogManager::SetNextLSN(lsn_t lsn) {
+  unique_lock lock(latch_);
+  BUSTUB_ASSERT(reservation_.load() == 0, "The next LSN can only be set before the first record is appended.");
+  BUSTUB_ASSERT(lsn >= 0, "LSNs are not negative.");
+  reservation_.store(static_cast<uint64_t>(lsn));
+  flush_lsn_ = lsn;
+  persistent_lsn_ = lsn - 1;
+  log_offsets_.front().first = lsn;
+}
+
+void LogManager::WaitForSpace(uint32_t position, int32_t size) {
+  unique_lock lock(latch_);
+  while (position + static_cast<uint32_t>(size) - flushed_position_.load(std::memory_order_acquire) > ring_size_) {
+    if (write_failed_) {
+      throw Exception(ExceptionType::INVALID, "the log could not be written");
+    }
+    if (!running_) {
+      if (!FlushBuffer(&lock)) {
+        lock.unlock();
+        std::this_thread::yield();
+        lock.lock();
+      }
+      continue;
+    }
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  const int32_t size = log_record->size_;
+  BUSTUB_ASSERT(size <= log_buffer_size_, "A log record has to fit into the log buffer.");
+
+  // reserve the LSN and the bytes of the record at once
+  const uint64_t reservation =
+      reservation_.fetch_add((static_cast<uint64_t>(size) << POSITION_SHIFT) | 1, std::memory_order_relaxed);
+  const auto lsn = static_cast<lsn_t>(reservation & LSN_MASK);
+  const auto position = static_cast<uint32_t>(reservation >> POSITION_SHIFT);
+  const uint32_t flushed_position = flushed_position_.load(std::memory_order_acquire);
+  const uint32_t end = position + static_cast<uint32_t>(size);
+  if (end - flushed_position > ring_size_) {
+    WaitForSpace(position, size);
+  } else if (end - flushed_position > ring_size_ / 2 && position - flushed_position <= ring_size_ / 2) {
+    // this record fills up the first half, write it out while the second half fills up
+    unique_lock lock(latch_);
+    flush_requested_ = true;
+    cv_.notify_one();
+  }
+
+  log_record->lsn_ = lsn;
+  const uint32_t offset = position % ring_size_;
+  SerializeLogRecord(log_record, log_buffer_ + offset);
+  if (offset + size > ring_size_) {
+    // the record wrapped around into the tail
+    memcpy(log_buffer_, log_buffer_ + ring_size_, offset + size - ring_size_);
+  }
+  // hand the record to the flusher
+  record_sizes_[static_cast<uint32_t>(lsn) % num_slots_].store(size, std::memory_order_release);
+  num_records_appended_.Add();
+  num_bytes_appended_.Add(size);
+  return lsn;
+}
+
+LogManagerStats LogManager::GetStats() const {
+  LogManagerStats stats;
+  stats.records_appended_ = num_records_appended_.Get();
+  stats.bytes_appended_ = num_bytes_appended_.Get();
+  stats.flush_bytes_ = flush_bytes_.Snapshot();
+  stats.flushes_ = stats.flush_bytes_.count_;
+  stats.flush_records_ = flush_records_.Snapshot();
+  stats.sync_latency_ = sync_latency_.Snapshot();
+  stats.flush_wait_ = flush_wait_.Snapshot();
+  return stats;
+}
+
+void LogManager::ResetStats() {
+  num_records_appended_.Reset();
+  num_bytes_appended_.Reset();
+  flush_bytes_.Reset();
+  flush_records_.Reset();
+  sync_latency_.Reset();
+  flush_wait_.Reset();
+}
+
+void LogManager::SerializeLogRecord(LogRecord *log_record, char *data) {
+  // the header fields are the first members of LogRecord
+  memcpy(data, log_record, LogRecord::HEADER_SIZE);
+  int pos = LogRecord::HEADER_SIZE;
+  if (log_record->log_record_type_ == LogRecordType::CLR) {
+    memcpy(data + pos, &log_record->undo_next_lsn_, sizeof(lsn_t));
+    pos += sizeof(lsn_t);
+    memcpy(data + pos, &log_record->compensated_type_, sizeof(LogRecordType));
+    pos += sizeof(LogRecordType);
+  }
+  switch (log_record->GetRedoType()) {
+    case LogRecordType::INSERT:
+      memcpy(data + pos, &log_record->insert_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->insert_tuple_.SerializeTo(data + pos);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(data + pos, &log_record->delete_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->delete_tuple_.SerializeTo(data + pos);
+      break;
+    case LogRecordType::UPDATE:
+      log_record->SerializeUpdate(data + pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(data + pos, &log_record->prev_page_id_, sizeof(page_id_t));
+      pos += sizeof(page_id_t);
+      memcpy(data + pos, &log_record->page_id_, sizeof(page_id_t));
+      break;
+    case LogRecordType::END_CHECKPOINT: {
+      auto write_int = [&](int32_t value) {
+        memcpy(data + pos, &value, sizeof(int32_t));
+        pos += sizeof(int32_t);
+      };
+      memcpy(data + pos, &log_record->log_offset_, sizeof(log_offset_t));
+      pos += sizeof(log_offset_t);
+      write_int(static_cast<int32_t>(log_record->active_txns_.size()));
+      for (const auto &[txn_id, first_lsn] : log_record->active_txns_) {
+        write_int(txn_id);
+        write_int(first_lsn);
+      }
+      write_int(static_cast<int32_t>(log_record->dirty_pages_.size()));
+      for (const auto &[page_id, rec_lsn] : log_record->dirty_pages_) {
+        write_int(page_id);
+        write_int(rec_lsn);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
 
 }  // namespace bustub
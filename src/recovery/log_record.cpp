@@ -0,0 +1,194 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_record.cpp
+//
+// Identification: src/recovery/log_record.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_record.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace bustub {
+
+namespace {
+
+/** Ranges closer than this are logged as one, a range costs at least two bytes of gap and length. */
+constexpr uint32_t MAX_MERGE_GAP = 1;
+
+/** Writes value as a varint at data + *pos, or only counts its bytes if data is nullptr. */
+void WriteVarint(char *data, int *pos, uint32_t value) {
+  do {
+    auto byte = static_cast<uint8_t>(value & 0x7f);
+    value >>= 7;
+    if (value != 0) {
+      byte |= 0x80;
+    }
+    if (data != nullptr) {
+      data[*pos] = static_cast<char>(byte);
+    }
+    (*pos)++;
+  } while (value != 0);
+}
+
+/** Reads a varint at data + *pos. @return false if it does not end before size or does not fit 32 bits */
+bool ReadVarint(const char *data, int size, int *pos, uint32_t *value) {
+  *value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (*pos >= size) {
+      return false;
+    }
+    const auto byte = static_cast<uint8_t>(data[(*pos)++]);
+    *value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** @return how many bytes of the range [offset, offset + length) lie within a tuple of tuple_size bytes */
+uint32_t BytesWithin(uint32_t offset, uint32_t length, uint32_t tuple_size) {
+  return offset >= tuple_size ? 0 : std::min(length, tuple_size - offset);
+}
+
+}  // namespace
+
+LogRecord::LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &update_rid,
+                     const Tuple &old_tuple, const Tuple &new_tuple)
+    : txn_id_(txn_id),
+      prev_lsn_(prev_lsn),
+      log_record_type_(log_record_type),
+      update_rid_(update_rid),
+      update_old_size_(old_tuple.GetLength()),
+      update_new_size_(new_tuple.GetLength()) {
+  // every byte past the end of the shorter tuple differs
+  const uint32_t common_size = std::min(update_old_size_, update_new_size_);
+  const uint32_t max_size = std::max(update_old_size_, update_new_size_);
+  const char *old_data = old_tuple.GetData();
+  const char *new_data = new_tuple.GetData();
+  uint32_t i = 0;
+  while (i < max_size) {
+    if (i < common_size && old_data[i] == new_data[i]) {
+      i++;
+      continue;
+    }
+    // a range ends once more than MAX_MERGE_GAP bytes in a row are equal
+    const uint32_t start = i;
+    uint32_t end = i + 1;
+    for (i = end; i < max_size && i - end <= MAX_MERGE_GAP; i++) {
+      if (i >= common_size || old_data[i] != new_data[i]) {
+        end = i + 1;
+      }
+    }
+    i = end;
+    update_ranges_.emplace_back(start, end - start);
+    update_old_bytes_.append(old_data + start, BytesWithin(start, end - start, update_old_size_));
+    update_new_bytes_.append(new_data + start, BytesWithin(start, end - start, update_new_size_));
+  }
+  // calculate log record size
+  size_ = HEADER_SIZE + SerializeUpdate(nullptr);
+}
+
+bool LogRecord::ApplyUpdate(const Tuple &tuple, bool redo, Tuple *result) const {
+  const uint32_t from_size = redo ? update_old_size_ : update_new_size_;
+  const uint32_t to_size = redo ? update_new_size_ : update_old_size_;
+  const std::string &to_bytes = redo ? update_new_bytes_ : update_old_bytes_;
+  if (tuple.GetLength() != from_size) {
+    return false;
+  }
+  // the serialized tuple, its size followed by its data
+  std::vector<char> storage(sizeof(int32_t) + to_size, 0);
+  const auto size = static_cast<int32_t>(to_size);
+  memcpy(storage.data(), &size, sizeof(int32_t));
+  char *data = storage.data() + sizeof(int32_t);
+  memcpy(data, tuple.GetData(), std::min(from_size, to_size));
+  size_t pos = 0;
+  for (const auto &[offset, length] : update_ranges_) {
+    const uint32_t count = BytesWithin(offset, length, to_size);
+    memcpy(data + offset, to_bytes.data() + pos, count);
+    pos += count;
+  }
+  result->DeserializeFrom(storage.data());
+  return true;
+}
+
+int LogRecord::SerializeUpdate(char *data) const {
+  int pos = 0;
+  WriteVarint(data, &pos, static_cast<uint32_t>(update_rid_.GetPageId()));
+  WriteVarint(data, &pos, update_rid_.GetSlotNum());
+  WriteVarint(data, &pos, update_old_size_);
+  WriteVarint(data, &pos, update_new_size_);
+  WriteVarint(data, &pos, static_cast<uint32_t>(update_ranges_.size()));
+  uint32_t previous_end = 0;
+  size_t old_pos = 0;
+  size_t new_pos = 0;
+  for (const auto &[offset, length] : update_ranges_) {
+    WriteVarint(data, &pos, offset - previous_end);
+    WriteVarint(data, &pos, length);
+    const uint32_t old_count = BytesWithin(offset, length, update_old_size_);
+    const uint32_t new_count = BytesWithin(offset, length, update_new_size_);
+    if (data != nullptr) {
+      memcpy(data + pos, update_old_bytes_.data() + old_pos, old_count);
+      memcpy(data + pos + old_count, update_new_bytes_.data() + new_pos, new_count);
+    }
+    pos += old_count + new_count;
+    old_pos += old_count;
+    new_pos += new_count;
+    previous_end = offset + length;
+  }
+  return pos;
+}
+
+bool LogRecord::DeserializeUpdate(const char *data, int size) {
+  int pos = 0;
+  uint32_t page_id;
+  uint32_t slot_num;
+  uint32_t num_ranges;
+  if (!ReadVarint(data, size, &pos, &page_id) || !ReadVarint(data, size, &pos, &slot_num) ||
+      !ReadVarint(data, size, &pos, &update_old_size_) || !ReadVarint(data, size, &pos, &update_new_size_) ||
+      !ReadVarint(data, size, &pos, &num_ranges)) {
+    return false;
+  }
+  update_rid_.Set(static_cast<page_id_t>(page_id), slot_num);
+  const uint32_t max_size = std::max(update_old_size_, update_new_size_);
+  // a range takes up two bytes at least
+  if (num_ranges > static_cast<uint32_t>(size - pos) / 2) {
+    return false;
+  }
+  update_ranges_.clear();
+  update_old_bytes_.clear();
+  update_new_bytes_.clear();
+  uint32_t previous_end = 0;
+  for (uint32_t i = 0; i < num_ranges; i++) {
+    uint32_t gap;
+    uint32_t length;
+    if (!ReadVarint(data, size, &pos, &gap) || !ReadVarint(data, size, &pos, &length) ||
+        gap > max_size - previous_end || length > max_size - previous_end - gap) {
+      return false;
+    }
+    const uint32_t offset = previous_end + gap;
+    const uint32_t old_count = BytesWithin(offset, length, update_old_size_);
+    const uint32_t new_count = BytesWithin(offset, length, update_new_size_);
+    if (static_cast<uint32_t>(size - pos) < old_count + new_count) {
+      return false;
+    }
+    update_ranges_.emplace_back(offset, length);
+    update_old_bytes_.append(data + pos, old_count);
+    update_new_bytes_.append(data + pos + old_count, new_count);
+    pos += old_count + new_count;
+    previous_end = offset + length;
+  }
+  return pos == size;
+}
+
+}  // namespace bustub
@@ -12,29 +12,518 @@
 
 #include "recovery/log_recovery.h"
 
-#include "storage/page/table_page.h"
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "common/logger.h"
 
 namespace bustub {
+
+using unique_lock = std::unique_lock<std::mutex>;
+
+/**
+ * The batches of redo work of one worker. The queue is bounded, so the log reader stalls instead of buffering the
+ * whole log when a worker falls behind.
+ */
+class LogRecovery::RedoQueue {
+ public:
+  static constexpr size_t MAX_BATCHES = 64;
+
+  void Push(std::vector<RedoTask> &&batch) {
+    unique_lock lock(latch_);
+    not_full_.wait(lock, [&] { return batches_.size() < MAX_BATCHES; });
+    batches_.emplace_back(std::move(batch));
+    not_empty_.notify_one();
+  }
+
+  /** @return false once the queue is closed and drained */
+  bool Pop(std::vector<RedoTask> *batch) {
+    unique_lock lock(latch_);
+    not_empty_.wait(lock, [&] { return !batches_.empty() || closed_; });
+    if (batches_.empty()) {
+      return false;
+    }
+    *batch = std::move(batches_.front());
+    batches_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  void Close() {
+    unique_lock lock(latch_);
+    closed_ = true;
+    not_empty_.notify_all();
+  }
+
+ private:
+  std::mutex latch_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<std::vector<RedoTask>> batches_;
+  bool closed_{false};
+};
+
+LogRecovery::LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, LogManager *log_manager,
+                         size_t num_workers, int log_buffer_size)
+    : disk_manager_(disk_manager),
+      buffer_pool_manager_(buffer_pool_manager),
+      log_manager_(log_manager),
+      offset_(0),
+      log_buffer_size_(log_buffer_size) {
+  num_workers_ = num_workers == 0 ? std::thread::hardware_concurrency() : num_workers;
+  // every worker pins one page at a time, leave half of the pool to everybody else
+  num_workers_ = std::max<size_t>(1, std::min(num_workers_, buffer_pool_manager_->GetPoolSize() / 2));
+  log_buffer_ = new char[log_buffer_size_];
+}
+
 /*
  * deserialize a log record from log buffer
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
-bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) { return false; }
+bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) {
+  int32_t size;
+  memcpy(&size, data, sizeof(int32_t));
+  // the log file is zero padded after its last record
+  if (size < LogRecord::HEADER_SIZE) {
+    return false;
+  }
+  log_record->size_ = size;
+  memcpy(&log_record->lsn_, data + 4, sizeof(lsn_t));
+  memcpy(&log_record->txn_id_, data + 8, sizeof(txn_id_t));
+  memcpy(&log_record->prev_lsn_, data + 12, sizeof(lsn_t));
+  memcpy(&log_record->log_record_type_, data + 16, sizeof(LogRecordType));
+
+  // the tuples must lie within the record
+  auto read_tuple = [&](int *pos, Tuple *tuple) {
+    int32_t tuple_size;
+    memcpy(&tuple_size, data + *pos, sizeof(int32_t));
+    if (tuple_size < 0 || *pos + static_cast<int>(sizeof(int32_t)) + tuple_size > size) {
+      return false;
+    }
+    tuple->DeserializeFrom(data + *pos);
+    *pos += sizeof(int32_t) + tuple_size;
+    return true;
+  };
+  int pos = LogRecord::HEADER_SIZE;
+  if (log_record->log_record_type_ == LogRecordType::CLR) {
+    if (size < pos + static_cast<int>(sizeof(lsn_t) + sizeof(LogRecordType))) {
+      return false;
+    }
+    memcpy(&log_record->undo_next_lsn_, data + pos, sizeof(lsn_t));
+    pos += sizeof(lsn_t);
+    memcpy(&log_record->compensated_type_, data + pos, sizeof(LogRecordType));
+    pos += sizeof(LogRecordType);
+    // only changes of tuples are compensated
+    switch (log_record->compensated_type_) {
+      case LogRecordType::INSERT:
+      case LogRecordType::MARKDELETE:
+      case LogRecordType::APPLYDELETE:
+      case LogRecordType::ROLLBACKDELETE:
+      case LogRecordType::UPDATE:
+        break;
+      default:
+        return false;
+    }
+  }
+  switch (log_record->GetRedoType()) {
+    case LogRecordType::INSERT:
+      memcpy(&log_record->insert_rid_, data + pos, sizeof(RID));
+      pos += sizeof(RID);
+      return read_tuple(&pos, &log_record->insert_tuple_) && pos == size;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(&log_record->delete_rid_, data + pos, sizeof(RID));
+      pos += sizeof(RID);
+      return read_tuple(&pos, &log_record->delete_tuple_) && pos == size;
+    case LogRecordType::UPDATE:
+      return log_record->DeserializeUpdate(data + pos, size - pos);
+    case LogRecordType::NEWPAGE:
+      memcpy(&log_record->prev_page_id_, data + pos, sizeof(page_id_t));
+      pos += sizeof(page_id_t);
+      memcpy(&log_record->page_id_, data + pos, sizeof(page_id_t));
+      return pos + static_cast<int>(sizeof(page_id_t)) == size;
+    case LogRecordType::BEGIN:
+    case LogRecordType::COMMIT:
+    case LogRecordType::ABORT:
+    case LogRecordType::BEGIN_CHECKPOINT:
+      return size == LogRecord::HEADER_SIZE;
+    case LogRecordType::END_CHECKPOINT: {
+      // both tables must lie within the record
+      auto read_table = [&](auto *table) {
+        int32_t num_entries;
+        memcpy(&num_entries, data + pos, sizeof(int32_t));
+        pos += sizeof(int32_t);
+        if (num_entries < 0 || num_entries > (size - pos) / static_cast<int>(2 * sizeof(int32_t))) {
+          return false;
+        }
+        table->resize(num_entries);
+        for (auto &entry : *table) {
+          memcpy(&entry.first, data + pos, sizeof(int32_t));
+          memcpy(&entry.second, data + pos + sizeof(int32_t), sizeof(int32_t));
+          pos += 2 * sizeof(int32_t);
+        }
+        return true;
+      };
+      if (size < pos + static_cast<int>(sizeof(log_offset_t) + 2 * sizeof(int32_t))) {
+        return false;
+      }
+      memcpy(&log_record->log_offset_, data + pos, sizeof(log_offset_t));
+      pos += sizeof(log_offset_t);
+      return read_table(&log_record->active_txns_) && pos + static_cast<int>(sizeof(int32_t)) <= size &&
+             read_table(&log_record->dirty_pages_) && pos == size;
+    }
+    default:
+      return false;
+  }
+}
+
+void LogRecovery::ScanLog(log_offset_t offset, const std::function<bool(LogRecord *)> &visit) {
+  offset_ = offset;
+  LogRecord log_record;
+  while (disk_manager_->ReadLog(log_buffer_, log_buffer_size_, offset_)) {
+    int pos = 0;
+    while (pos + LogRecord::HEADER_SIZE <= log_buffer_size_) {
+      int32_t size;
+      memcpy(&size, log_buffer_ + pos, sizeof(int32_t));
+      if (size > log_buffer_size_ - pos) {
+        // the record continues past the buffer, read again starting with it
+        break;
+      }
+      if (!DeserializeLogRecord(log_buffer_ + pos, &log_record)) {
+        return;
+      }
+      pos += size;
+      if (!visit(&log_record)) {
+        offset_ += pos;
+        return;
+      }
+    }
+    if (pos == 0) {
+      // a record does not even fit the buffer
+      return;
+    }
+    offset_ += pos;
+  }
+}
+
+bool LogRecovery::FindCheckpoint(log_offset_t *scan_offset, lsn_t *redo_lsn) {
+  lsn_t checkpoint_lsn;
+  log_offset_t offset;
+  if (!disk_manager_->ReadMasterRecord(&checkpoint_lsn, &offset)) {
+    return false;
+  }
+  // the END_CHECKPOINT record follows its BEGIN_CHECKPOINT record, and refers to it by its prevLSN
+  bool found = false;
+  ScanLog(offset, [&](LogRecord *log_record) {
+    if (log_record->log_record_type_ != LogRecordType::END_CHECKPOINT || log_record->prev_lsn_ != checkpoint_lsn) {
+      return true;
+    }
+    // every change older than both the checkpoint and the recLSN of every dirty page is on disk
+    *scan_offset = log_record->log_offset_;
+    *redo_lsn = checkpoint_lsn;
+    for (const auto &dirty_page : log_record->dirty_pages_) {
+      if (dirty_page.second != INVALID_LSN) {
+        *redo_lsn = std::min(*redo_lsn, dirty_page.second);
+      }
+    }
+    found = true;
+    return false;
+  });
+  return found;
+}
 
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
- *read log file from the beginning to end (you must prefetch log records into
- *log buffer to reduce unnecessary I/O operations), remember to compare page's
- *LSN with log_record's sequence number, and also build active_txn_ table &
- *lsn_mapping_ table
+ *read the log file once from the last checkpoint (or the beginning) to the end,
+ *log_buffer_size_ bytes at a time, and build the active_txn_ table. Every data
+ *record the checkpoint does not cover goes to the worker owning its page, which
+ *compares the page's LSN with the record's LSN
  */
-void LogRecovery::Redo() {}
+void LogRecovery::Redo() {
+  BUSTUB_ASSERT(!enable_logging, "Recovery must run before logging is enabled.");
+  std::vector<std::unique_ptr<RedoQueue>> queues;
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < num_workers_; i++) {
+    queues.emplace_back(std::make_unique<RedoQueue>());
+    workers.emplace_back(&LogRecovery::RedoWorker, this, queues.back().get());
+  }
+  std::vector<std::vector<RedoTask>> batches(num_workers_);
+  auto dispatch = [&](page_id_t page_id, const LogRecord &log_record) {
+    const size_t worker = std::hash<page_id_t>()(page_id) % num_workers_;
+    batches[worker].push_back(RedoTask{page_id, log_record});
+    if (batches[worker].size() == REDO_BATCH_SIZE) {
+      queues[worker]->Push(std::move(batches[worker]));
+      batches[worker].clear();
+      batches[worker].reserve(REDO_BATCH_SIZE);
+    }
+  };
+
+  active_txn_.clear();
+  txn_records_.clear();
+  // The checkpoint tells where the oldest record of an active transaction is, and from which LSN on changes may be
+  // missing on disk. The records in between are only read to be able to undo.
+  log_offset_t scan_offset = 0;
+  lsn_t redo_lsn = INVALID_LSN;
+  if (!FindCheckpoint(&scan_offset, &redo_lsn)) {
+    // without a checkpoint nothing has been truncated either, the log is read from its start
+    scan_offset = disk_manager_->GetLogStart();
+    redo_lsn = INVALID_LSN;
+  }
+  max_lsn_ = INVALID_LSN;
+  max_txn_id_ = INVALID_TXN_ID;
+  ScanLog(scan_offset, [&](LogRecord *log_record) {
+    const txn_id_t txn_id = log_record->txn_id_;
+    max_lsn_ = std::max(max_lsn_, log_record->lsn_);
+    max_txn_id_ = std::max(max_txn_id_, txn_id);
+    switch (log_record->log_record_type_) {
+      case LogRecordType::BEGIN:
+        active_txn_[txn_id] = log_record->lsn_;
+        txn_records_[txn_id];
+        return true;
+      case LogRecordType::COMMIT:
+      case LogRecordType::ABORT:
+        active_txn_.erase(txn_id);
+        txn_records_.erase(txn_id);
+        return true;
+      case LogRecordType::END_CHECKPOINT:
+        // transactions active at the checkpoint may have no record after it
+        for (const auto &active_txn : log_record->active_txns_) {
+          max_txn_id_ = std::max(max_txn_id_, active_txn.first);
+        }
+        return true;
+      case LogRecordType::BEGIN_CHECKPOINT:
+        return true;
+      default:
+        break;
+    }
+    if (log_record->lsn_ >= redo_lsn) {
+      dispatch(GetPageId(*log_record), *log_record);
+      if (log_record->log_record_type_ == LogRecordType::NEWPAGE && log_record->prev_page_id_ != INVALID_PAGE_ID) {
+        dispatch(log_record->prev_page_id_, *log_record);
+      }
+    }
+    active_txn_[txn_id] = log_record->lsn_;
+    auto &txn_records = txn_records_[txn_id];
+    if (log_record->log_record_type_ == LogRecordType::CLR) {
+      // the changes after undo_next_lsn have been undone before the crash
+      while (!txn_records.empty() && txn_records.back().lsn_ > log_record->undo_next_lsn_) {
+        txn_records.pop_back();
+      }
+    } else {
+      txn_records.push_back(*log_record);
+    }
+    return true;
+  });
+
+  for (size_t i = 0; i < num_workers_; i++) {
+    if (!batches[i].empty()) {
+      queues[i]->Push(std::move(batches[i]));
+    }
+    queues[i]->Close();
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  if (log_manager_ != nullptr) {
+    log_manager_->SetNextLSN(max_lsn_ + 1);
+  }
+}
+
+page_id_t LogRecovery::GetPageId(const LogRecord &log_record) {
+  switch (log_record.GetRedoType()) {
+    case LogRecordType::INSERT:
+      return log_record.insert_rid_.GetPageId();
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      return log_record.delete_rid_.GetPageId();
+    case LogRecordType::UPDATE:
+      return log_record.update_rid_.GetPageId();
+    case LogRecordType::NEWPAGE:
+      return log_record.page_id_;
+    default:
+      return INVALID_PAGE_ID;
+  }
+}
+
+void LogRecovery::RedoWorker(RedoQueue *queue) {
+  std::vector<RedoTask> batch;
+  page_id_t page_id = INVALID_PAGE_ID;
+  TablePage *page = nullptr;
+  bool is_dirty = false;
+  while (queue->Pop(&batch)) {
+    for (auto &task : batch) {
+      // consecutive records mostly hit the same page, keep it pinned until another page comes up
+      if (task.page_id_ != page_id) {
+        if (page != nullptr) {
+          buffer_pool_manager_->UnpinPage(page_id, is_dirty);
+        }
+        page_id = task.page_id_;
+        page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+        BUSTUB_ASSERT(page != nullptr, "Redo cannot run out of frames.");
+        is_dirty = false;
+      }
+      if (page->GetLSN() < task.log_record_.lsn_) {
+        RedoLogRecord(page, &task);
+        is_dirty = true;
+      }
+    }
+  }
+  if (page != nullptr) {
+    buffer_pool_manager_->UnpinPage(page_id, is_dirty);
+  }
+}
+
+void LogRecovery::RedoLogRecord(TablePage *page, RedoTask *task) {
+  LogRecord &log_record = task->log_record_;
+  switch (log_record.GetRedoType()) {
+    case LogRecordType::INSERT: {
+      RID rid;
+      page->InsertTuple(log_record.insert_tuple_, &rid, nullptr, nullptr, nullptr);
+      if (!(rid == log_record.insert_rid_)) {
+        LOG_WARN("Redo of LSN %d inserted into slot %u, not %u", log_record.lsn_, rid.GetSlotNum(),
+                 log_record.insert_rid_.GetSlotNum());
+      }
+      break;
+    }
+    case LogRecordType::MARKDELETE:
+      page->MarkDelete(log_record.delete_rid_, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE:
+      page->ApplyDelete(log_record.delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::ROLLBACKDELETE:
+      page->RollbackDelete(log_record.delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE: {
+      // the page is older than the record, so it holds the tuple the update started from
+      Tuple old_tuple;
+      Tuple new_tuple;
+      if (page->GetTuple(log_record.update_rid_, &old_tuple, nullptr, nullptr) &&
+          log_record.ApplyUpdate(old_tuple, true, &new_tuple)) {
+        page->UpdateTuple(new_tuple, &old_tuple, log_record.update_rid_, nullptr, nullptr, nullptr);
+      } else {
+        LOG_WARN("cannot redo update of %s", log_record.update_rid_.ToString().c_str());
+      }
+      break;
+    }
+    case LogRecordType::NEWPAGE:
+      if (task->page_id_ != log_record.page_id_) {
+        // linking the previous page to the new one is part of creating the new page and leaves the page LSN alone
+        page->SetNextPageId(log_record.page_id_);
+        return;
+      }
+      page->Init(log_record.page_id_, PAGE_SIZE, log_record.prev_page_id_, nullptr, nullptr);
+      break;
+    default:
+      break;
+  }
+  page->SetLSN(log_record.lsn_);
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
- *iterate through active txn map and undo each operation
+ *roll back every transaction left in the active txn map, in parallel
  */
-void LogRecovery::Undo() {}
+void LogRecovery::Undo() {
+  BUSTUB_ASSERT(!enable_logging, "Recovery must run before logging is enabled.");
+  std::vector<std::pair<txn_id_t, std::vector<LogRecord> *>> losers;
+  losers.reserve(txn_records_.size());
+  for (auto &txn_records : txn_records_) {
+    losers.emplace_back(txn_records.first, &txn_records.second);
+  }
+  // transactions never touch the same tuple, so they roll back independently
+  std::atomic<size_t> next_loser{0};
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < std::min(num_workers_, losers.size()); i++) {
+    workers.emplace_back([&] {
+      for (size_t loser = next_loser++; loser < losers.size(); loser = next_loser++) {
+        UndoTransaction(losers[loser].first, active_txn_.at(losers[loser].first), losers[loser].second);
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  if (log_manager_ != nullptr) {
+    // the buffer pool only follows the write-ahead rule once logging is enabled
+    log_manager_->Flush(log_manager_->GetNextLSN() - 1);
+  }
+  active_txn_.clear();
+  txn_records_.clear();
+}
+
+void LogRecovery::UndoTransaction(txn_id_t txn_id, lsn_t last_lsn, std::vector<LogRecord> *log_records) {
+  for (auto it = log_records->rbegin(); it != log_records->rend(); ++it) {
+    LogRecord &log_record = *it;
+    if (log_record.log_record_type_ == LogRecordType::NEWPAGE) {
+      // a new page stays, it is simply empty once everything on it is undone
+      continue;
+    }
+    const page_id_t page_id = GetPageId(log_record);
+    auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Undo cannot run out of frames.");
+    // other transactions are undone on the same page at the same time
+    page->WLatch();
+    // the compensating change, logged once it is applied and the page is still latched
+    std::optional<LogRecord> clr;
+    switch (log_record.log_record_type_) {
+      case LogRecordType::INSERT:
+        page->ApplyDelete(log_record.insert_rid_, nullptr, nullptr);
+        clr.emplace(txn_id, last_lsn, LogRecordType::APPLYDELETE, log_record.insert_rid_, log_record.insert_tuple_);
+        break;
+      case LogRecordType::MARKDELETE:
+        page->RollbackDelete(log_record.delete_rid_, nullptr, nullptr);
+        clr.emplace(txn_id, last_lsn, LogRecordType::ROLLBACKDELETE, log_record.delete_rid_, log_record.delete_tuple_);
+        break;
+      case LogRecordType::APPLYDELETE: {
+        RID rid;
+        if (page->InsertTuple(log_record.delete_tuple_, &rid, nullptr, nullptr, nullptr)) {
+          clr.emplace(txn_id, last_lsn, LogRecordType::INSERT, rid, log_record.delete_tuple_);
+        }
+        break;
+      }
+      case LogRecordType::ROLLBACKDELETE:
+        page->MarkDelete(log_record.delete_rid_, nullptr, nullptr, nullptr);
+        clr.emplace(txn_id, last_lsn, LogRecordType::MARKDELETE, log_record.delete_rid_, log_record.delete_tuple_);
+        break;
+      case LogRecordType::UPDATE: {
+        // later changes of the transaction are undone already, so the page holds the tuple the update ended with
+        Tuple new_tuple;
+        Tuple old_tuple;
+        if (page->GetTuple(log_record.update_rid_, &new_tuple, nullptr, nullptr) &&
+            log_record.ApplyUpdate(new_tuple, false, &old_tuple)) {
+          page->UpdateTuple(old_tuple, &new_tuple, log_record.update_rid_, nullptr, nullptr, nullptr);
+          clr.emplace(txn_id, last_lsn, LogRecordType::UPDATE, log_record.update_rid_, new_tuple, old_tuple);
+        } else {
+          LOG_WARN("cannot undo update of %s", log_record.update_rid_.ToString().c_str());
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    if (log_manager_ != nullptr && clr.has_value()) {
+      clr->MakeCompensation(log_record.prev_lsn_);
+      last_lsn = log_manager_->AppendLogRecord(&*clr);
+      page->SetLSN(last_lsn);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+  }
+  if (log_manager_ != nullptr) {
+    LogRecord abort(txn_id, last_lsn, LogRecordType::ABORT);
+    log_manager_->AppendLogRecord(&abort);
+  }
+}
 
 }  // namespace bustub
@@ -0,0 +1,339 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// direct_disk_manager.cpp
+//
+// Identification: src/storage/disk/direct_disk_manager.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/direct_disk_manager.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+struct DirectDiskManager::Request {
+  /** True for a write, false for a read. */
+  bool write_;
+  /** Page to read or write. */
+  page_id_t page_id_;
+  /** The caller's buffer. */
+  char *data_;
+  /** Aligned copy of the caller's buffer if it is not suitably aligned for O_DIRECT, nullptr otherwise. */
+  char *bounce_;
+  /** Fulfilled once the request has completed, unless there is an on_done_. */
+  std::promise<void> promise_;
+  /** When the request was made, for the latency histograms. */
+  std::chrono::steady_clock::time_point start_;
+  /** Called instead of fulfilling promise_ once the request has completed, if set. */
+  io_done_fn on_done_;
+
+  /** @return the buffer that is handed to the kernel */
+  char *Buffer() const { return bounce_ != nullptr ? bounce_ : data_; }
+};
+
+static_assert(PAGE_SIZE % 4096 == 0, "O_DIRECT page I/O needs the page size to be a multiple of the block size.");
+
+static int IoUringSetup(uint32_t entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int IoUringEnter(int ring_fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int IoUringRegister(int ring_fd, uint32_t opcode, void *arg, uint32_t nr_args) {
+  return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+/**
+ * Constructor: open the database file with O_DIRECT & set up the io_uring
+ * @input db_file: database file name
+ */
+DirectDiskManager::DirectDiskManager(const std::string &db_file, uint32_t queue_depth) : DiskManager(db_file) {
+  // DiskManager created the file, from now on it is only accessed through fd_
+  db_io_.close();
+  fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+  direct_ = fd_ >= 0;
+  if (fd_ < 0 && errno == EINVAL) {
+    // e.g. tmpfs does not support O_DIRECT
+    LOG_WARN("O_DIRECT is not supported for %s, going through the page cache", db_file.c_str());
+    fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  SetUpRing(queue_depth);
+}
+
+DirectDiskManager::~DirectDiskManager() {
+  if (IsAsync()) {
+    ShutDownRing();
+  }
+  close(fd_);
+}
+
+void DirectDiskManager::SetUpRing(uint32_t queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = IoUringSetup(queue_depth, &params);
+  if (ring_fd < 0) {
+    LOG_WARN("io_uring is not available (%s), falling back to synchronous I/O", strerror(errno));
+    return;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  const int prot = PROT_READ | PROT_WRITE;
+  const int flags = MAP_SHARED | MAP_POPULATE;
+  sq_ring_ = mmap(nullptr, sq_ring_size_, prot, flags, ring_fd, IORING_OFF_SQ_RING);
+  cq_ring_ = mmap(nullptr, cq_ring_size_, prot, flags, ring_fd, IORING_OFF_CQ_RING);
+  void *sqes = mmap(nullptr, sqes_size_, prot, flags, ring_fd, IORING_OFF_SQES);
+  int cq_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  int stop_fd = eventfd(0, EFD_CLOEXEC);
+  const bool events = cq_event_fd >= 0 && stop_fd >= 0 &&
+                      IoUringRegister(ring_fd, IORING_REGISTER_EVENTFD, &cq_event_fd, 1) == 0;
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes == MAP_FAILED || !events) {
+    LOG_WARN("could not map the io_uring or register its eventfd, falling back to synchronous I/O");
+    if (cq_event_fd >= 0) {
+      close(cq_event_fd);
+    }
+    if (stop_fd >= 0) {
+      close(stop_fd);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (cq_ring_ != MAP_FAILED) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sqes != MAP_FAILED) {
+      munmap(sqes, sqes_size_);
+    }
+    close(ring_fd);
+    return;
+  }
+
+  auto *sq_ring = static_cast<char *>(sq_ring_);
+  auto *cq_ring = static_cast<char *>(cq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq_ring + params.cq_off.cqes);
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+  // the completion ring is at least as large as the submission ring, so bounding the requests in flight by the
+  // submission ring also guarantees that completions never overflow
+  sq_entries_ = params.sq_entries;
+  cq_event_fd_ = cq_event_fd;
+  stop_fd_ = stop_fd;
+  ring_fd_ = ring_fd;
+  reaper_ = std::thread(&DirectDiskManager::ReapCompletions, this);
+}
+
+void DirectDiskManager::ShutDownRing() {
+  {
+    std::scoped_lock lock(submit_latch_);
+    stop_ = true;
+  }
+  // wakes the reaper up in case nothing is in flight, unlike a request this cannot fail to reach it
+  const uint64_t one = 1;
+  while (write(stop_fd_, &one, sizeof(one)) < 0 && errno == EINTR) {
+  }
+  reaper_.join();
+  munmap(sqes_, sqes_size_);
+  munmap(cq_ring_, cq_ring_size_);
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+  close(cq_event_fd_);
+  close(stop_fd_);
+  ring_fd_ = -1;
+}
+
+/**
+ * Write the contents of the specified page into disk file, waiting for the write
+ */
+void DirectDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  WritePageAsync(page_id, page_data).get();
+}
+
+/**
+ * Read the contents of the specified page into the given memory area, waiting for the read
+ */
+void DirectDiskManager::ReadPage(page_id_t page_id, char *page_data) { ReadPageAsync(page_id, page_data).get(); }
+
+std::future<void> DirectDiskManager::WritePageAsync(page_id_t page_id, const char *page_data) {
+  // the kernel only reads from the buffer of a write
+  auto *request = new Request{
+      true, page_id, const_cast<char *>(page_data), nullptr, {}, std::chrono::steady_clock::now(), nullptr};
+  if (reinterpret_cast<uintptr_t>(page_data) % IO_ALIGNMENT != 0) {
+    request->bounce_ = static_cast<char *>(std::aligned_alloc(IO_ALIGNMENT, PAGE_SIZE));
+    memcpy(request->bounce_, page_data, PAGE_SIZE);
+  }
+  auto future = request->promise_.get_future();
+  {
+    std::scoped_lock lock(submit_latch_);
+    num_writes_ += 1;
+  }
+  if (IsAsync()) {
+    Submit(request);
+  } else {
+    SyncIO(request);
+  }
+  return future;
+}
+
+std::future<void> DirectDiskManager::ReadPageAsync(page_id_t page_id, char *page_data) {
+  auto *request = new Request{false, page_id, page_data, nullptr, {}, std::chrono::steady_clock::now(), nullptr};
+  auto future = request->promise_.get_future();
+  SubmitRead(request);
+  return future;
+}
+
+void DirectDiskManager::ReadPageAsync(page_id_t page_id, char *page_data, io_done_fn on_done) {
+  auto *request = new Request{false, page_id, page_data, nullptr, {}, std::chrono::steady_clock::now(), nullptr};
+  request->on_done_ = std::move(on_done);
+  SubmitRead(request);
+}
+
+void DirectDiskManager::SubmitRead(Request *request) {
+  if (reinterpret_cast<uintptr_t>(request->data_) % IO_ALIGNMENT != 0) {
+    request->bounce_ = static_cast<char *>(std::aligned_alloc(IO_ALIGNMENT, PAGE_SIZE));
+  }
+  if (IsAsync()) {
+    Submit(request);
+  } else {
+    SyncIO(request);
+  }
+}
+
+void DirectDiskManager::Submit(Request *request) {
+  std::unique_lock lock(submit_latch_);
+  slot_cv_.wait(lock, [&] { return in_flight_ < sq_entries_; });
+
+  // only submitters touch the tail, and they are serialized by submit_latch_
+  const unsigned tail = *sq_tail_;
+  const unsigned index = tail & *sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = request->write_ ? IORING_OP_WRITE : IORING_OP_READ;
+  sqe->fd = fd_;
+  sqe->off = static_cast<uint64_t>(request->page_id_) * PAGE_SIZE;
+  sqe->addr = reinterpret_cast<uint64_t>(request->Buffer());
+  sqe->len = PAGE_SIZE;
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  // publish the entry before the kernel can see the new tail
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  in_flight_ += 1;
+
+  int submitted;
+  do {
+    submitted = IoUringEnter(ring_fd_, 1, 0, 0);
+  } while (submitted < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY));
+  if (submitted < 0) {
+    // the kernel did not take the entry: take it back and fail the request, instead of leaving it in flight forever
+    const int error = errno;
+    LOG_ERROR("io_uring_enter failed: %s", strerror(error));
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    in_flight_ -= 1;
+    lock.unlock();
+    slot_cv_.notify_one();
+    Complete(request, -error);
+  }
+}
+
+void DirectDiskManager::ReapCompletions() {
+  while (true) {
+    // only the reaper touches the head
+    const unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      bool stop;
+      {
+        std::scoped_lock lock(submit_latch_);
+        if (stop_ && in_flight_ == 0) {
+          return;
+        }
+        stop = stop_;
+      }
+      // once stopping, stop_fd_ stays readable, so only the completions of the requests in flight are waited for
+      pollfd fds[2] = {{cq_event_fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+      if (poll(fds, stop ? 1 : 2, -1) < 0 && errno != EINTR) {
+        LOG_ERROR("poll failed while waiting for completions: %s", strerror(errno));
+      }
+      // reset the eventfd before looking at the ring again, so that no completion goes unnoticed
+      uint64_t count;
+      while (read(cq_event_fd_, &count, sizeof(count)) < 0 && errno == EINTR) {
+      }
+      continue;
+    }
+    const io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+    auto *request = reinterpret_cast<Request *>(cqe.user_data);
+    const int result = cqe.res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+
+    Complete(request, result);
+    {
+      std::scoped_lock lock(submit_latch_);
+      in_flight_ -= 1;
+    }
+    slot_cv_.notify_one();
+  }
+}
+
+void DirectDiskManager::Complete(Request *request, int result) {
+  std::exception_ptr error;
+  if (result < 0) {
+    LOG_DEBUG("I/O error on page %d: %s", request->page_id_, strerror(-result));
+    error = std::make_exception_ptr(
+        Exception(std::string(request->write_ ? "write" : "read") + " failed: " + strerror(-result)));
+  } else if (request->write_ && result < PAGE_SIZE) {
+    error = std::make_exception_ptr(Exception("short write"));
+  } else if (!request->write_) {
+    // if file ends before reading PAGE_SIZE
+    memset(request->Buffer() + result, 0, PAGE_SIZE - result);
+    if (request->bounce_ != nullptr) {
+      memcpy(request->data_, request->bounce_, PAGE_SIZE);
+    }
+  }
+  (request->write_ ? write_latency_ : read_latency_).Record(std::chrono::steady_clock::now() - request->start_);
+  if (request->on_done_) {
+    request->on_done_(error);
+  } else if (error != nullptr) {
+    request->promise_.set_exception(error);
+  } else {
+    request->promise_.set_value();
+  }
+  std::free(request->bounce_);
+  delete request;
+}
+
+void DirectDiskManager::SyncIO(Request *request) {
+  const off_t offset = static_cast<off_t>(request->page_id_) * PAGE_SIZE;
+  ssize_t result = request->write_ ? pwrite(fd_, request->Buffer(), PAGE_SIZE, offset)
+                                   : pread(fd_, request->Buffer(), PAGE_SIZE, offset);
+  Complete(request, result < 0 ? -errno : static_cast<int>(result));
+}
+
+}  // namespace bustub
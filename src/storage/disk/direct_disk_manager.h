@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// direct_disk_manager.h
+//
+// Identification: src/storage/disk/direct_disk_manager.h
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <linux/io_uring.h>
+
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
+#include <mutex>               // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DirectDiskManager bypasses the OS page cache: the database file is opened with O_DIRECT, so pages are only cached
+ * once, in the buffer pool. Page I/O is submitted through an io_uring, which lets callers keep many reads and writes
+ * in flight with ReadPageAsync/WritePageAsync. A single background thread reaps completions and fulfills the futures.
+ *
+ * If the kernel does not support io_uring, pages are read and written synchronously with pread/pwrite instead. If the
+ * file system does not support O_DIRECT, the file is opened without it. The log file is still handled by DiskManager.
+ */
+class DirectDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param queue_depth the maximum number of page I/Os in flight, further requests wait for a free slot
+   */
+  explicit DirectDiskManager(const std::string &db_file, uint32_t queue_depth = 64);
+
+  ~DirectDiskManager() override;
+
+  /**
+   * Write a page to the database file, waiting for the write to complete.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Read a page from the database file, waiting for the read to complete.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Submits a page write to the io_uring.
+   * @param page_id id of the page
+   * @param page_data raw page data, must stay valid until the future is ready
+   * @return a future that becomes ready once the page has been written, it holds an Exception if the write failed
+   */
+  std::future<void> WritePageAsync(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Submits a page read to the io_uring. Reading past the end of the file yields zeros.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, must stay valid until the future is ready
+   * @return a future that becomes ready once page_data has been filled, it holds an Exception if the read failed
+   */
+  std::future<void> ReadPageAsync(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Submits a page read to the io_uring, on_done is called by the reaper once the read has completed.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, must stay valid until on_done is called
+   * @param on_done called with nullptr once page_data has been filled, or with an Exception if the read failed
+   */
+  void ReadPageAsync(page_id_t page_id, char *page_data, io_done_fn on_done) override;
+
+  /** @return true if page I/O goes through an io_uring, false if it falls back to synchronous pread/pwrite */
+  bool IsAsync() const { return ring_fd_ >= 0; }
+
+  /** @return true if the database file was opened with O_DIRECT */
+  bool IsDirect() const { return direct_; }
+
+ private:
+  /** An I/O request in flight, passed to the kernel as the user_data of its submission. */
+  struct Request;
+
+  /** O_DIRECT requires buffers, offsets and sizes to be aligned to the logical block size of the device. */
+  static constexpr size_t IO_ALIGNMENT = 4096;
+
+  /** Sets up the io_uring and maps its rings. Leaves ring_fd_ at -1 if io_uring is not available. */
+  void SetUpRing(uint32_t queue_depth);
+
+  /** Issues a read request, allocating its bounce buffer if the caller's buffer is not aligned. */
+  void SubmitRead(Request *request);
+
+  /**
+   * Queues one request on the submission ring and tells the kernel about it. If the kernel does not take it, the
+   * request is taken off the ring again and fails like any other request.
+   */
+  void Submit(Request *request);
+
+  /**
+   * Reaps completions until ShutDownRing asks it to stop. Runs on reaper_. It sleeps in poll() on the eventfd the ring
+   * signals completions on and on stop_fd_, so that stopping never depends on getting a request through the ring.
+   */
+  void ReapCompletions();
+
+  /** Copies the result of a finished request back and fulfills its promise. */
+  void Complete(Request *request, int result);
+
+  /** Synchronous pread/pwrite, used when io_uring is not available. */
+  void SyncIO(Request *request);
+
+  /** Waits for every request in flight, stops the reaper and unmaps the rings. */
+  void ShutDownRing();
+
+  /** File descriptor of the database file. */
+  int fd_{-1};
+  /** True if fd_ was opened with O_DIRECT. */
+  bool direct_{false};
+
+  /** File descriptor of the io_uring, -1 if io_uring is not available. */
+  int ring_fd_{-1};
+  /** Mapped submission queue ring, completion queue ring and submission queue entries. */
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  /** Pointers into the mapped rings. */
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+  /** Number of submission queue entries, which bounds the number of requests in flight. */
+  uint32_t sq_entries_{0};
+  /** eventfd registered with the ring, it is signalled for every completion. */
+  int cq_event_fd_{-1};
+  /** eventfd that ShutDownRing signals to wake the reaper up. */
+  int stop_fd_{-1};
+
+  /** Protects the submission ring, in_flight_ and stop_. */
+  std::mutex submit_latch_;
+  /** Signalled when a request completes, to wake up submitters waiting for a free slot. */
+  std::condition_variable slot_cv_;
+  /** Number of submitted requests that have not completed yet. */
+  uint32_t in_flight_{0};
+  /** True once the reaper has been asked to stop. */
+  bool stop_{false};
+  /** The thread reaping completions. */
+  std::thread reaper_;
+};
+
+}  // namespace bustub
@@ -10,9 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <string>
 #include <thread>  // NOLINT
@@ -41,19 +47,43 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file), next
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  master_name_ = file_name_.substr(0, n) + ".master";
+  manifest_name_ = file_name_.substr(0, n) + ".manifest";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
+  int32_t first_segment = 0;
+  int fd = open(manifest_name_.c_str(), O_RDONLY);
+  bool has_manifest =
+      fd >= 0 && read(fd, &first_segment, sizeof(first_segment)) == static_cast<ssize_t>(sizeof(first_segment));
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (!has_manifest) {
+    // segments of an earlier log that is gone
+    std::filesystem::path log_path(log_name_);
+    const std::string prefix = log_path.filename().string() + ".";
+    std::error_code error;
+    auto dir = log_path.has_parent_path() ? log_path.parent_path() : std::filesystem::path(".");
+    for (const auto &entry : std::filesystem::directory_iterator(dir, error)) {
+      const std::string name = entry.path().filename().string();
+      if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+          std::all_of(name.begin() + prefix.size(), name.end(), [](char c) { return isdigit(c) != 0; })) {
+        std::filesystem::remove(entry.path(), error);
+      }
     }
+    first_segment = 0;
+    WriteManifest(first_segment);
+  }
+  first_segment_ = first_segment;
+  // the log ends in the last segment there is
+  int last_segment = first_segment_;
+  while (GetFileSize(GetSegmentName(last_segment + 1)) >= 0) {
+    last_segment++;
+  }
+  log_size_ = static_cast<log_offset_t>(last_segment) * LOG_SEGMENT_SIZE +
+              std::max(GetFileSize(GetSegmentName(last_segment)), 0);
+  if (log_size_ == 0) {
+    // a checkpoint of an earlier log that is gone
+    remove(master_name_.c_str());
   }
 
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
@@ -77,7 +107,25 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file), next
  */
 void DiskManager::ShutDown() {
   db_io_.close();
-  log_io_.close();
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
+    log_fd_segment_ = -1;
+  }
+  if (read_fd_ >= 0) {
+    close(read_fd_);
+    read_fd_ = -1;
+    read_fd_segment_ = -1;
+  }
+}
+
+DiskManager::~DiskManager() {
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
+  if (read_fd_ >= 0) {
+    close(read_fd_);
+  }
 }
 
 /**
@@ -85,6 +133,8 @@ void DiskManager::ShutDown() {
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+  LatencyTimer timer(&write_latency_);
+  std::scoped_lock db_io_lock(db_io_latch_);
   // set write cursor to offset
   num_writes_ += 1;
   db_io_.seekp(offset);
@@ -103,6 +153,8 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   int offset = page_id * PAGE_SIZE;
+  LatencyTimer timer(&read_latency_);
+  std::scoped_lock db_io_lock(db_io_latch_);
   // check if read beyond file length
   if (offset > GetFileSize(file_name_)) {
     LOG_DEBUG("I/O error reading past end of file");
@@ -126,17 +178,59 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   }
 }
 
+/**
+ * Write the contents of the specified page into disk file, synchronously
+ */
+std::future<void> DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) {
+  std::promise<void> promise;
+  try {
+    WritePage(page_id, page_data);
+    promise.set_value();
+  } catch (const Exception &e) {
+    promise.set_exception(std::current_exception());
+  }
+  return promise.get_future();
+}
+
+/**
+ * Read the contents of the specified page into the given memory area, synchronously
+ */
+std::future<void> DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) {
+  std::promise<void> promise;
+  try {
+    ReadPage(page_id, page_data);
+    promise.set_value();
+  } catch (const Exception &e) {
+    promise.set_exception(std::current_exception());
+  }
+  return promise.get_future();
+}
+
+/**
+ * Read the contents of the specified page into the given memory area, synchronously, and report to on_done
+ */
+void DiskManager::ReadPageAsync(page_id_t page_id, char *page_data, io_done_fn on_done) {
+  std::exception_ptr error;
+  try {
+    ReadPage(page_id, page_data);
+  } catch (const Exception &e) {
+    error = std::current_exception();
+  }
+  on_done(error);
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
+ * @return: false means the log could not be written or synced, nothing of it may be considered durable
  */
-void DiskManager::WriteLog(char *log_data, int size) {
+bool DiskManager::WriteLog(char *log_data, int size) {
   // enforce swap log buffer
   assert(log_data != buffer_used);
   buffer_used = log_data;
 
   if (size == 0) {  // no effect on num_flushes_ if log buffer is empty
-    return;
+    return true;
   }
 
   flush_log_ = true;
@@ -147,17 +241,33 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
-    return;
+  // sequence write, continuing in the next segment once one is full
+  log_offset_t offset = log_size_;
+  while (size > 0) {
+    const int segment = static_cast<int>(offset / LOG_SEGMENT_SIZE);
+    const bool opened = segment == log_fd_segment_ || OpenWriteSegment(segment);
+    const log_offset_t segment_end = static_cast<log_offset_t>(segment + 1) * LOG_SEGMENT_SIZE;
+    const auto length = static_cast<int>(std::min<log_offset_t>(size, segment_end - offset));
+    const ssize_t written = !opened || log_fd_ < 0 ? -1 : write(log_fd_, log_data, length);
+    // check for I/O error
+    if (written <= 0) {
+      LOG_DEBUG("I/O error while writing log");
+      log_size_ = offset;
+      flush_log_ = false;
+      return false;
+    }
+    log_data += written;
+    size -= written;
+    offset += written;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
+  log_size_ = offset;
   flush_log_ = false;
+  // sync to make the log durable, earlier segments were synced when the log moved on from them
+  if (fdatasync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+    return false;
+  }
+  return true;
 }
 
 /**
@@ -165,26 +275,180 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * Always read from the beginning and perform sequence read
  * @return: false means already reach the end
  */
-bool DiskManager::ReadLog(char *log_data, int size, int offset) {
-  if (offset >= GetFileSize(log_name_)) {
+bool DiskManager::ReadLog(char *log_data, int size, log_offset_t offset) {
+  const log_offset_t log_size = log_size_;
+  if (offset >= log_size) {
     // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
-
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while reading log");
+  if (offset < GetLogStart()) {
+    LOG_DEBUG("reading truncated log");
     return false;
   }
+  const log_offset_t end = std::min(offset + size, log_size);
+  int read_count = 0;
+  while (offset + read_count < end) {
+    const log_offset_t position = offset + read_count;
+    const int segment = static_cast<int>(position / LOG_SEGMENT_SIZE);
+    if (segment != read_fd_segment_) {
+      if (read_fd_ >= 0) {
+        close(read_fd_);
+      }
+      read_fd_ = open(GetSegmentName(segment).c_str(), O_RDONLY);
+      read_fd_segment_ = segment;
+    }
+    const log_offset_t segment_start = static_cast<log_offset_t>(segment) * LOG_SEGMENT_SIZE;
+    const auto length = static_cast<int>(std::min<log_offset_t>(end, segment_start + LOG_SEGMENT_SIZE) - position);
+    const ssize_t count =
+        read_fd_ < 0 ? -1 : pread(read_fd_, log_data + read_count, length, position - segment_start);
+    if (count < 0) {
+      LOG_DEBUG("I/O error while reading log");
+      return false;
+    }
+    if (count == 0) {
+      break;
+    }
+    read_count += count;
+  }
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
-  if (read_count < size) {
-    log_io_.clear();
-    memset(log_data + read_count, 0, size - read_count);
+  memset(log_data + read_count, 0, size - read_count);
+  return true;
+}
+
+/**
+ * Returns the size of the log
+ */
+log_offset_t DiskManager::GetLogSize() { return log_size_; }
+
+/**
+ * Returns where the part of the log that has not been truncated starts
+ */
+log_offset_t DiskManager::GetLogStart() { return static_cast<log_offset_t>(first_segment_) * LOG_SEGMENT_SIZE; }
+
+/**
+ * Record the new start of the log in the manifest first, so that a crash never leaves a manifest behind that points
+ * at a dropped segment, then drop the segments before it
+ */
+void DiskManager::TruncateLog(log_offset_t offset) {
+  std::scoped_lock truncate_lock(truncate_latch_);
+  if (log_name_.empty()) {
+    return;
+  }
+  const int old_first_segment = first_segment_;
+  const int first_segment = std::max(static_cast<int>(offset / LOG_SEGMENT_SIZE), old_first_segment);
+  WriteManifest(first_segment);
+  first_segment_ = first_segment;
+  for (int segment = old_first_segment; segment < first_segment; segment++) {
+    const std::string segment_name = GetSegmentName(segment);
+    if (archive_dir_.empty()) {
+      remove(segment_name.c_str());
+      continue;
+    }
+    const auto archive_name = std::filesystem::path(archive_dir_) / std::filesystem::path(segment_name).filename();
+    if (rename(segment_name.c_str(), archive_name.c_str()) != 0) {
+      LOG_WARN("can't archive log segment %s", segment_name.c_str());
+    }
+  }
+}
+
+/**
+ * Sets where TruncateLog moves dropped segments
+ */
+void DiskManager::SetLogArchiveDirectory(const std::string &archive_dir) {
+  std::scoped_lock truncate_lock(truncate_latch_);
+  archive_dir_ = archive_dir;
+}
+
+/**
+ * Private helper function to get the file name of a log segment
+ */
+std::string DiskManager::GetSegmentName(int segment) const { return log_name_ + "." + std::to_string(segment); }
+
+/**
+ * Private helper function to switch the log over to a segment, syncing the segment it leaves
+ */
+bool DiskManager::OpenWriteSegment(int segment) {
+  bool synced = true;
+  if (log_fd_ >= 0) {
+    if (fdatasync(log_fd_) != 0) {
+      LOG_DEBUG("I/O error while syncing log");
+      synced = false;
+    }
+    close(log_fd_);
   }
+  const std::string segment_name = GetSegmentName(segment);
+  const bool create = GetFileSize(segment_name) < 0;
+  log_fd_ = open(segment_name.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  log_fd_segment_ = segment;
+  if (log_fd_ < 0) {
+    LOG_DEBUG("can't open log segment");
+    return false;
+  }
+  if (create) {
+    // the directory entry of a new segment has to be durable as well
+    std::filesystem::path segment_path(segment_name);
+    auto dir = segment_path.has_parent_path() ? segment_path.parent_path() : std::filesystem::path(".");
+    int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir_fd >= 0) {
+      synced = fsync(dir_fd) == 0 && synced;
+      close(dir_fd);
+    }
+  }
+  return synced;
+}
 
+/**
+ * Private helper function to write a small file durably, replacing the old file only once the new one is complete
+ */
+static bool WriteFileDurably(const std::string &file_name, const void *data, size_t size) {
+  const std::string tmp_name = file_name + ".tmp";
+  int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool written = write(fd, data, size) == static_cast<ssize_t>(size) && fsync(fd) == 0;
+  close(fd);
+  return written && rename(tmp_name.c_str(), file_name.c_str()) == 0;
+}
+
+/**
+ * Private helper function to write the manifest
+ */
+void DiskManager::WriteManifest(int first_segment) {
+  const int32_t manifest = first_segment;
+  if (!WriteFileDurably(manifest_name_, &manifest, sizeof(manifest))) {
+    throw Exception("I/O error while writing log manifest");
+  }
+}
+
+/**
+ * Write the master record into a temporary file and rename it over the old one, so that a crash leaves either the
+ * old or the new master record behind
+ */
+void DiskManager::WriteMasterRecord(lsn_t checkpoint_lsn, log_offset_t offset) {
+  const int64_t record[2] = {checkpoint_lsn, offset};
+  if (!WriteFileDurably(master_name_, record, sizeof(record))) {
+    throw Exception("I/O error while writing master record");
+  }
+}
+
+/**
+ * Read the master record
+ * @return: false means there is no complete checkpoint
+ */
+bool DiskManager::ReadMasterRecord(lsn_t *checkpoint_lsn, log_offset_t *offset) {
+  int fd = open(master_name_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  int64_t record[2];
+  bool read_all = read(fd, record, sizeof(record)) == static_cast<ssize_t>(sizeof(record));
+  close(fd);
+  if (!read_all) {
+    return false;
+  }
+  *checkpoint_lsn = static_cast<lsn_t>(record[0]);
+  *offset = record[1];
   return true;
 }
 
@@ -211,6 +475,19 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns the page I/O statistics
+ */
+DiskManagerStats DiskManager::GetStats() const { return {read_latency_.Snapshot(), write_latency_.Snapshot()}; }
+
+/**
+ * Drops the page I/O statistics
+ */
+void DiskManager::ResetStats() {
+  read_latency_.Reset();
+  write_latency_.Reset();
+}
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -32,6 +32,7 @@ DiskManagerMemory::DiskManagerMemory() { memory_ = new char[1 << 30]; }
  */
 void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
   size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+  LatencyTimer timer(&write_latency_);
   // set write cursor to offset
   num_writes_ += 1;
   memcpy(memory_ + offset, page_data, PAGE_SIZE);
@@ -42,6 +43,7 @@ void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
  */
 void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
   int offset = page_id * PAGE_SIZE;
+  LatencyTimer timer(&read_latency_);
   memcpy(page_data, memory_ + offset, PAGE_SIZE);
 }
 
@@ -53,14 +53,23 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID;
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  // use find leaf Page
-  page_ptr<LeafPage> leaf = FindLeafPage(key, SEARCH, transaction);
-  ValueType val;
-  if (leaf->Lookup(key, &val, comparator_)) {
-    result->push_back(val);
-    return true;
+  while (true) {
+    uint64_t version;
+    Page *leaf = FindLeafPageOptimistic(key, false, &version);
+    if (leaf == nullptr) {
+      return false;
+    }
+    ValueType val;
+    bool found = reinterpret_cast<LeafPage *>(leaf->GetData())->Lookup(key, &val, comparator_);
+    bool valid = leaf->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+    if (valid) {
+      if (found) {
+        result->push_back(val);
+      }
+      return found;
+    }
   }
-  return false;
 }
 
 /*****************************************************************************
@@ -104,6 +113,8 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   if (new_root_page.is_null()) {
     throw Exception(ExceptionType::OUT_OF_MEMORY, "StartNew tree");
   }
+  // optimistic readers find the root before it is initialized
+  new_root_page.write_lock();
   new_root_page.mark_dirty(true);
   assert(!new_root_page.is_null());
   root_page_id_ = new_root_page.GetPageId();
@@ -178,6 +189,7 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
       unique_lock<shared_mutex> root_writelock(root_latch_);
       page_ptr<InternalPage> new_root_page = make_newpage<InternalPage>(buffer_pool_manager_);
       assert(!new_root_page.is_null());
+      new_root_page.write_lock();
       root_page_id_ = new_root_page.GetPageId();
       UpdateRootPageId();
       leaf->SetParentPageId(root_page_id_);
@@ -310,6 +322,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
       unique_lock<shared_mutex> root_writelock(root_latch_);
       page_ptr<InternalPage> new_root_page = make_newpage<InternalPage>(buffer_pool_manager_);
       assert(!new_root_page.is_null());
+      new_root_page.write_lock();
       root_page_id_ = new_root_page.GetPageId();
       UpdateRootPageId();
       new_root_page->Init(root_page_id_, INVALID_PAGE_ID, internal_max_size_);
@@ -641,7 +654,8 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
-  return INDEXITERATOR_TYPE(FindLeafPage(KeyType(), true), 0, buffer_pool_manager_);
+  uint64_t version;
+  return INDEXITERATOR_TYPE(FindLeafPageOptimistic(KeyType(), true, &version), 0, buffer_pool_manager_);
 }
 
 /*
@@ -651,9 +665,18 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  Page *leaf = FindLeafPage(key);
-  int index = reinterpret_cast<LeafPage *>(leaf)->KeyIndex(key, comparator_);
-  return INDEXITERATOR_TYPE(leaf, index, buffer_pool_manager_);
+  while (true) {
+    uint64_t version;
+    Page *leaf = FindLeafPageOptimistic(key, false, &version);
+    if (leaf == nullptr) {
+      return end();
+    }
+    int index = reinterpret_cast<LeafPage *>(leaf->GetData())->KeyIndex(key, comparator_);
+    if (leaf->ValidateVersion(version)) {
+      return INDEXITERATOR_TYPE(leaf, index, buffer_pool_manager_);
+    }
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+  }
 }
 
 /*
@@ -689,6 +712,86 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
   }
   return Page.move_page_out();
 }
+/*
+ * Find leaf page containing particular key without latching any page, if
+ * leftMost flag == true, find the left most leaf page.
+ * Every page is read optimistically: its version is read before and validated
+ * after the read, and the descent restarts from the root if a writer got in
+ * between. A child is pinned before the version of its parent is validated,
+ * so the child id read from the parent was still current when it was pinned.
+ * @return : the pinned leaf page, nullptr if the tree is empty. The caller
+ * validates its reads of the leaf against *version.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key, bool leftMost, uint64_t *version) {
+  while (true) {
+    page_id_t page_id = root_page_id_;
+    if (page_id == INVALID_PAGE_ID) {
+      return nullptr;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(page_id, AccessType::Lookup);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "FindLeafPageOptimistic");
+    }
+    uint64_t page_version = page->ReadVersion();
+    // the root may have been replaced before we got its version
+    bool valid = root_page_id_ == page_id;
+    while (valid) {
+      auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      if (!IsConsistent(node)) {
+        if (page->ValidateVersion(page_version)) {
+          buffer_pool_manager_->UnpinPage(page_id, false);
+          throw Exception("B+ tree page " + std::to_string(page_id) + " is corrupted");
+        }
+        break;
+      }
+      if (node->IsLeafPage()) {
+        *version = page_version;
+        return page;
+      }
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      page_id_t child_page_id;
+      try {
+        child_page_id = leftMost ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+      } catch (Exception &e) {
+        // the binary search gives up on keys that are out of order, which a torn read may see
+        if (page->ValidateVersion(page_version)) {
+          buffer_pool_manager_->UnpinPage(page_id, false);
+          throw;
+        }
+        break;
+      }
+      if (!page->ValidateVersion(page_version)) {
+        break;
+      }
+      Page *child = buffer_pool_manager_->FetchPage(child_page_id, AccessType::Lookup);
+      if (child == nullptr) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "FindLeafPageOptimistic");
+      }
+      uint64_t child_version = child->ReadVersion();
+      valid = page->ValidateVersion(page_version);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page = child;
+      page_id = child_page_id;
+      page_version = child_version;
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsConsistent(const BPlusTreePage *node) const {
+  // a page read while it is being modified may hold any size, make sure that searching it stays within the page
+  const int size = node->GetSize();
+  if (node->IsLeafPage()) {
+    return size >= 0 &&
+           size <= static_cast<int>((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, ValueType>));
+  }
+  return size >= node->GetMinSize() &&
+         size <= static_cast<int>((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, page_id_t>));
+}
+
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
@@ -21,27 +21,51 @@ INDEXITERATOR_TYPE::~IndexIterator() = default;
 INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::isEnd() {
   assert(!leaf_.is_null());
-  return leaf_->GetNextPageId() == INVALID_PAGE_ID && index_ == leaf_->GetSize() - 1;
+  while (true) {
+    uint64_t version = leaf_.get_page()->ReadVersion();
+    bool is_end = leaf_->GetNextPageId() == INVALID_PAGE_ID && index_ == leaf_->GetSize() - 1;
+    if (leaf_.get_page()->ValidateVersion(version)) {
+      return is_end;
+    }
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 const MappingType &INDEXITERATOR_TYPE::operator*() {
   assert(!leaf_.is_null());
-  return leaf_->GetItem(index_);
+  while (true) {
+    uint64_t version = leaf_.get_page()->ReadVersion();
+    item_ = leaf_->GetItem(index_);
+    if (leaf_.get_page()->ValidateVersion(version)) {
+      return item_;
+    }
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
   if (leaf_.is_null()) {
-  } else if (index_ != leaf_->GetSize() - 1) {
+    return *this;
+  }
+  int size;
+  page_id_t next_page_id;
+  while (true) {
+    uint64_t version = leaf_.get_page()->ReadVersion();
+    size = leaf_->GetSize();
+    next_page_id = leaf_->GetNextPageId();
+    if (leaf_.get_page()->ValidateVersion(version)) {
+      break;
+    }
+  }
+  if (index_ < size - 1) {
     index_++;
-  } else if (isEnd()) {
+  } else if (next_page_id == INVALID_PAGE_ID) {
     leaf_ = page_ptr<LeafPage>(nullptr, nullptr, false);
     index_ = 0;
   } else {
     index_ = 0;
     // const dereference ,no modification there
-    leaf_ = make_page<LeafPage>(bpm_, leaf_->GetNextPageId());
+    leaf_ = make_page<LeafPage>(bpm_, next_page_id);
   }
   return *this;
 }
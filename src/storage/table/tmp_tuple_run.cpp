@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_run.cpp
+//
+// Identification: src/storage/table/tmp_tuple_run.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tmp_tuple_run.h"
+
+#include <string>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TmpTupleRun::~TmpTupleRun() {
+  for (const auto page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+}
+
+void TmpTupleRun::Append(const Tuple &tuple) {
+  TmpTuple out(INVALID_PAGE_ID, 0);
+  if (!page_ids_.empty()) {
+    auto *page = reinterpret_cast<TmpTuplePage *>(bpm_->FetchPage(page_ids_.back()));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "No frame left to spill tuples to.");
+    }
+    const bool inserted = page->Insert(tuple, &out);
+    bpm_->UnpinPage(page_ids_.back(), inserted);
+    if (inserted) {
+      num_tuples_++;
+      size_ += tuple.GetLength();
+      return;
+    }
+  }
+  page_id_t page_id;
+  auto *page = reinterpret_cast<TmpTuplePage *>(bpm_->NewPage(&page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "No frame left to spill tuples to.");
+  }
+  page->Init(page_id, PAGE_SIZE);
+  if (!page->Insert(tuple, &out)) {
+    bpm_->UnpinPage(page_id, false);
+    bpm_->DeletePage(page_id);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Tuple of " + std::to_string(tuple.GetLength()) +
+                                                      " bytes is too large to spill onto a page.");
+  }
+  bpm_->UnpinPage(page_id, true);
+  page_ids_.push_back(page_id);
+  num_tuples_++;
+  size_ += tuple.GetLength();
+}
+
+bool TmpTupleRun::Reader::Next(Tuple *tuple) {
+  while (tuples_.empty()) {
+    if (next_page_ == run_->page_ids_.size()) {
+      return false;
+    }
+    const page_id_t page_id = run_->page_ids_[next_page_++];
+    auto *page = reinterpret_cast<TmpTuplePage *>(run_->bpm_->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "No frame left to read spilled tuples.");
+    }
+    // the page holds its tuples newest first, copy them out so that the page is pinned only briefly
+    for (uint32_t offset = page->GetFreeSpacePointer(); offset < PAGE_SIZE;) {
+      tuples_.emplace_back();
+      offset = page->GetTuple(offset, &tuples_.back());
+    }
+    run_->bpm_->UnpinPage(page_id, false);
+  }
+  *tuple = tuples_.back();
+  tuples_.pop_back();
+  return true;
+}
+
+}  // namespace bustub
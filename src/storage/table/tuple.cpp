@@ -26,8 +26,10 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
 
   // 1. Calculate the size of the tuple.
   uint32_t tuple_size = schema->GetLength();
+  // a NULL varchar is only its length field
+  auto varlen_size = [](const Value &value) { return value.IsNull() ? 0 : value.GetLength(); };
   for (auto &i : schema->GetUnlinedColumns()) {
-    tuple_size += (values[i].GetLength() + sizeof(uint32_t));
+    tuple_size += (varlen_size(values[i]) + sizeof(uint32_t));
   }
 
   // 2. Allocate memory.
@@ -46,7 +48,7 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
       *reinterpret_cast<uint32_t *>(data_ + col.GetOffset()) = offset;
       // Serialize varchar value, in place (size+data).
       values[i].SerializeTo(data_ + offset);
-      offset += (values[i].GetLength() + sizeof(uint32_t));
+      offset += (varlen_size(values[i]) + sizeof(uint32_t));
     } else {
       values[i].SerializeTo(data_ + col.GetOffset());
     }
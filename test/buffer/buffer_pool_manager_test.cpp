@@ -10,11 +10,21 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
+#include <functional>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -29,7 +39,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   std::uniform_int_distribution<char> uniform_dist(0);
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -91,7 +101,7 @@ TEST(BufferPoolManagerTest, SampleTest) {
   const size_t buffer_pool_size = 10;
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -141,4 +151,434 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+/** An in-memory disk manager whose reads and writes take a long time. */
+class SlowDiskManager : public DiskManagerMemory {
+ public:
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    DiskManagerMemory::WritePage(page_id, page_data);
+  }
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    num_reads_ += 1;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    DiskManagerMemory::ReadPage(page_id, page_data);
+  }
+
+  std::atomic<int> num_reads_{0};
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, IOOutsideLatchTest) {
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new SlowDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Page 0 stays resident, every other page is dirty so that evicting it means writing it back.
+  page_id_t page_id_temp;
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    if (page_id_temp != 0) {
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+      page_ids.push_back(page_id_temp);
+    }
+  }
+
+  // Scenario: While other threads keep missing, fetching a resident page never waits for their disk I/O.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; tid++) {
+    threads.emplace_back([bpm, &page_ids, &done, tid]() {
+      for (size_t i = tid; !done; i += 4) {
+        page_id_t page_id = page_ids[i % page_ids.size()];
+        auto *page = bpm->FetchPage(page_id);
+        if (page != nullptr) {
+          EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+          bpm->UnpinPage(page_id, true);
+        }
+      }
+    });
+  }
+  std::chrono::duration<double, std::milli> max_hit_latency{0};
+  for (int i = 0; i < 200; i++) {
+    auto start = std::chrono::steady_clock::now();
+    auto *page0 = bpm->FetchPage(0);
+    max_hit_latency = std::max<std::chrono::duration<double, std::milli>>(max_hit_latency,
+                                                                          std::chrono::steady_clock::now() - start);
+    ASSERT_NE(nullptr, page0);
+    EXPECT_EQ("0", std::string(page0->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(0, false));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_LT(max_hit_latency.count(), 25);
+
+  // Scenario: Threads fetching a page that is being loaded wait for that load instead of reading it again.
+  const page_id_t cold_page_id = page_ids[0];
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  const int num_reads = disk_manager->num_reads_;
+  threads.clear();
+  for (int tid = 0; tid < 4; tid++) {
+    threads.emplace_back([bpm, cold_page_id]() {
+      auto *page = bpm->FetchPage(cold_page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::to_string(cold_page_id), std::string(page->GetData()));
+      EXPECT_EQ(true, bpm->UnpinPage(cold_page_id, false));
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_reads + 1, disk_manager->num_reads_);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** An in-memory disk manager that counts the writes issued by the thread that created it. */
+class ForegroundWriteCountingDiskManager : public DiskManagerMemory {
+ public:
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    if (std::this_thread::get_id() == foreground_thread_) {
+      num_foreground_writes_ += 1;
+    }
+    DiskManagerMemory::WritePage(page_id, page_data);
+  }
+
+  const std::thread::id foreground_thread_{std::this_thread::get_id()};
+  std::atomic<int> num_foreground_writes_{0};
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PageCleanerTest) {
+  const size_t buffer_pool_size = 64;
+  const int num_pages = 256;
+  const int num_ops = 2000;
+
+  // Writes random pages of a working set four times larger than the buffer pool, and checks their contents at the
+  // end. Returns the number of writes the foreground had to do itself.
+  auto run = [&](bool use_cleaner) -> int {
+    auto *disk_manager = new ForegroundWriteCountingDiskManager();
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    if (use_cleaner) {
+      bpm->StartPageCleaner(0.5, 16, std::chrono::milliseconds(1));
+    }
+    page_id_t page_id_temp;
+    for (int i = 0; i < num_pages; i++) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      EXPECT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "0");
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    std::vector<int> versions(num_pages, 0);
+    std::mt19937 rng(15445);
+    std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+    const int num_writes = disk_manager->num_foreground_writes_;
+    for (int i = 0; i < num_ops; i++) {
+      page_id_t page_id = dist(rng);
+      auto *page = bpm->FetchPage(page_id);
+      EXPECT_NE(nullptr, page);
+      page->WLatch();
+      snprintf(page->GetData(), PAGE_SIZE, "%d", ++versions[page_id]);
+      page->WUnlatch();
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    const int foreground_writes = disk_manager->num_foreground_writes_ - num_writes;
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      auto *page = bpm->FetchPage(page_id);
+      EXPECT_NE(nullptr, page);
+      EXPECT_EQ(std::to_string(versions[page_id]), std::string(page->GetData()));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+    delete bpm;
+    delete disk_manager;
+    return foreground_writes;
+  };
+
+  // Scenario: Without a cleaner, most evictions write. With a cleaner, few do.
+  const int writes_without_cleaner = run(false);
+  const int writes_with_cleaner = run(true);
+  EXPECT_GT(writes_without_cleaner, num_ops / 2);
+  EXPECT_LT(writes_with_cleaner, writes_without_cleaner / 4);
+}
+
+/** An in-memory disk manager whose writes can be made to fail. */
+class FailingDiskManager : public DiskManagerMemory {
+ public:
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    if (fail_writes_) {
+      throw Exception(ExceptionType::INVALID, "write failed");
+    }
+    DiskManagerMemory::WritePage(page_id, page_data);
+  }
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (fail_reads_) {
+      throw Exception(ExceptionType::INVALID, "read failed");
+    }
+    DiskManagerMemory::ReadPage(page_id, page_data);
+  }
+
+  bool fail_writes_{false};
+  bool fail_reads_{false};
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FailedWriteBackTest) {
+  auto *disk_manager = new FailingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(2, disk_manager);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+
+  // Scenario: A page whose write-back failed is still dirty, and no longer pinned by the write.
+  disk_manager->fail_writes_ = true;
+  EXPECT_THROW(bpm->FlushPage(page_id), Exception);
+  EXPECT_EQ(1, bpm->GetDirtyPageTable().size());
+
+  // Scenario: Once the write succeeds, the page is clean.
+  disk_manager->fail_writes_ = false;
+  EXPECT_EQ(true, bpm->FlushPage(page_id));
+  EXPECT_EQ(0, bpm->GetDirtyPageTable().size());
+  EXPECT_EQ(true, bpm->DeletePage(page_id));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FailedEvictionTest) {
+  auto *disk_manager = new FailingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(1, disk_manager);
+  page_id_t page_ids[2];
+  for (auto &page_id : page_ids) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: When the victim cannot be written back, it keeps its frame, dirty and unpinned.
+  disk_manager->fail_writes_ = true;
+  EXPECT_THROW(bpm->FetchPage(page_ids[0]), Exception);
+  page_id_t new_page_id;
+  EXPECT_THROW(bpm->NewPage(&new_page_id), Exception);
+  EXPECT_EQ(1, bpm->GetDirtyPageTable().size());
+  Page *page = bpm->FetchPage(page_ids[1]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 1"));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[1], false));
+
+  // Scenario: When the page cannot be read, the frame is free again and the page can be fetched later.
+  disk_manager->fail_writes_ = false;
+  disk_manager->fail_reads_ = true;
+  EXPECT_THROW(bpm->FetchPage(page_ids[0]), Exception);
+  EXPECT_EQ(0, bpm->GetDirtyPageTable().size());
+  disk_manager->fail_reads_ = false;
+  for (page_id_t page_id : page_ids) {
+    page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: A new page still gets a frame after the failures.
+  ASSERT_NE(nullptr, bpm->NewPage(&new_page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(new_page_id, false));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** Holds back the completion of asynchronous reads until the test completes them. */
+class DeferredReadDiskManager : public DiskManagerMemory {
+ public:
+  void ReadPageAsync(page_id_t page_id, char *page_data, io_done_fn on_done) override {
+    pending_ = [this, page_id, page_data, on_done] {
+      ReadPage(page_id, page_data);
+      on_done(nullptr);
+    };
+  }
+
+  std::function<void()> pending_;
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchPageTest) {
+  const size_t buffer_pool_size = 2;
+
+  auto *disk_manager = new DeferredReadDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_ids[3];
+  for (auto &page_id : page_ids) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: Prefetching an evicted page reads it in, the fetch that follows is a hit.
+  EXPECT_EQ(true, bpm->PrefetchPage(page_ids[0]));
+  ASSERT_NE(nullptr, disk_manager->pending_);
+  std::exchange(disk_manager->pending_, nullptr)();
+  bpm->ResetStats();
+  Page *page = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 0"));
+  EXPECT_EQ(1, bpm->GetStats().hits_);
+
+  // Scenario: Prefetching a page that is in the buffer pool does not read anything.
+  EXPECT_EQ(true, bpm->PrefetchPage(page_ids[0]));
+  EXPECT_EQ(nullptr, disk_manager->pending_);
+
+  // Scenario: A fetch of a page whose prefetch is still in flight waits for it, and the page is only pinned once
+  // the read has completed. Nobody but the completion of the read has to act on it.
+  EXPECT_EQ(true, bpm->PrefetchPage(page_ids[1]));
+  ASSERT_NE(nullptr, disk_manager->pending_);
+  std::atomic<bool> fetched{false};
+  std::thread fetcher([&] {
+    Page *prefetched = bpm->FetchPage(page_ids[1]);
+    fetched = true;
+    ASSERT_NE(nullptr, prefetched);
+    EXPECT_EQ(0, strcmp(prefetched->GetData(), "page 1"));
+    bpm->UnpinPage(page_ids[1], false);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(fetched);
+  std::thread completion(std::exchange(disk_manager->pending_, nullptr));
+  completion.join();
+  fetcher.join();
+
+  // Scenario: With every frame pinned, there is no room to prefetch into.
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[1]));
+  EXPECT_EQ(false, bpm->PrefetchPage(page_ids[2]));
+  bpm->UnpinPage(page_ids[0], false);
+  bpm->UnpinPage(page_ids[1], false);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FailedPrefetchTest) {
+  auto *disk_manager = new FailingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(1, disk_manager);
+  page_id_t page_ids[2];
+  for (auto &page_id : page_ids) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: A prefetch whose victim cannot be written back fails, and the victim keeps its frame.
+  disk_manager->fail_writes_ = true;
+  EXPECT_THROW(bpm->PrefetchPage(page_ids[0]), Exception);
+  EXPECT_EQ(1, bpm->GetDirtyPageTable().size());
+
+  // Scenario: A prefetch whose read fails gives up the frame, and a later fetch reads the page again.
+  disk_manager->fail_writes_ = false;
+  disk_manager->fail_reads_ = true;
+  EXPECT_EQ(true, bpm->PrefetchPage(page_ids[0]));
+  disk_manager->fail_reads_ = false;
+  Page *page = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 0"));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: New pages come from the free list, until every frame is pinned.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+  EXPECT_EQ(0, stats.evictions_);
+  EXPECT_EQ(1, stats.pin_failures_);
+  EXPECT_GE(stats.latch_wait_.count_, buffer_pool_size + 1);
+
+  // Scenario: Fetching a resident page is a hit. Pages {0, 1, 2, 3, 4} are unpinned dirty, page 5 clean.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  EXPECT_NE(nullptr, bpm->FetchPage(5));
+  EXPECT_EQ(true, bpm->UnpinPage(5, false));
+  EXPECT_EQ(true, bpm->UnpinPage(5, false));
+
+  // Scenario: Five new pages evict the five dirty pages, then fetching page 0 evicts the clean page 5.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(2, stats.misses_);
+  EXPECT_EQ(6, stats.evictions_);
+  EXPECT_EQ(5, stats.dirty_write_backs_);
+  EXPECT_EQ(0, stats.cleaner_write_backs_);
+  EXPECT_EQ(2, stats.pin_failures_);
+  EXPECT_DOUBLE_EQ(1.0 / 3, stats.HitRatio());
+  DiskManagerStats disk_stats = disk_manager->GetStats();
+  EXPECT_EQ(1, disk_stats.read_latency_.count_);
+  EXPECT_EQ(5, disk_stats.write_latency_.count_);
+  EXPECT_GT(disk_stats.write_latency_.sum_ns_, 0);
+
+  bpm->ResetStats();
+  disk_manager->ResetStats();
+  stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_ + stats.misses_ + stats.evictions_ + stats.dirty_write_backs_ + stats.pin_failures_);
+  EXPECT_EQ(0, stats.latch_wait_.count_);
+  EXPECT_EQ(0, disk_manager->GetStats().write_latency_.count_);
+  delete bpm;
+
+  // Scenario: A parallel buffer pool adds up the statistics of its instances.
+  auto *parallel_bpm = new ParallelBufferPoolManager(2, 5, disk_manager);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NE(nullptr, parallel_bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, parallel_bpm->UnpinPage(page_id_temp, false));
+  }
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    EXPECT_NE(nullptr, parallel_bpm->FetchPage(page_id));
+    EXPECT_EQ(true, parallel_bpm->UnpinPage(page_id, false));
+  }
+  stats = parallel_bpm->GetStats();
+  EXPECT_EQ(4, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+  EXPECT_DOUBLE_EQ(1, stats.HitRatio());
+  parallel_bpm->ResetStats();
+  EXPECT_EQ(0, parallel_bpm->GetStats().hits_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete parallel_bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,201 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+/** Counts the data TLB misses of the calling thread in user space, if the machine exposes the counter. */
+class DTLBMissCounter {
+ public:
+  DTLBMissCounter() {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  ~DTLBMissCounter() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  void Start() {
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  /** @return the misses since Start, or -1 if the counter is not available */
+  int64_t Stop() {
+    int64_t count = -1;
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+        count = -1;
+      }
+    }
+    return count;
+  }
+
+ private:
+  int fd_;
+};
+
+/** @return the AnonHugePages line of /proc/self/smaps_rollup, i.e. how much memory THP backs right now */
+static std::string AnonHugePages() {
+  std::ifstream smaps("/proc/self/smaps_rollup");
+  std::string line;
+  while (std::getline(smaps, line)) {
+    if (line.rfind("AnonHugePages:", 0) == 0) {
+      return line;
+    }
+  }
+  return "AnonHugePages: n/a";
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, SampleTest) {
+  const size_t num_frames = 1000;
+
+  // Scenario: A small arena is not padded to huge pages, its frames start on a page boundary, and every frame is empty
+  // and zeroed out.
+  FrameArena arena(num_frames);
+  EXPECT_EQ(num_frames, arena.GetNumFrames());
+  EXPECT_FALSE(arena.UsesHugePages());
+  EXPECT_FALSE(arena.IsHugeTlb());
+  Page *pages = arena.GetPages();
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages) % sysconf(_SC_PAGESIZE));
+  for (size_t i = 0; i < num_frames; i++) {
+    EXPECT_EQ(INVALID_PAGE_ID, pages[i].GetPageId());
+    EXPECT_EQ(0, pages[i].GetPinCount());
+    for (int offset = 0; offset < PAGE_SIZE; offset += 512) {
+      EXPECT_EQ(0, pages[i].GetData()[offset]);
+    }
+  }
+
+  // Scenario: A buffer pool works on frames borrowed from an arena.
+  auto *disk_manager = new DiskManagerMemory();
+  auto *bpm = new BufferPoolManagerInstance(num_frames, 1, 0, disk_manager, nullptr, pages);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_frames; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(&pages[i], page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (size_t i = 0; i < num_frames; i++) {
+    EXPECT_EQ(std::to_string(i), std::string(pages[i].GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  delete bpm;
+  delete disk_manager;
+
+  // Scenario: From the threshold on, the frames of an arena start on a huge page boundary.
+  FrameArena large_arena(FrameArena::HUGE_PAGE_THRESHOLD / sizeof(Page) + 1);
+  EXPECT_TRUE(large_arena.UsesHugePages());
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(large_arena.GetPages()) % FrameArena::HUGE_PAGE_SIZE);
+  FrameArena regular_arena(FrameArena::HUGE_PAGE_THRESHOLD / sizeof(Page) + 1, 1, false);
+  EXPECT_FALSE(regular_arena.UsesHugePages());
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, NumaTest) {
+  const size_t num_frames = 2048;
+  const size_t num_numa_nodes = 2;
+
+  // Scenario: The arena is only bound if every node exists, otherwise it still works without binding.
+  FrameArena arena(num_frames, num_numa_nodes);
+  EXPECT_EQ(FrameArena::GetNumNumaNodes() >= num_numa_nodes, arena.IsNumaBound());
+  for (size_t i = 0; i < num_frames; i++) {
+    memset(arena.GetPages()[i].GetData(), static_cast<int>(i), PAGE_SIZE);
+  }
+  for (size_t i = 0; i < num_frames; i++) {
+    EXPECT_EQ(static_cast<char>(i), arena.GetPages()[i].GetData()[PAGE_SIZE - 1]);
+  }
+}
+
+/**
+ * Random fetches of resident pages of a large buffer pool, reading a few bytes of every page like an index lookup
+ * does. Reports fetch throughput and data TLB misses with and without huge pages.
+ */
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, DISABLED_FetchBenchmark) {
+  const size_t num_frames = 32768;
+  const size_t num_fetches = 2000000;
+
+  auto run = [&](bool huge_pages) {
+    auto *disk_manager = new DiskManagerMemory();
+    auto *arena = new FrameArena(num_frames, 1, huge_pages);
+    auto *bpm = new BufferPoolManagerInstance(num_frames, 1, 0, disk_manager, nullptr, arena->GetPages(),
+                                              ReplacerPolicy::CLOCK);
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < num_frames; i++) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      memset(page->GetData(), 1, PAGE_SIZE);
+      bpm->UnpinPage(page_id_temp, true);
+    }
+
+    std::mt19937 rng(15445);
+    std::uniform_int_distribution<page_id_t> page_dist(0, num_frames - 1);
+    std::uniform_int_distribution<int> offset_dist(0, PAGE_SIZE / sizeof(uint64_t) - 1);
+    DTLBMissCounter counter;
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    counter.Start();
+    for (size_t i = 0; i < num_fetches; i++) {
+      page_id_t page_id = page_dist(rng);
+      auto *page = bpm->FetchPage(page_id);
+      sum += reinterpret_cast<uint64_t *>(page->GetData())[offset_dist(rng)];
+      bpm->UnpinPage(page_id, false);
+    }
+    int64_t misses = counter.Stop();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(num_fetches * 0x0101010101010101, sum);
+
+    std::cout << (huge_pages ? "huge pages" : "regular pages") << ": "
+              << static_cast<double>(num_fetches) / elapsed.count() << " fetches/s, dTLB load misses: "
+              << (misses < 0 ? "n/a" : std::to_string(misses)) << ", " << AnonHugePages() << std::endl;
+    delete bpm;
+    delete arena;
+    delete disk_manager;
+  };
+
+  run(false);
+  run(true);
+}
+
+}  // namespace bustub
@@ -19,7 +19,7 @@
 #include <thread>  // NOLINT
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "mock_buffer_pool_manager.h"  // NOLINT
 
 namespace bustub {
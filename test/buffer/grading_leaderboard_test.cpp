@@ -14,7 +14,7 @@
 #include <thread>  // NOLINT
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager_memory.h"
 
@@ -22,7 +22,7 @@ namespace bustub {
 
 TEST(LeaderboardTest, Time) {
   DiskManagerMemory *dm = new DiskManagerMemory();
-  BufferPoolManager *bpm = new BufferPoolManager(1000000, dm);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(1000000, dm);
   page_id_t temp;
   for (int i = 0; i < 1000000; i++) {
     bpm->NewPage(&temp);
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: access frames 1-6 once, and frame 1 once more, then unpin them all.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    lru_k_replacer.RecordAccess(frame_id, AccessType::Lookup);
+  }
+  lru_k_replacer.RecordAccess(1, AccessType::Lookup);
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    lru_k_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with fewer than two accesses go first, oldest access first. Frame 1 was accessed twice.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: pinned frames are not victimized, pinning a victimized frame has no effect.
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Pin(4);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // Scenario: a second access to 4 while pinned moves it behind 5 and 6, but still ahead of 1.
+  lru_k_replacer.RecordAccess(4, AccessType::Lookup);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_k_replacer(10, 2);
+
+  // Scenario: frames 0 and 1 are looked up repeatedly.
+  for (int i = 0; i < 3; i++) {
+    lru_k_replacer.RecordAccess(0, AccessType::Lookup);
+    lru_k_replacer.RecordAccess(1, AccessType::Lookup);
+  }
+  lru_k_replacer.Unpin(0);
+  lru_k_replacer.Unpin(1);
+
+  // Scenario: a scan touches frames 2-5 many times each, which does not make them look hot.
+  for (frame_id_t frame_id = 2; frame_id <= 5; frame_id++) {
+    for (int i = 0; i < 10; i++) {
+      lru_k_replacer.RecordAccess(frame_id, AccessType::Scan);
+    }
+    lru_k_replacer.Unpin(frame_id);
+  }
+
+  // Scenario: the scanned frames are evicted before the looked up ones.
+  int value;
+  for (frame_id_t frame_id = 2; frame_id <= 5; frame_id++) {
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(frame_id, value);
+  }
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+
+  // Scenario: victimized and removed frames start over without history.
+  lru_k_replacer.Remove(1);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  lru_k_replacer.RecordAccess(1, AccessType::Lookup);
+  lru_k_replacer.RecordAccess(0, AccessType::Lookup);
+  lru_k_replacer.RecordAccess(0, AccessType::Lookup);
+  lru_k_replacer.Unpin(0);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+}
+
+}  // namespace bustub
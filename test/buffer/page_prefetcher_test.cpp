@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_prefetcher_test.cpp
+//
+// Identification: test/buffer/page_prefetcher_test.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/page_prefetcher.h"
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <iostream>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+/** An in-memory disk manager whose reads take a while and are counted. */
+class SlowReadDiskManager : public DiskManagerMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    num_reads_ += 1;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    DiskManagerMemory::ReadPage(page_id, page_data);
+  }
+
+  std::atomic<int> num_reads_{0};
+};
+
+/** Every page stores the id of the next page of the chain at its start. */
+static page_id_t NextPageId(Page *page) {
+  page_id_t next_page_id;
+  memcpy(&next_page_id, page->GetData(), sizeof(page_id_t));
+  return next_page_id;
+}
+
+/** Writes a chain of num_pages pages to disk and returns their ids in chain order. */
+static std::vector<page_id_t> WriteChain(DiskManager *disk_manager, int num_pages) {
+  BufferPoolManagerInstance bpm(num_pages, disk_manager);
+  std::vector<page_id_t> page_ids;
+  std::vector<Page *> pages;
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; i++) {
+    pages.push_back(bpm.NewPage(&page_id));
+    page_ids.push_back(page_id);
+  }
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t next_page_id = i + 1 < num_pages ? page_ids[i + 1] : INVALID_PAGE_ID;
+    memcpy(pages[i]->GetData(), &next_page_id, sizeof(page_id_t));
+    bpm.UnpinPage(page_ids[i], true);
+  }
+  bpm.FlushAllPages();
+  return page_ids;
+}
+
+/** Walks the chain like a scan does, spending some time on every page, and returns how long it took. */
+static double Scan(BufferPoolManager *bpm, PagePrefetcher *prefetcher, const std::vector<page_id_t> &page_ids) {
+  auto start = std::chrono::steady_clock::now();
+  page_id_t page_id = page_ids[0];
+  size_t num_pages = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    EXPECT_EQ(page_ids[num_pages++], page_id);
+    if (prefetcher != nullptr) {
+      prefetcher->Advance(page_id);
+    }
+    Page *page = bpm->FetchPage(page_id);
+    EXPECT_NE(nullptr, page);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    page_id_t next_page_id = NextPageId(page);
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  EXPECT_EQ(page_ids.size(), num_pages);
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+// NOLINTNEXTLINE
+TEST(PagePrefetcherTest, ReadAheadTest) {
+  const int num_pages = 100;
+  const size_t depth = 4;
+
+  auto *disk_manager = new SlowReadDiskManager();
+  auto page_ids = WriteChain(disk_manager, num_pages);
+
+  // Scenario: Without read-ahead every page is read by the scan itself.
+  auto *bpm = new BufferPoolManagerInstance(num_pages, disk_manager);
+  double scan_ms = Scan(bpm, nullptr, page_ids);
+  EXPECT_EQ(num_pages, disk_manager->num_reads_);
+  delete bpm;
+
+  // Scenario: With read-ahead the prefetcher reads the pages before the scan gets there, and every page is still
+  // read exactly once.
+  disk_manager->num_reads_ = 0;
+  bpm = new BufferPoolManagerInstance(num_pages, disk_manager);
+  auto *prefetcher = new PagePrefetcher(bpm, depth, NextPageId);
+  double prefetch_scan_ms = Scan(bpm, prefetcher, page_ids);
+  EXPECT_EQ(num_pages, disk_manager->num_reads_);
+  EXPECT_GT(prefetcher->GetNumPrefetched(), static_cast<size_t>(num_pages / 2));
+  std::cout << "scan: " << scan_ms << " ms, with read-ahead: " << prefetch_scan_ms << " ms" << std::endl;
+
+  delete prefetcher;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PagePrefetcherTest, RestartTest) {
+  const int num_pages = 20;
+  const size_t depth = 4;
+
+  auto *disk_manager = new DiskManagerMemory();
+  auto page_ids = WriteChain(disk_manager, num_pages);
+  auto *bpm = new BufferPoolManagerInstance(num_pages, disk_manager);
+  auto *prefetcher = new PagePrefetcher(bpm, depth, NextPageId);
+
+  // Scenario: The prefetcher never reads further than depth pages ahead of the consumer.
+  prefetcher->Advance(page_ids[0]);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(depth, prefetcher->GetNumPrefetched());
+
+  // Scenario: Jumping to a page outside of the window restarts read-ahead from there, up to the end of the chain.
+  prefetcher->Advance(page_ids[num_pages - 3]);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(depth + 2, prefetcher->GetNumPrefetched());
+
+  delete prefetcher;
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,178 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t num_instances = 5;
+  const size_t buffer_pool_size = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: We should be able to create new pages until we fill up every instance, and every page id should be
+  // served by the instance it hashes to.
+  std::vector<page_id_t> page_ids{page_id_temp};
+  for (size_t i = 1; i < num_instances * buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    page_ids.push_back(page_id_temp);
+  }
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(bpm->GetBufferPoolManager(page_id), bpm->GetBufferPoolManager(page_id + num_instances));
+  }
+
+  // Scenario: Once every instance is full, we should not be able to create any new pages.
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: After unpinning every page and creating new ones, page 0 is evicted and can be read back from disk.
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->DeletePage(0));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const int num_threads = 8;
+  const size_t num_instances = 4;
+  const int pages_per_thread = 10;
+  const size_t buffer_pool_size = num_threads * pages_per_thread / num_instances;
+
+  auto *disk_manager = new DiskManagerMemory();
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm]() {
+      page_id_t temp_page_id;
+      std::vector<page_id_t> page_ids;
+      for (int i = 0; i < pages_per_thread; i++) {
+        auto *new_page = bpm->NewPage(&temp_page_id);
+        ASSERT_NE(nullptr, new_page);
+        snprintf(new_page->GetData(), PAGE_SIZE, "%d", temp_page_id);
+        page_ids.push_back(temp_page_id);
+      }
+      for (auto page_id : page_ids) {
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      }
+      for (auto page_id : page_ids) {
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+      for (auto page_id : page_ids) {
+        EXPECT_EQ(true, bpm->DeletePage(page_id));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/**
+ * Multi-threaded fetch benchmark: every thread fetches and unpins random resident pages. With a single instance all
+ * threads serialize on one latch, with one instance per thread they mostly work on disjoint latches.
+ */
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DISABLED_FetchBenchmark) {
+  const size_t num_threads = std::max(4U, std::thread::hardware_concurrency());
+  const size_t num_pages = 4096;
+  const size_t fetches_per_thread = 100000;
+
+  auto run = [&](size_t num_instances) -> double {
+    auto *disk_manager = new DiskManagerMemory();
+    auto *bpm = new ParallelBufferPoolManager(num_instances, num_pages / num_instances, disk_manager);
+    std::vector<page_id_t> page_ids;
+    page_id_t temp_page_id;
+    for (size_t i = 0; i < num_pages; ++i) {
+      EXPECT_NE(nullptr, bpm->NewPage(&temp_page_id));
+      bpm->UnpinPage(temp_page_id, true);
+      page_ids.push_back(temp_page_id);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([bpm, &page_ids, tid]() {
+        std::mt19937 rng(tid);
+        std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+        for (size_t i = 0; i < fetches_per_thread; i++) {
+          page_id_t page_id = page_ids[dist(rng)];
+          EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+          bpm->UnpinPage(page_id, false);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    delete bpm;
+    delete disk_manager;
+    return static_cast<double>(num_threads * fetches_per_thread) / elapsed.count();
+  };
+
+  for (size_t num_instances = 1; num_instances <= num_threads; num_instances *= 2) {
+    std::cout << "threads: " << num_threads << " instances: " << num_instances << " fetches/s: " << run(num_instances)
+              << std::endl;
+  }
+}
+
+}  // namespace bustub
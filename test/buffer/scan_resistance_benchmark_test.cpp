@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// scan_resistance_benchmark_test.cpp
+//
+// Identification: test/buffer/scan_resistance_benchmark_test.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+/** An in-memory disk manager that counts the reads of the pages below a given page id. */
+class IndexReadCountingDiskManager : public DiskManagerMemory {
+ public:
+  explicit IndexReadCountingDiskManager(page_id_t num_index_pages) : num_index_pages_(num_index_pages) {}
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (page_id < num_index_pages_) {
+      num_index_reads_ += 1;
+    }
+    DiskManagerMemory::ReadPage(page_id, page_data);
+  }
+
+  const page_id_t num_index_pages_;
+  std::atomic<int> num_index_reads_{0};
+};
+
+/**
+ * Index lookups over a hot set of pages that fits into the buffer pool, while another thread keeps scanning a table
+ * that is much larger than the buffer pool. Reports the hit rate of the lookups for every replacement policy.
+ */
+// NOLINTNEXTLINE
+TEST(ScanResistanceBenchmarkTest, IndexHitRateTest) {
+  const size_t buffer_pool_size = 64;
+  const page_id_t num_index_pages = 40;
+  const page_id_t num_table_pages = 1000;
+  const int num_lookups = 20000;
+
+  auto *disk_manager = new IndexReadCountingDiskManager(num_index_pages);
+  char zeros[PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < num_index_pages + num_table_pages; page_id++) {
+    disk_manager->WritePage(page_id, zeros);
+  }
+
+  auto run = [&](ReplacerPolicy policy) -> double {
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, policy);
+    // warm up the index
+    for (int i = 0; i < 2; i++) {
+      for (page_id_t page_id = 0; page_id < num_index_pages; page_id++) {
+        EXPECT_NE(nullptr, bpm->FetchPage(page_id, AccessType::Lookup));
+        bpm->UnpinPage(page_id, false);
+      }
+    }
+
+    std::atomic<bool> done{false};
+    std::thread scanner([&]() {
+      while (!done) {
+        for (page_id_t page_id = num_index_pages; page_id < num_index_pages + num_table_pages && !done; page_id++) {
+          // a scan fetches a page once for every tuple on it
+          for (int i = 0; i < 4; i++) {
+            EXPECT_NE(nullptr, bpm->FetchPage(page_id, AccessType::Scan));
+            bpm->UnpinPage(page_id, false);
+          }
+        }
+      }
+    });
+
+    std::mt19937 rng(15445);
+    std::uniform_int_distribution<page_id_t> dist(0, num_index_pages - 1);
+    const int num_index_reads = disk_manager->num_index_reads_;
+    for (int i = 0; i < num_lookups; i++) {
+      page_id_t page_id = dist(rng);
+      EXPECT_NE(nullptr, bpm->FetchPage(page_id, AccessType::Lookup));
+      bpm->UnpinPage(page_id, false);
+      if (i % 16 == 0) {
+        std::this_thread::yield();
+      }
+    }
+    const int num_misses = disk_manager->num_index_reads_ - num_index_reads;
+    done = true;
+    scanner.join();
+    delete bpm;
+    return 1.0 - static_cast<double>(num_misses) / num_lookups;
+  };
+
+  const double lru_hit_rate = run(ReplacerPolicy::LRU);
+  const double clock_hit_rate = run(ReplacerPolicy::CLOCK);
+  const double lru_k_hit_rate = run(ReplacerPolicy::LRU_K);
+  const double two_queue_hit_rate = run(ReplacerPolicy::TWO_Q);
+  std::cout << "index hit rate under a concurrent scan: LRU " << lru_hit_rate << ", CLOCK " << clock_hit_rate
+            << ", LRU-K " << lru_k_hit_rate << ", 2Q " << two_queue_hit_rate << std::endl;
+  EXPECT_GT(lru_k_hit_rate, 0.99);
+  EXPECT_GT(two_queue_hit_rate, 0.99);
+
+  delete disk_manager;
+}
+
+}  // namespace bustub
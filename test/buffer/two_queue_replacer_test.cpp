@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer_test.cpp
+//
+// Identification: test/buffer/two_queue_replacer_test.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  TwoQueueReplacer two_queue_replacer(8, 0.25);
+
+  // Scenario: frames 0-3 are accessed twice and move on to Am, in LRU order 1, 0, 2, 3.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    two_queue_replacer.RecordAccess(frame_id, AccessType::Lookup);
+  }
+  two_queue_replacer.RecordAccess(1, AccessType::Lookup);
+  two_queue_replacer.RecordAccess(0, AccessType::Lookup);
+  two_queue_replacer.RecordAccess(2, AccessType::Lookup);
+  two_queue_replacer.RecordAccess(3, AccessType::Lookup);
+
+  // Scenario: frames 4-7 are touched by a scan, repeatedly, and stay in A1.
+  for (frame_id_t frame_id = 4; frame_id < 8; frame_id++) {
+    two_queue_replacer.RecordAccess(frame_id, AccessType::Scan);
+    two_queue_replacer.RecordAccess(frame_id, AccessType::Scan);
+  }
+  for (frame_id_t frame_id = 0; frame_id < 8; frame_id++) {
+    two_queue_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(8, two_queue_replacer.Size());
+
+  // Scenario: A1 holds more than its share of 2 frames, so it gives up victims in FIFO order until it is down to 2.
+  int value;
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+
+  // Scenario: from then on, Am gives up victims in LRU order.
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  two_queue_replacer.Pin(0);
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: once Am has nothing left to evict, A1 does.
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(7, value);
+  EXPECT_FALSE(two_queue_replacer.Victim(&value));
+
+  // Scenario: unpinning a frame without recorded accesses puts it into A1.
+  two_queue_replacer.Unpin(0);
+  two_queue_replacer.Unpin(5);
+  EXPECT_EQ(2, two_queue_replacer.Size());
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+}
+
+}  // namespace bustub
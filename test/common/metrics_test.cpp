@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// metrics_test.cpp
+//
+// Identification: test/common/metrics_test.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/metrics.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(MetricsTest, ShardedCounterTest) {
+  const int num_threads = 32;
+  const int num_adds = 10000;
+  ShardedCounter counter;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&counter] {
+      for (int i = 0; i < num_adds; i++) {
+        counter.Add();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * num_adds, counter.Get());
+  counter.Add(5);
+  EXPECT_EQ(num_threads * num_adds + 5, counter.Get());
+  counter.Reset();
+  EXPECT_EQ(0, counter.Get());
+}
+
+// NOLINTNEXTLINE
+TEST(MetricsTest, LatencyHistogramTest) {
+  LatencyHistogram histogram;
+  // 0ns, then 1ns..100ns
+  histogram.Record(std::chrono::nanoseconds(0));
+  for (int i = 1; i <= 100; i++) {
+    histogram.Record(std::chrono::nanoseconds(i));
+  }
+  HistogramSnapshot snapshot = histogram.Snapshot();
+  EXPECT_EQ(101, snapshot.count_);
+  EXPECT_EQ(5050, snapshot.sum_ns_);
+  EXPECT_DOUBLE_EQ(50, snapshot.Mean());
+  EXPECT_EQ(1, snapshot.buckets_[0]);
+  EXPECT_EQ(1, snapshot.buckets_[1]);   // 1
+  EXPECT_EQ(2, snapshot.buckets_[2]);   // 2..3
+  EXPECT_EQ(37, snapshot.buckets_[7]);  // 64..100
+  EXPECT_EQ(0, snapshot.Percentile(0));
+  EXPECT_EQ(63, snapshot.Percentile(50));
+  EXPECT_EQ(127, snapshot.Percentile(99));
+
+  // huge latencies land in the last bucket
+  histogram.Record(std::chrono::hours(24));
+  snapshot = histogram.Snapshot();
+  EXPECT_EQ(1, snapshot.buckets_[HistogramSnapshot::NUM_BUCKETS - 1]);
+
+  // snapshots add up
+  HistogramSnapshot sum = snapshot;
+  sum += snapshot;
+  EXPECT_EQ(2 * snapshot.count_, sum.count_);
+  EXPECT_EQ(2 * snapshot.sum_ns_, sum.sum_ns_);
+
+  histogram.Reset();
+  EXPECT_EQ(0, histogram.Snapshot().count_);
+  EXPECT_EQ(0, histogram.Snapshot().Percentile(99));
+
+  // a timer records on destruction
+  {
+    LatencyTimer timer(&histogram);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  snapshot = histogram.Snapshot();
+  EXPECT_EQ(1, snapshot.count_);
+  EXPECT_GE(snapshot.sum_ns_, 1000000);
+}
+
+}  // namespace bustub
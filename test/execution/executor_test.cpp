@@ -10,9 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cstdio>
+#include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -20,19 +23,26 @@
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/limit_plan.h"
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "catalog/table_generator.h"
 #include "concurrency/transaction_manager.h"
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/executors/hash_join_executor.h"
 #include "execution/executors/insert_executor.h"
+#include "execution/executors/limit_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
+#include "execution/executors/sort_executor.h"
 #include "execution/expressions/aggregate_value_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/compiled_predicate.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/hash_join_plan.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/vector_batch.h"
 #include "gtest/gtest.h"
 #include "storage/b_plus_tree_test_util.h"  // NOLINT
 #include "storage/table/tuple.h"
@@ -47,7 +57,7 @@ class ExecutorTest : public ::testing::Test {
     ::testing::Test::SetUp();
     // For each test, we create a new DiskManager, BufferPoolManager, TransactionManager, and Catalog.
     disk_manager_ = std::make_unique<DiskManager>("executor_test.db");
-    bpm_ = std::make_unique<BufferPoolManager>(32, disk_manager_.get());
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(32, disk_manager_.get());
     page_id_t page_id;
     bpm_->NewPage(&page_id);
     lock_manager_ = std::make_unique<LockManager>();
@@ -104,9 +114,9 @@ class ExecutorTest : public ::testing::Test {
     return allocated_exprs_.back().get();
   }
 
-  const AbstractExpression *MakeAggregateValueExpression(bool is_group_by_term, uint32_t term_idx) {
-    allocated_exprs_.emplace_back(
-        std::make_unique<AggregateValueExpression>(is_group_by_term, term_idx, TypeId::INTEGER));
+  const AbstractExpression *MakeAggregateValueExpression(bool is_group_by_term, uint32_t term_idx,
+                                                         TypeId ret_type = TypeId::INTEGER) {
+    allocated_exprs_.emplace_back(std::make_unique<AggregateValueExpression>(is_group_by_term, term_idx, ret_type));
     return allocated_exprs_.back().get();
   }
 
@@ -435,6 +445,453 @@ TEST_F(ExecutorTest, SimpleNestedLoopJoinTest) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BlockNestedLoopJoinTest) {
+  // SELECT test_1.colA, test_2.col1 FROM test_1 JOIN test_2 ON test_1.colA < test_2.col1
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema1;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  const Schema *out_schema2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+    auto &schema = table_info->schema_;
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    out_schema2 = MakeOutputSchema({{"col1", col1}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+  auto colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+  auto col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+  auto predicate = MakeComparisonExpression(colA, col1, ComparisonType::LessThan);
+  const Schema *out_final = MakeOutputSchema({{"colA", colA}, {"col1", col1}});
+  NestedLoopJoinPlanNode tuple_plan(out_final, {scan_plan1.get(), scan_plan2.get()}, predicate);
+  NestedLoopJoinPlanNode block_plan(out_final, {scan_plan1.get(), scan_plan2.get()}, predicate, 2);
+
+  auto run = [&](const NestedLoopJoinPlanNode *plan, size_t *num_inner_scans) {
+    std::vector<std::pair<int32_t, int16_t>> result;
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), plan);
+    executor->Init();
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      result.emplace_back(tuple.GetValue(out_final, 0).GetAs<int32_t>(), tuple.GetValue(out_final, 1).GetAs<int16_t>());
+    }
+    *num_inner_scans = dynamic_cast<NestedLoopJoinExecutor *>(executor.get())->GetNumInnerScans();
+    std::sort(result.begin(), result.end());
+    return result;
+  };
+  size_t tuple_scans;
+  size_t block_scans;
+  const auto expected = run(&tuple_plan, &tuple_scans);
+  // col1 runs from 0 to TEST2_SIZE - 1, so every col1 pairs with col1 smaller colAs
+  ASSERT_EQ(expected.size(), TEST2_SIZE * (TEST2_SIZE - 1) / 2);
+  ASSERT_EQ(expected, run(&block_plan, &block_scans));
+  EXPECT_EQ(tuple_scans, TEST1_SIZE);
+  // two pages hold hundreds of outer tuples
+  EXPECT_LT(block_scans * 100, tuple_scans);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BlockNestedLoopJoinWideTupleTest) {
+  // CREATE TABLE wide_rows (colA VARCHAR(3000), colB INTEGER)
+  const size_t num_rows = 4;
+  const size_t width = 3000;
+  Schema table_schema({Column("colA", TypeId::VARCHAR, width), Column("colB", TypeId::INTEGER)});
+  auto table_info = GetExecutorContext()->GetCatalog()->CreateTable(GetTxn(), "wide_rows", table_schema);
+  std::vector<std::vector<Value>> raw_vals;
+  for (size_t i = 0; i < num_rows; i++) {
+    raw_vals.push_back({ValueFactory::GetVarcharValue(std::string(width, static_cast<char>('a' + i))),
+                        ValueFactory::GetIntegerValue(static_cast<int32_t>(i))});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  // The outer side joins wide_rows with itself, so that its tuples are too large for a page:
+  // SELECT l.colA, r.colA, l.colB FROM wide_rows AS l JOIN wide_rows AS r ON l.colB = r.colB
+  auto &schema = table_info->schema_;
+  const Schema *wide_schema = MakeOutputSchema(
+      {{"colA", MakeColumnValueExpression(schema, 0, "colA")}, {"colB", MakeColumnValueExpression(schema, 0, "colB")}});
+  SeqScanPlanNode wide_scan1{wide_schema, nullptr, table_info->oid_};
+  SeqScanPlanNode wide_scan2{wide_schema, nullptr, table_info->oid_};
+  auto left_colA = MakeColumnValueExpression(*wide_schema, 0, "colA");
+  auto left_colB = MakeColumnValueExpression(*wide_schema, 0, "colB");
+  auto right_colA = MakeColumnValueExpression(*wide_schema, 1, "colA");
+  auto right_colB = MakeColumnValueExpression(*wide_schema, 1, "colB");
+  const Schema *outer_schema = MakeOutputSchema({{"l_colA", left_colA}, {"r_colA", right_colA}, {"colB", left_colB}});
+  NestedLoopJoinPlanNode outer_plan(outer_schema, {&wide_scan1, &wide_scan2},
+                                    MakeComparisonExpression(left_colB, right_colB, ComparisonType::Equal));
+
+  // SELECT outer.colB, test_2.col1 FROM outer JOIN test_2 ON outer.colB < test_2.col1
+  auto test_2 = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  const Schema *inner_schema = MakeOutputSchema({{"col1", MakeColumnValueExpression(test_2->schema_, 0, "col1")}});
+  SeqScanPlanNode inner_plan{inner_schema, nullptr, test_2->oid_};
+  auto colB = MakeColumnValueExpression(*outer_schema, 0, "colB");
+  auto col1 = MakeColumnValueExpression(*inner_schema, 1, "col1");
+  auto predicate = MakeComparisonExpression(colB, col1, ComparisonType::LessThan);
+  const Schema *out_final = MakeOutputSchema({{"colB", colB}, {"col1", col1}});
+  NestedLoopJoinPlanNode tuple_plan(out_final, {&outer_plan, &inner_plan}, predicate);
+  NestedLoopJoinPlanNode block_plan(out_final, {&outer_plan, &inner_plan}, predicate, 2);
+
+  auto run = [&](const NestedLoopJoinPlanNode *plan) {
+    std::vector<std::pair<int32_t, int16_t>> result;
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(plan, &result_set, GetTxn(), GetExecutorContext());
+    for (const auto &tuple : result_set) {
+      result.emplace_back(tuple.GetValue(out_final, 0).GetAs<int32_t>(), tuple.GetValue(out_final, 1).GetAs<int16_t>());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  };
+  // Scenario: Every outer tuple is a block of its own, none of them is dropped.
+  const auto expected = run(&tuple_plan);
+  ASSERT_EQ(num_rows * TEST2_SIZE - num_rows * (num_rows + 1) / 2, expected.size());
+  ASSERT_EQ(expected, run(&block_plan));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleHashJoinTest) {
+  // SELECT test_1.colA, test_1.colB, test_2.col1, test_2.col3 FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema1;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  const Schema *out_schema2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+    auto &schema = table_info->schema_;
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    auto col3 = MakeColumnValueExpression(schema, 0, "col3");
+    out_schema2 = MakeOutputSchema({{"col1", col1}, {"col3", col3}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<HashJoinPlanNode> join_plan;
+  const Schema *out_final;
+  {
+    auto colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+    auto colB = MakeColumnValueExpression(*out_schema1, 0, "colB");
+    auto col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+    auto col3 = MakeColumnValueExpression(*out_schema2, 1, "col3");
+    out_final = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"col1", col1}, {"col3", col3}});
+    // the larger side is on the left, the join builds on the right
+    join_plan = std::make_unique<HashJoinPlanNode>(
+        out_final, std::vector<const AbstractPlanNode *>{scan_plan1.get(), scan_plan2.get()},
+        std::vector<const AbstractExpression *>{colA}, std::vector<const AbstractExpression *>{col1});
+  }
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(join_plan.get(), &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 100);
+  for (const auto &tuple : result_set) {
+    ASSERT_EQ(tuple.GetValue(out_final, out_final->GetColIdx("colA")).GetAs<int32_t>(),
+              tuple.GetValue(out_final, out_final->GetColIdx("col1")).GetAs<int16_t>());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, HashJoinSpillTest) {
+  // SELECT test_1.colA, test_2.col1 FROM test_1 JOIN test_2 ON test_1.colB = test_2.col2, with a tiny memory budget
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema1;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  const Schema *out_schema2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+    auto &schema = table_info->schema_;
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    auto col2 = MakeColumnValueExpression(schema, 0, "col2");
+    out_schema2 = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+  auto colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+  auto colB = MakeColumnValueExpression(*out_schema1, 0, "colB");
+  auto col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+  auto col2 = MakeColumnValueExpression(*out_schema2, 1, "col2");
+  const Schema *out_final = MakeOutputSchema({{"colA", colA}, {"col1", col1}});
+  // colB only has ten values, so partitions keep exceeding the budget until the depth limit is reached
+  HashJoinPlanNode hash_join_plan(out_final, {scan_plan1.get(), scan_plan2.get()}, {colB}, {col2}, nullptr, 256);
+  NestedLoopJoinPlanNode nested_loop_join_plan(out_final, {scan_plan1.get(), scan_plan2.get()},
+                                               MakeComparisonExpression(colB, col2, ComparisonType::Equal));
+
+  auto run = [&](const AbstractPlanNode *plan) {
+    std::vector<std::pair<int32_t, int16_t>> result;
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), plan);
+    executor->Init();
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      result.emplace_back(tuple.GetValue(out_final, 0).GetAs<int32_t>(), tuple.GetValue(out_final, 1).GetAs<int16_t>());
+    }
+    if (plan->GetType() == PlanType::HashJoin) {
+      EXPECT_GT(dynamic_cast<HashJoinExecutor *>(executor.get())->GetNumPartitionsJoined(), 0);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  };
+  const auto expected = run(&nested_loop_join_plan);
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(expected, run(&hash_join_plan));
+  // no spilled page was left pinned, every frame but the one of the header page can be used again
+  std::vector<page_id_t> page_ids(GetBPM()->GetPoolSize() - 1);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, GetBPM()->NewPage(&page_id));
+  }
+  for (const auto page_id : page_ids) {
+    GetBPM()->UnpinPage(page_id, false);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BatchSeqScanLimitTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA < 600 LIMIT 500 OFFSET 50
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto const600 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(600));
+  auto predicate = MakeComparisonExpression(colA, const600, ComparisonType::LessThan);
+  auto out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan{out_schema, predicate, table_info->oid_};
+  auto out_colA = MakeColumnValueExpression(*out_schema, 0, "colA");
+  auto limit_schema = MakeOutputSchema({{"colA", out_colA}});
+  LimitPlanNode limit_plan{limit_schema, &scan_plan, 500, 50};
+
+  // calls Next num_next times, then NextBatch until the executor ends
+  auto run = [&](const AbstractPlanNode *plan, size_t num_next) {
+    const Schema *schema = plan->OutputSchema();
+    std::vector<int32_t> result;
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), plan);
+    executor->Init();
+    Tuple tuple;
+    RID rid;
+    for (size_t i = 0; i < num_next && executor->Next(&tuple, &rid); i++) {
+      result.push_back(tuple.GetValue(schema, 0).GetAs<int32_t>());
+    }
+    VectorBatch batch;
+    while (executor->NextBatch(&batch)) {
+      EXPECT_LE(batch.GetNumRows(), VECTOR_BATCH_SIZE);
+      EXPECT_GT(batch.GetNumSelected(), 0);
+      for (uint32_t row : batch.GetSelection()) {
+        result.push_back(batch.GetValue(row, 0).GetAs<int32_t>());
+      }
+    }
+    EXPECT_FALSE(executor->Next(&tuple, &rid));
+    return result;
+  };
+
+  const auto scanned = run(&scan_plan, TEST1_SIZE);
+  ASSERT_EQ(600, scanned.size());
+  ASSERT_EQ(scanned, run(&scan_plan, 0));
+  ASSERT_EQ(scanned, run(&scan_plan, 10));
+
+  const auto limited = run(&limit_plan, TEST1_SIZE);
+  ASSERT_EQ(500, limited.size());
+  ASSERT_EQ(limited, run(&limit_plan, 0));
+  ASSERT_EQ(limited, run(&limit_plan, 10));
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&limit_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(limited.size(), result_set.size());
+  for (size_t i = 0; i < limited.size(); i++) {
+    ASSERT_EQ(limited[i], result_set[i].GetValue(limit_schema, 0).GetAs<int32_t>());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BatchHashJoinTest) {
+  // SELECT test_1.colA, test_2.col1 FROM test_1 JOIN test_2 ON test_1.colB = test_2.col2
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema1;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  const Schema *out_schema2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+    auto &schema = table_info->schema_;
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    auto col2 = MakeColumnValueExpression(schema, 0, "col2");
+    out_schema2 = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+  auto colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+  auto colB = MakeColumnValueExpression(*out_schema1, 0, "colB");
+  auto col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+  auto col2 = MakeColumnValueExpression(*out_schema2, 1, "col2");
+  // the second column is not a plain column, so it is evaluated on the probe row as a tuple
+  auto a_lt_1 = MakeComparisonExpression(colA, col1, ComparisonType::LessThan);
+  const Schema *out_final = MakeOutputSchema({{"colA", colA}, {"col1", col1}, {"a_lt_1", a_lt_1}});
+  HashJoinPlanNode in_memory_plan(out_final, {scan_plan1.get(), scan_plan2.get()}, {colB}, {col2});
+  HashJoinPlanNode spilling_plan(out_final, {scan_plan1.get(), scan_plan2.get()}, {colB}, {col2}, nullptr, 256);
+
+  using Row = std::tuple<int32_t, int16_t, bool>;
+  auto run = [&](const AbstractPlanNode *plan, bool batched) {
+    std::vector<Row> result;
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), plan);
+    executor->Init();
+    auto add_row = [&](const Value &a, const Value &b, const Value &c) {
+      result.emplace_back(a.GetAs<int32_t>(), b.GetAs<int16_t>(), c.GetAs<bool>());
+    };
+    if (batched) {
+      VectorBatch batch;
+      while (executor->NextBatch(&batch)) {
+        for (uint32_t row : batch.GetSelection()) {
+          add_row(batch.GetValue(row, 0), batch.GetValue(row, 1), batch.GetValue(row, 2));
+        }
+      }
+    } else {
+      Tuple tuple;
+      RID rid;
+      while (executor->Next(&tuple, &rid)) {
+        add_row(tuple.GetValue(out_final, 0), tuple.GetValue(out_final, 1), tuple.GetValue(out_final, 2));
+      }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  };
+  const auto expected = run(&in_memory_plan, false);
+  ASSERT_FALSE(expected.empty());
+  for (const auto &[a, one, a_lt_1] : expected) {
+    ASSERT_EQ(a < one, a_lt_1);
+  }
+  ASSERT_EQ(expected, run(&in_memory_plan, true));
+  ASSERT_EQ(expected, run(&spilling_plan, false));
+  ASSERT_EQ(expected, run(&spilling_plan, true));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, CompiledPredicateTest) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  const Schema *schema = &table_info->schema_;
+  auto col1 = MakeColumnValueExpression(*schema, 0, "col1");
+  auto col2 = MakeColumnValueExpression(*schema, 0, "col2");
+  auto col3 = MakeColumnValueExpression(*schema, 0, "col3");
+  auto col4 = MakeColumnValueExpression(*schema, 0, "col4");
+  auto const50 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(50));
+  auto const_decimal = MakeConstantValueExpression(ValueFactory::GetDecimalValue(512.5));
+  auto const_null = MakeConstantValueExpression(ValueFactory::GetNullValueByType(TypeId::BIGINT));
+  // SMALLINT against INTEGER, nullable INTEGER against BIGINT, BIGINT against DECIMAL, INTEGER against NULL
+  const std::vector<std::pair<const AbstractExpression *, const AbstractExpression *>> operands{
+      {col1, const50}, {col2, col3}, {col3, const_decimal}, {const50, col4}, {col4, const_null}};
+  const std::vector<ComparisonType> types{ComparisonType::Equal,       ComparisonType::NotEqual,
+                                          ComparisonType::LessThan,    ComparisonType::LessThanOrEqual,
+                                          ComparisonType::GreaterThan, ComparisonType::GreaterThanOrEqual};
+  size_t num_true = 0;
+  for (const auto &[lhs, rhs] : operands) {
+    for (const auto type : types) {
+      auto predicate = MakeComparisonExpression(lhs, rhs, type);
+      auto compiled = CompiledPredicate::Compile(predicate, schema);
+      ASSERT_NE(nullptr, compiled);
+      for (auto iter = table_info->table_->Begin(GetTxn()); iter != table_info->table_->End(); ++iter) {
+        // a NULL comparison does not hold
+        const Value expected = predicate->Evaluate(&*iter, schema);
+        ASSERT_EQ(!expected.IsNull() && expected.GetAs<bool>(), compiled->Evaluate(&*iter));
+        num_true += compiled->Evaluate(&*iter) ? 1 : 0;
+      }
+    }
+  }
+  ASSERT_GT(num_true, 0);
+
+  // variable-length values are left to the expression tree
+  auto const_varchar = MakeConstantValueExpression(ValueFactory::GetVarcharValue("50"));
+  ASSERT_EQ(nullptr, CompiledPredicate::Compile(MakeComparisonExpression(col1, const_varchar, ComparisonType::Equal),
+                                                schema));
+  ASSERT_EQ(nullptr, CompiledPredicate::Compile(col1, schema));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, NullPredicateTest) {
+  // CREATE TABLE null_preds (colA VARCHAR(8), colB INTEGER), colA is NULL in every third row and colB is unique.
+  // VARCHAR comparisons do not compile, so these predicates are evaluated by the expression tree.
+  const size_t num_rows = 30;
+  Schema table_schema({Column("colA", TypeId::VARCHAR, 8), Column("colB", TypeId::INTEGER)});
+  auto table_info = GetExecutorContext()->GetCatalog()->CreateTable(GetTxn(), "null_preds", table_schema);
+  std::vector<std::vector<Value>> raw_vals;
+  size_t num_not_k0 = 0;
+  size_t num_keys[2] = {0, 0};
+  for (size_t i = 0; i < num_rows; i++) {
+    const bool is_null = i % 3 == 0;
+    if (!is_null) {
+      num_keys[i % 2]++;
+      num_not_k0 += i % 2 == 1 ? 1 : 0;
+    }
+    raw_vals.push_back({is_null ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                                : ValueFactory::GetVarcharValue("k" + std::to_string(i % 2)),
+                        ValueFactory::GetIntegerValue(static_cast<int32_t>(i))});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  const Schema *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+
+  // Scenario: SELECT colA, colB FROM null_preds WHERE colA <> 'k0' skips the NULLs, and so does comparing with NULL.
+  auto const_k0 = MakeConstantValueExpression(ValueFactory::GetVarcharValue("k0"));
+  auto const_null = MakeConstantValueExpression(ValueFactory::GetNullValueByType(TypeId::VARCHAR));
+  auto count_scan = [&](const AbstractExpression *predicate) {
+    SeqScanPlanNode scan_plan{out_schema, predicate, table_info->oid_};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+    return result_set.size();
+  };
+  EXPECT_EQ(num_not_k0, count_scan(MakeComparisonExpression(colA, const_k0, ComparisonType::NotEqual)));
+  EXPECT_EQ(0, count_scan(MakeComparisonExpression(colA, const_null, ComparisonType::Equal)));
+  EXPECT_EQ(0, count_scan(MakeComparisonExpression(colA, const_null, ComparisonType::NotEqual)));
+
+  SeqScanPlanNode scan_plan1{out_schema, nullptr, table_info->oid_};
+  SeqScanPlanNode scan_plan2{out_schema, nullptr, table_info->oid_};
+  auto left_colA = MakeColumnValueExpression(*out_schema, 0, "colA");
+  auto left_colB = MakeColumnValueExpression(*out_schema, 0, "colB");
+  auto right_colA = MakeColumnValueExpression(*out_schema, 1, "colA");
+  auto right_colB = MakeColumnValueExpression(*out_schema, 1, "colB");
+  const Schema *out_final = MakeOutputSchema({{"left_colB", left_colB}, {"right_colB", right_colB}});
+  auto a_eq_a = MakeComparisonExpression(left_colA, right_colA, ComparisonType::Equal);
+
+  // Scenario: ... FROM null_preds AS l JOIN null_preds AS r ON l.colA = r.colA never joins NULL with NULL.
+  NestedLoopJoinPlanNode nested_loop_join_plan(out_final, {&scan_plan1, &scan_plan2}, a_eq_a);
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&nested_loop_join_plan, &result_set, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(num_keys[0] * num_keys[0] + num_keys[1] * num_keys[1], result_set.size());
+
+  // Scenario: ... ON l.colB = r.colB AND l.colA = r.colA joins every row with itself, except those whose colA is NULL.
+  HashJoinPlanNode hash_join_plan(out_final, {&scan_plan1, &scan_plan2}, {left_colB}, {right_colB}, a_eq_a);
+  result_set.clear();
+  GetExecutionEngine()->Execute(&hash_join_plan, &result_set, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(num_keys[0] + num_keys[1], result_set.size());
+  for (const auto &tuple : result_set) {
+    EXPECT_NE(0, tuple.GetValue(out_final, 0).GetAs<int32_t>() % 3);
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, SimpleAggregationTest) {
   // SELECT COUNT(colA), SUM(colA), min(colA), max(colA) from test_1;
@@ -546,6 +1003,360 @@ TEST_F(ExecutorTest, SimpleGroupByAggregation) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ParallelGroupByAggregation) {
+  // SELECT colB, count(colA), sum(colC), min(colD), max(colD) FROM test_1 GROUP BY colB
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto colC = MakeColumnValueExpression(schema, 0, "colC");
+  auto colD = MakeColumnValueExpression(schema, 0, "colD");
+  const Schema *scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}, {"colD", colD}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+
+  auto groupbyB = MakeAggregateValueExpression(true, 0);
+  auto countA = MakeAggregateValueExpression(false, 0);
+  auto sumC = MakeAggregateValueExpression(false, 1);
+  auto minD = MakeAggregateValueExpression(false, 2);
+  auto maxD = MakeAggregateValueExpression(false, 3);
+  const Schema *agg_schema =
+      MakeOutputSchema({{"colB", groupbyB}, {"countA", countA}, {"sumC", sumC}, {"minD", minD}, {"maxD", maxD}});
+
+  using Row = std::tuple<int32_t, int32_t, int32_t, int32_t, int32_t>;
+  // more group-by columns than fit into a compact key make the table keep the keys as values
+  auto run = [&](size_t num_threads, size_t num_group_bys) {
+    auto group_by_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+    std::vector<const AbstractExpression *> group_bys(num_group_bys, group_by_b);
+    AggregationPlanNode agg_plan{agg_schema,
+                                 &scan_plan,
+                                 nullptr,
+                                 std::move(group_bys),
+                                 {MakeColumnValueExpression(*scan_schema, 0, "colA"),
+                                  MakeColumnValueExpression(*scan_schema, 0, "colC"),
+                                  MakeColumnValueExpression(*scan_schema, 0, "colD"),
+                                  MakeColumnValueExpression(*scan_schema, 0, "colD")},
+                                 {AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                  AggregationType::MinAggregate, AggregationType::MaxAggregate},
+                                 num_threads};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<Row> result;
+    for (const auto &tuple : result_set) {
+      auto column = [&](uint32_t col_idx) { return tuple.GetValue(agg_schema, col_idx).GetAs<int32_t>(); };
+      result.emplace_back(column(0), column(1), column(2), column(3), column(4));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  };
+
+  // the expected groups, straight from the table
+  std::map<int32_t, Row> groups;
+  for (auto iter = table_info->table_->Begin(GetTxn()); iter != table_info->table_->End(); ++iter) {
+    const int32_t b = iter->GetValue(&schema, 1).GetAs<int32_t>();
+    const int32_t c = iter->GetValue(&schema, 2).GetAs<int32_t>();
+    const int32_t d = iter->GetValue(&schema, 3).GetAs<int32_t>();
+    auto [group, inserted] = groups.try_emplace(b, b, 0, 0, d, d);
+    std::get<1>(group->second)++;
+    std::get<2>(group->second) += c;
+    std::get<3>(group->second) = std::min(std::get<3>(group->second), d);
+    std::get<4>(group->second) = std::max(std::get<4>(group->second), d);
+  }
+  std::vector<Row> expected;
+  for (const auto &[b, row] : groups) {
+    expected.push_back(row);
+  }
+  ASSERT_EQ(10, expected.size());
+  ASSERT_EQ(expected, run(1, 1));
+  ASSERT_EQ(expected, run(4, 1));
+  ASSERT_EQ(expected, run(1, 5));
+  ASSERT_EQ(expected, run(4, 5));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, GroupByNullAggregation) {
+  // CREATE TABLE null_groups (colA VARCHAR(8), colB INTEGER, colC INTEGER), with NULLs in both group-by columns
+  const size_t num_rows = 100;
+  Schema table_schema({Column("colA", TypeId::VARCHAR, 8), Column("colB", TypeId::INTEGER),
+                       Column("colC", TypeId::INTEGER)});
+  auto table_info = GetExecutorContext()->GetCatalog()->CreateTable(GetTxn(), "null_groups", table_schema);
+  std::vector<std::vector<Value>> raw_vals;
+  size_t num_null_a = 0;
+  size_t num_null_b = 0;
+  for (size_t i = 0; i < num_rows; i++) {
+    const bool null_a = i % 3 == 0;
+    const bool null_b = i % 5 == 0;
+    num_null_a += null_a ? 1 : 0;
+    num_null_b += null_b ? 1 : 0;
+    raw_vals.push_back({null_a ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                               : ValueFactory::GetVarcharValue("k" + std::to_string(i % 4)),
+                        null_b ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                               : ValueFactory::GetIntegerValue(static_cast<int32_t>(i % 4)),
+                        ValueFactory::GetIntegerValue(static_cast<int32_t>(i))});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto colC = MakeColumnValueExpression(schema, 0, "colC");
+  const Schema *scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  auto count = MakeAggregateValueExpression(false, 0);
+
+  // SELECT <column>, count(colC) FROM null_groups GROUP BY <column>: the NULLs form exactly one group of their own.
+  // VARCHAR keys and INTEGER keys are kept in different kinds of hash tables.
+  auto run = [&](uint32_t column, const std::string &name, size_t num_threads, size_t num_nulls) {
+    auto group_by = MakeAggregateValueExpression(true, 0, schema.GetColumn(column).GetType());
+    const Schema *agg_schema = MakeOutputSchema({{"group", group_by}, {"count", count}});
+    AggregationPlanNode agg_plan{agg_schema,
+                                 &scan_plan,
+                                 nullptr,
+                                 {MakeColumnValueExpression(*scan_schema, 0, name)},
+                                 {MakeColumnValueExpression(*scan_schema, 0, "colC")},
+                                 {AggregationType::CountAggregate},
+                                 num_threads};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+    size_t total = 0;
+    size_t num_null_groups = 0;
+    std::unordered_set<std::string> encountered;
+    for (const auto &tuple : result_set) {
+      const Value key = tuple.GetValue(agg_schema, 0);
+      const auto group_size = static_cast<size_t>(tuple.GetValue(agg_schema, 1).GetAs<int32_t>());
+      total += group_size;
+      if (key.IsNull()) {
+        num_null_groups++;
+        EXPECT_EQ(num_nulls, group_size) << "column " << column << ", " << num_threads << " threads";
+        continue;
+      }
+      EXPECT_EQ(0, encountered.count(key.ToString()));
+      encountered.insert(key.ToString());
+    }
+    EXPECT_EQ(num_rows, total);
+    EXPECT_EQ(1, num_null_groups) << "column " << column << ", " << num_threads << " threads";
+    EXPECT_EQ(4, encountered.size());
+  };
+  run(0, "colA", 1, num_null_a);
+  run(0, "colA", 4, num_null_a);
+  run(1, "colB", 1, num_null_b);
+  run(1, "colB", 4, num_null_b);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, GroupBySpillAggregation) {
+  // SELECT colA, count(colB), sum(colC), min(colD), max(colD) FROM test_1 GROUP BY colA, with a tiny memory budget
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto colC = MakeColumnValueExpression(schema, 0, "colC");
+  auto colD = MakeColumnValueExpression(schema, 0, "colD");
+  const Schema *scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}, {"colD", colD}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+
+  auto groupbyA = MakeAggregateValueExpression(true, 0);
+  auto countB = MakeAggregateValueExpression(false, 0);
+  auto sumC = MakeAggregateValueExpression(false, 1);
+  auto minD = MakeAggregateValueExpression(false, 2);
+  auto maxD = MakeAggregateValueExpression(false, 3);
+  const Schema *agg_schema =
+      MakeOutputSchema({{"colA", groupbyA}, {"countB", countB}, {"sumC", sumC}, {"minD", minD}, {"maxD", maxD}});
+
+  using Row = std::tuple<int32_t, int32_t, int32_t, int32_t, int32_t>;
+  auto run = [&](size_t num_threads, size_t num_group_bys, size_t memory_budget) {
+    auto group_by_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+    std::vector<const AbstractExpression *> group_bys(num_group_bys, group_by_a);
+    AggregationPlanNode agg_plan{agg_schema,
+                                 &scan_plan,
+                                 nullptr,
+                                 std::move(group_bys),
+                                 {MakeColumnValueExpression(*scan_schema, 0, "colB"),
+                                  MakeColumnValueExpression(*scan_schema, 0, "colC"),
+                                  MakeColumnValueExpression(*scan_schema, 0, "colD"),
+                                  MakeColumnValueExpression(*scan_schema, 0, "colD")},
+                                 {AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                  AggregationType::MinAggregate, AggregationType::MaxAggregate},
+                                 num_threads,
+                                 memory_budget};
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &agg_plan);
+    std::vector<Row> result;
+    // a second Init produces the same groups from the spilled partitions again
+    for (int pass = 0; pass < 2; pass++) {
+      result.clear();
+      executor->Init();
+      Tuple tuple;
+      RID rid;
+      while (executor->Next(&tuple, &rid)) {
+        auto column = [&](uint32_t col_idx) { return tuple.GetValue(agg_schema, col_idx).GetAs<int32_t>(); };
+        result.emplace_back(column(0), column(1), column(2), column(3), column(4));
+      }
+    }
+    const size_t num_spilled = dynamic_cast<AggregationExecutor *>(executor.get())->GetNumSpilledPartitions();
+    EXPECT_EQ(memory_budget < EXECUTOR_MEMORY_BUDGET, num_spilled > 0);
+    std::sort(result.begin(), result.end());
+    return result;
+  };
+
+  const auto expected = run(1, 1, EXECUTOR_MEMORY_BUDGET);
+  ASSERT_EQ(TEST1_SIZE, expected.size());
+  // colA is unique, so spilled partitions keep exceeding the budget and are split until the depth limit is reached
+  ASSERT_EQ(expected, run(1, 1, 1024));
+  ASSERT_EQ(expected, run(4, 1, 1024));
+  ASSERT_EQ(expected, run(1, 5, 1024));
+  ASSERT_EQ(expected, run(4, 5, 4096));
+  // no spilled page was left pinned, every frame but the one of the header page can be used again
+  std::vector<page_id_t> page_ids(GetBPM()->GetPoolSize() - 1);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, GetBPM()->NewPage(&page_id));
+  }
+  for (const auto page_id : page_ids) {
+    GetBPM()->UnpinPage(page_id, false);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SortTest) {
+  // SELECT colA, colB FROM test_1 ORDER BY colB ASC, colA DESC
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  const Schema *scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  auto sort_colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto sort_colB = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  const Schema *out_schema = MakeOutputSchema({{"colA", sort_colA}, {"colB", sort_colB}});
+
+  auto run = [&](size_t memory_budget) {
+    SortPlanNode sort_plan{out_schema,
+                           &scan_plan,
+                           {{OrderByType::Asc, sort_colB}, {OrderByType::Desc, sort_colA}},
+                           memory_budget};
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &sort_plan);
+    executor->Init();
+    std::vector<std::pair<int32_t, int32_t>> result;
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      auto column = [&](uint32_t col_idx) { return tuple.GetValue(out_schema, col_idx).GetAs<int32_t>(); };
+      result.emplace_back(column(1), column(0));
+    }
+    const size_t num_runs = dynamic_cast<SortExecutor *>(executor.get())->GetNumRuns();
+    EXPECT_EQ(memory_budget < EXECUTOR_MEMORY_BUDGET, num_runs > 0);
+    return result;
+  };
+
+  std::vector<std::pair<int32_t, int32_t>> expected;
+  for (auto iter = table_info->table_->Begin(GetTxn()); iter != table_info->table_->End(); ++iter) {
+    expected.emplace_back(iter->GetValue(&schema, 1).GetAs<int32_t>(), iter->GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  std::sort(expected.begin(), expected.end(), [](const auto &a, const auto &b) {
+    return a.first != b.first ? a.first < b.first : a.second > b.second;
+  });
+  ASSERT_EQ(TEST1_SIZE, expected.size());
+  ASSERT_EQ(expected, run(EXECUTOR_MEMORY_BUDGET));
+  // a budget below a page makes the runs merge two at a time over several passes
+  ASSERT_EQ(expected, run(1024));
+  ASSERT_EQ(expected, run(4 * PAGE_SIZE));
+  // no spilled page was left pinned, every frame but the one of the header page can be used again
+  std::vector<page_id_t> page_ids(GetBPM()->GetPoolSize() - 1);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, GetBPM()->NewPage(&page_id));
+  }
+  for (const auto page_id : page_ids) {
+    GetBPM()->UnpinPage(page_id, false);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SortLimitTest) {
+  // SELECT col1, col4 FROM test_2 ORDER BY col4 DESC, col1 ASC LIMIT 10 OFFSET 5, where col4 is NULL in some rows
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto &schema = table_info->schema_;
+  auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+  auto col4 = MakeColumnValueExpression(schema, 0, "col4");
+  const Schema *scan_schema = MakeOutputSchema({{"col1", col1}, {"col4", col4}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  auto sort_col1 = MakeColumnValueExpression(*scan_schema, 0, "col1");
+  auto sort_col4 = MakeColumnValueExpression(*scan_schema, 0, "col4");
+  const Schema *out_schema = MakeOutputSchema({{"col1", sort_col1}, {"col4", sort_col4}});
+  SortPlanNode sort_plan{out_schema, &scan_plan, {{OrderByType::Desc, sort_col4}, {OrderByType::Asc, sort_col1}}};
+  auto limit_col1 = MakeColumnValueExpression(*out_schema, 0, "col1");
+  auto limit_col4 = MakeColumnValueExpression(*out_schema, 0, "col4");
+  const Schema *limit_schema = MakeOutputSchema({{"col1", limit_col1}, {"col4", limit_col4}});
+
+  auto collect = [&](AbstractExecutor *executor) {
+    executor->Init();
+    std::vector<std::pair<int16_t, Value>> result;
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      result.emplace_back(tuple.GetValue(limit_schema, 0).GetAs<int16_t>(), tuple.GetValue(limit_schema, 1));
+    }
+    return result;
+  };
+  auto equal = [](const std::vector<std::pair<int16_t, Value>> &a, const std::vector<std::pair<int16_t, Value>> &b) {
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); i++) {
+      ASSERT_EQ(a[i].first, b[i].first);
+      ASSERT_EQ(a[i].second.IsNull(), b[i].second.IsNull());
+      ASSERT_TRUE(a[i].second.IsNull() || a[i].second.CompareEquals(b[i].second) == CmpBool::CmpTrue);
+    }
+  };
+
+  for (const auto &[limit, offset] : std::vector<std::pair<size_t, size_t>>{{10, 5}, {0, 0}, {TEST2_SIZE * 2, 0}}) {
+    LimitPlanNode limit_plan{limit_schema, &sort_plan, limit, offset};
+    // the factory sorts into a top-n heap below a limit, a full sort has to produce the same tuples
+    auto top_n = ExecutorFactory::CreateExecutor(GetExecutorContext(), &limit_plan);
+    LimitExecutor full_sort(GetExecutorContext(), &limit_plan,
+                            std::make_unique<SortExecutor>(GetExecutorContext(), &sort_plan,
+                                                           ExecutorFactory::CreateExecutor(GetExecutorContext(),
+                                                                                           &scan_plan)));
+    const auto expected = collect(&full_sort);
+    equal(expected, collect(top_n.get()));
+  }
+
+  // a top-n heap that outgrows the memory budget falls back to the external sort, and still stops after top_n tuples
+  SortPlanNode small_sort_plan{
+      out_schema, &scan_plan, {{OrderByType::Desc, sort_col4}, {OrderByType::Asc, sort_col1}}, 1024};
+  LimitPlanNode limit_plan{limit_schema, &sort_plan, 60, 10};
+  LimitExecutor full_sort(GetExecutorContext(), &limit_plan,
+                          std::make_unique<SortExecutor>(GetExecutorContext(), &sort_plan,
+                                                         ExecutorFactory::CreateExecutor(GetExecutorContext(),
+                                                                                         &scan_plan)));
+  auto small_sort = std::make_unique<SortExecutor>(
+      GetExecutorContext(), &small_sort_plan, ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan), 70);
+  SortExecutor *small_sort_executor = small_sort.get();
+  LimitExecutor spilling_top_n(GetExecutorContext(), &limit_plan, std::move(small_sort));
+  equal(collect(&full_sort), collect(&spilling_top_n));
+  ASSERT_GT(small_sort_executor->GetNumRuns(), 0);
+  Tuple sorted;
+  RID sorted_rid;
+  small_sort_executor->Init();
+  size_t num_sorted = 0;
+  while (small_sort_executor->Next(&sorted, &sorted_rid)) {
+    num_sorted++;
+  }
+  ASSERT_EQ(70, num_sorted);
+
+  // descending order puts the NULLs last
+  auto sort = ExecutorFactory::CreateExecutor(GetExecutorContext(), &sort_plan);
+  sort->Init();
+  Tuple tuple;
+  RID rid;
+  bool seen_null = false;
+  size_t count = 0;
+  while (sort->Next(&tuple, &rid)) {
+    const bool is_null = tuple.GetValue(out_schema, 1).IsNull();
+    ASSERT_TRUE(is_null || !seen_null);
+    seen_null = seen_null || is_null;
+    count++;
+  }
+  ASSERT_EQ(TEST2_SIZE, count);
+}
+
 }  // namespace bustub
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
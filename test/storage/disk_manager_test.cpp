@@ -10,10 +10,19 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
+#include <future>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/direct_disk_manager.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
@@ -23,13 +32,13 @@ class DiskManagerTest : public ::testing::Test {
   // This function is called before every test.
   void SetUp() override {
     remove("test.db");
-    remove("test.log");
+    remove("test.manifest");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
-    remove("test.log");
+    remove("test.manifest");
   };
 };
 
@@ -72,7 +81,201 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LogSegmentTest) {
+  // writes straddle segment boundaries, the log ends in the third segment
+  const int chunk_size = LOG_SEGMENT_SIZE / 4 + 3;
+  const int num_chunks = 10;
+  const int log_size = chunk_size * num_chunks;
+  auto byte_at = [](int offset) { return static_cast<char>(offset % 251); };
+  auto expect_log = [&](const char *data, int size, int offset) {
+    for (int i = 0; i < size; i++) {
+      ASSERT_EQ(offset + i < log_size ? byte_at(offset + i) : 0, data[i]) << "at offset " << offset + i;
+    }
+  };
+  const std::string archive_dir("test_log_archive");
+  std::filesystem::remove_all(archive_dir);
+  std::filesystem::create_directory(archive_dir);
+
+  auto *dm = new DiskManager("test.db");
+  EXPECT_EQ(0, dm->GetLogSize());
+  // the disk manager insists on alternating between two log buffers
+  std::vector<char> chunks[2] = {std::vector<char>(chunk_size), std::vector<char>(chunk_size)};
+  for (int i = 0; i < num_chunks; i++) {
+    auto &chunk = chunks[i % 2];
+    for (int j = 0; j < chunk_size; j++) {
+      chunk[j] = byte_at(i * chunk_size + j);
+    }
+    dm->WriteLog(chunk.data(), chunk_size);
+  }
+  EXPECT_EQ(log_size, dm->GetLogSize());
+  for (int segment = 0; segment < 3; segment++) {
+    EXPECT_TRUE(std::filesystem::exists("test.log." + std::to_string(segment)));
+  }
+  EXPECT_FALSE(std::filesystem::exists("test.log.3"));
+  EXPECT_TRUE(std::filesystem::exists("test.manifest"));
+
+  // Scenario: reads span segments, and the log survives reopening it.
+  char buf[100];
+  EXPECT_TRUE(dm->ReadLog(buf, sizeof(buf), LOG_SEGMENT_SIZE - 50));
+  expect_log(buf, sizeof(buf), LOG_SEGMENT_SIZE - 50);
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager("test.db");
+  EXPECT_EQ(log_size, dm->GetLogSize());
+  EXPECT_TRUE(dm->ReadLog(buf, sizeof(buf), log_size - 50));
+  expect_log(buf, sizeof(buf), log_size - 50);
+  EXPECT_FALSE(dm->ReadLog(buf, sizeof(buf), log_size));
+
+  // Scenario: truncating moves the segments before the one holding the offset into the archive.
+  dm->SetLogArchiveDirectory(archive_dir);
+  dm->TruncateLog(2 * LOG_SEGMENT_SIZE + 10);
+  EXPECT_EQ(2 * LOG_SEGMENT_SIZE, dm->GetLogStart());
+  EXPECT_FALSE(std::filesystem::exists("test.log.0"));
+  EXPECT_FALSE(std::filesystem::exists("test.log.1"));
+  EXPECT_TRUE(std::filesystem::exists(archive_dir + "/test.log.0"));
+  EXPECT_TRUE(std::filesystem::exists(archive_dir + "/test.log.1"));
+  EXPECT_FALSE(dm->ReadLog(buf, sizeof(buf), 0));
+  EXPECT_TRUE(dm->ReadLog(buf, sizeof(buf), 2 * LOG_SEGMENT_SIZE + 10));
+  expect_log(buf, sizeof(buf), 2 * LOG_SEGMENT_SIZE + 10);
+  // truncating to an older offset keeps what is there
+  dm->TruncateLog(0);
+  EXPECT_EQ(2 * LOG_SEGMENT_SIZE, dm->GetLogStart());
+
+  // Scenario: the manifest keeps the truncation across restarts.
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager("test.db");
+  EXPECT_EQ(2 * LOG_SEGMENT_SIZE, dm->GetLogStart());
+  EXPECT_EQ(log_size, dm->GetLogSize());
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: without its manifest the log is gone, stray segments are deleted.
+  remove("test.manifest");
+  dm = new DiskManager("test.db");
+  EXPECT_EQ(0, dm->GetLogSize());
+  EXPECT_EQ(0, dm->GetLogStart());
+  EXPECT_FALSE(std::filesystem::exists("test.log.2"));
+  dm->ShutDown();
+  delete dm;
+  std::filesystem::remove_all(archive_dir);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LargeLogOffsetTest) {
+  // a log truncated up to past 4GB, its offsets no longer fit into 32 bits
+  const int first_segment = 5000;
+  const log_offset_t log_start = static_cast<log_offset_t>(first_segment) * LOG_SEGMENT_SIZE;
+  auto *dm = new DiskManager("test.db");
+  dm->TruncateLog(log_start);
+  EXPECT_EQ(log_start, dm->GetLogStart());
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: the log continues at the truncation point after a restart, and records can be found again.
+  dm = new DiskManager("test.db");
+  EXPECT_EQ(log_start, dm->GetLogStart());
+  EXPECT_EQ(log_start, dm->GetLogSize());
+  auto *log_manager = new LogManager(dm);
+  LogRecord begin(0, INVALID_LSN, LogRecordType::BEGIN);
+  log_manager->AppendLogRecord(&begin);
+  LogRecord commit(0, begin.GetLSN(), LogRecordType::COMMIT);
+  log_manager->AppendLogRecord(&commit);
+  log_manager->Flush(commit.GetLSN());
+  EXPECT_EQ(log_start + begin.GetSize() + commit.GetSize(), dm->GetLogSize());
+  EXPECT_EQ(log_start, log_manager->GetLogOffset(commit.GetLSN()));
+  char buf[32];
+  EXPECT_TRUE(dm->ReadLog(buf, sizeof(buf), log_start + begin.GetSize()));
+  EXPECT_EQ(commit.GetLSN(), *reinterpret_cast<lsn_t *>(buf + 4));
+
+  // Scenario: the master record keeps the offset of the checkpoint.
+  log_manager->WriteMasterRecord(commit.GetLSN());
+  lsn_t checkpoint_lsn;
+  log_offset_t offset;
+  EXPECT_TRUE(dm->ReadMasterRecord(&checkpoint_lsn, &offset));
+  EXPECT_EQ(commit.GetLSN(), checkpoint_lsn);
+  EXPECT_EQ(log_start, offset);
+  delete log_manager;
+  dm->ShutDown();
+  delete dm;
+  remove(("test.log." + std::to_string(first_segment)).c_str());
+  remove("test.master");
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectReadWritePageTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  DirectDiskManager dm(db_file);
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(0, buf);  // tolerate empty read
+  EXPECT_EQ(std::count(buf, buf + PAGE_SIZE, 0), PAGE_SIZE);
+
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  std::memset(buf, 0, sizeof(buf));
+  dm.WritePage(5, data);
+  dm.ReadPage(5, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(2, dm.GetNumWrites());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectAsyncPageTest) {
+  const int num_pages = 256;
+  std::string db_file("test.db");
+  DirectDiskManager dm(db_file, 16);
+
+  // Scenario: many more writes than the queue depth are in flight, from buffers that are not aligned.
+  std::vector<std::unique_ptr<char[]>> pages;
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < num_pages; i++) {
+    pages.emplace_back(new char[PAGE_SIZE + 1]);
+    char *data = pages.back().get() + 1;
+    std::memset(data, 0, PAGE_SIZE);
+    snprintf(data, PAGE_SIZE, "page %d", i);
+    futures.push_back(dm.WritePageAsync(i, data));
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+  futures.clear();
+
+  // Scenario: the pages read back asynchronously are the ones written, reads past the end yield zeros.
+  std::vector<std::unique_ptr<char[]>> bufs;
+  for (int i = 0; i < num_pages + 1; i++) {
+    bufs.emplace_back(new char[PAGE_SIZE]);
+    std::memset(bufs.back().get(), 1, PAGE_SIZE);
+    futures.push_back(dm.ReadPageAsync(i, bufs.back().get()));
+  }
+  for (int i = 0; i < num_pages + 1; i++) {
+    futures[i].get();
+    if (i < num_pages) {
+      EXPECT_EQ(std::memcmp(bufs[i].get(), pages[i].get() + 1, PAGE_SIZE), 0);
+    } else {
+      EXPECT_EQ(std::count(bufs[i].get(), bufs[i].get() + PAGE_SIZE, 0), PAGE_SIZE);
+    }
+  }
+
+  // Scenario: a read with a completion callback reports to it once the data is in, without anybody waiting for it.
+  std::promise<bool> done;
+  char buf[PAGE_SIZE];
+  dm.ReadPageAsync(0, buf, [&](std::exception_ptr error) { done.set_value(error == nullptr); });
+  EXPECT_TRUE(done.get_future().get());
+  EXPECT_EQ(std::memcmp(buf, pages[0].get() + 1, PAGE_SIZE), 0);
+
+  dm.ShutDown();
+}
+
 }  // namespace bustub
@@ -10,16 +10,21 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <string>
 #include <vector>
 
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 #include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tmp_tuple_run.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(TmpTuplePageTest, DISABLED_BasicTest) {
+TEST(TmpTuplePageTest, BasicTest) {
   // There are many ways to do this assignment, and this is only one of them.
   // If you don't like the TmpTuplePage idea, please feel free to delete this test case entirely.
   // You will get full credit as long as you are correctly using a linear probe hash table.
@@ -46,6 +51,28 @@ TEST(TmpTuplePageTest, DISABLED_BasicTest) {
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + sizeof(page_id_t) + sizeof(lsn_t)), PAGE_SIZE - 8);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + PAGE_SIZE - 8), 4);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + PAGE_SIZE - 4), 123);
+
+  ASSERT_EQ(tmp_tuple, TmpTuple(page_id, PAGE_SIZE - 8));
+  Tuple read_tuple;
+  ASSERT_EQ(page.GetTuple(tmp_tuple.GetOffset(), &read_tuple), PAGE_SIZE);
+  ASSERT_EQ(read_tuple.GetValue(&schema, 0).GetAs<int32_t>(), 123);
+}
+
+// NOLINTNEXTLINE
+TEST(TmpTuplePageTest, RunTooLargeTupleTest) {
+  DiskManagerMemory disk_manager;
+  BufferPoolManagerInstance bpm(2, &disk_manager);
+  Schema schema({Column("A", TypeId::VARCHAR, 2 * PAGE_SIZE)});
+  Tuple small({ValueFactory::GetVarcharValue(std::string(16, 'a'))}, &schema);
+  Tuple large({ValueFactory::GetVarcharValue(std::string(PAGE_SIZE, 'b'))}, &schema);
+
+  // Scenario: A tuple that does not fit onto a page is refused, and the run stays usable.
+  TmpTupleRun run(&bpm);
+  run.Append(small);
+  EXPECT_THROW(run.Append(large), Exception);
+  run.Append(small);
+  EXPECT_EQ(2, run.GetNumTuples());
+  EXPECT_EQ(2 * small.GetLength(), run.GetSize());
 }
 
 }  // namespace bustub